@@ -0,0 +1,173 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Format.hpp>
+#include <minitensor/Tensor.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    template <class T>
+    const char* typeName();
+    template <>
+    const char* typeName<uint8_t>()
+    {
+        return "uint8";
+    }
+    template <>
+    const char* typeName<float>()
+    {
+        return "float";
+    }
+    template <>
+    const char* typeName<double>()
+    {
+        return "double";
+    }
+
+    // Results are accumulated here so the measured loops are not optimized away
+    volatile double g_sink = 0;
+
+    template <class T>
+    void benchView(const std::string& label, mt::Shape<3> shape, size_t elements)
+    {
+        const std::string suffix = std::string(" ") + typeName<T>() + " " + label;
+        std::vector<T> storage(elements, T(1));
+        std::vector<T> values(shape.numElements(), T(2));
+        mt::Tensor<T, 3> tensor(storage.data(), shape);
+        mt::Tensor<const T, 3> view(storage.data(), shape);
+        const size_t bytes = shape.numElements() * sizeof(T);
+
+        measure("operator()" + suffix, bytes, [&]() {
+            double sum = 0;
+            for (uint32_t i = 0; i < shape[0]; ++i)
+            {
+                for (uint32_t j = 0; j < shape[1]; ++j)
+                {
+                    for (uint32_t k = 0; k < shape[2]; ++k)
+                    {
+                        sum += view(i, j, k);
+                    }
+                }
+            }
+            g_sink = sum;
+        });
+        // The pointer arithmetic operator() stands for, both should take the same time
+        measure("pointer arithmetic" + suffix, bytes, [&]() {
+            const T* data = storage.data();
+            const int64_t stride0 = static_cast<mt::Stride_t>(shape.getStride(0));
+            const int64_t stride1 = static_cast<mt::Stride_t>(shape.getStride(1));
+            const int64_t stride2 = static_cast<mt::Stride_t>(shape.getStride(2));
+            double sum = 0;
+            for (uint32_t i = 0; i < shape[0]; ++i)
+            {
+                for (uint32_t j = 0; j < shape[1]; ++j)
+                {
+                    for (uint32_t k = 0; k < shape[2]; ++k)
+                    {
+                        sum += data[i * stride0 + j * stride1 + k * stride2];
+                    }
+                }
+            }
+            g_sink = sum;
+        });
+        measure("operator[]" + suffix, bytes, [&]() {
+            double sum = 0;
+            for (uint32_t i = 0; i < shape[0]; ++i)
+            {
+                const mt::Tensor<const T, 2> plane = view[i];
+                for (uint32_t j = 0; j < shape[1]; ++j)
+                {
+                    const mt::Tensor<const T, 1> row = plane[j];
+                    for (uint32_t k = 0; k < shape[2]; ++k)
+                    {
+                        sum += row[k];
+                    }
+                }
+            }
+            g_sink = sum;
+        });
+        measure("operator=" + suffix, 2 * bytes, [&]() { tensor = values; });
+        measure("outer iteration" + suffix, bytes, [&]() {
+            double sum = 0;
+            for (mt::TensorIterator<const T, 2> itr = mt::begin(view); itr != mt::end(view); ++itr)
+            {
+                for (const T& value : mt::elements(*itr))
+                {
+                    sum += value;
+                }
+            }
+            g_sink = sum;
+        });
+
+        mt::Shape<3> dense_shape = shape;
+        dense_shape.calculateStride();
+        std::vector<T> dense_storage(shape.numElements());
+        mt::Tensor<T, 3> dense(dense_storage.data(), dense_shape);
+        measure("copyTo" + suffix, 2 * bytes, [&]() { view.copyTo(dense); });
+    }
+
+    template <class T>
+    void benchViews()
+    {
+        {
+            mt::Shape<3> shape(3, 512, 512);
+            benchView<T>("dense 3x512x512", shape, shape.numElements());
+        }
+        {
+            mt::Shape<3> shape(64, 16, 16);
+            benchView<T>("dense 64x16x16", shape, shape.numElements());
+        }
+        {
+            // Interleaved channel view of a 512x512x4 image
+            mt::Shape<3> shape(3, 512, 512);
+            shape.setStride(2, 4);
+            shape.setStride(1, 512 * 4);
+            shape.setStride(0, 1);
+            benchView<T>("channels of 512x512x4", shape, 512 * 512 * 4);
+        }
+        {
+            // Center crop of a 3x256x256 image
+            mt::Shape<3> shape(3, 224, 224);
+            shape.setStride(2, 1);
+            shape.setStride(1, 256);
+            shape.setStride(0, 256 * 256);
+            benchView<T>("crop 3x224x224 of 256x256", shape, 3 * 256 * 256);
+        }
+    }
+
+    template <class T>
+    void benchPrint(uint32_t rows, uint32_t cols)
+    {
+        const std::string suffix =
+            std::string(" ") + typeName<T>() + " " + std::to_string(rows) + "x" + std::to_string(cols);
+        std::vector<T> storage(rows * cols);
+        for (uint32_t i = 0; i < rows * cols; ++i)
+        {
+            storage[i] = static_cast<T>(i % 251) / T(3);
+        }
+        mt::Tensor<const T, 2> tensor(storage.data(), {rows, cols});
+        const size_t bytes = storage.size() * sizeof(T);
+        measure("print operator<<" + suffix, bytes, [&]() {
+            std::ostringstream os;
+            os << tensor;
+            g_sink = static_cast<double>(os.tellp());
+        });
+        mt::TensorFormatter formatter;
+        measure("print format" + suffix, bytes, [&]() {
+            g_sink = static_cast<double>(formatter.format(tensor).size());
+        });
+    }
+} // namespace
+
+void benchmarkAccess()
+{
+    benchViews<uint8_t>();
+    benchViews<float>();
+    benchViews<double>();
+    benchPrint<float>(64, 64);
+    benchPrint<float>(512, 512);
+    benchPrint<double>(512, 512);
+}
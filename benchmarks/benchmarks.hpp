@@ -0,0 +1,70 @@
+#ifndef MINITENSOR_BENCHMARKS_HPP
+#define MINITENSOR_BENCHMARKS_HPP
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Per call times of one named measurement. bytes is the memory traffic of one call, used for the throughput.
+struct BenchmarkResult
+{
+    std::string name;
+    size_t bytes = 0;
+    int iterations = 0;
+    std::vector<double> samples_ms;
+
+    double percentileMs(double percentile) const;
+    double medianMs() const { return percentileMs(50); }
+    double gigabytesPerSecond() const;
+};
+
+// Samples taken by measure, set from the command line
+int& benchmarkRepetitions();
+// Adds a result to the report and prints its summary line
+void recordBenchmark(BenchmarkResult result);
+const std::vector<BenchmarkResult>& benchmarkResults();
+// Writes every recorded result as a JSON array of objects
+bool writeBenchmarkJson(const std::string& path);
+
+// Runs fn once to warm up and calibrate, then takes benchmarkRepetitions() samples of enough calls to last about
+// a millisecond each. The per call time of every sample is recorded under name.
+template <class F>
+void measure(const std::string& name, size_t bytes, F&& fn)
+{
+    typedef std::chrono::steady_clock Clock;
+    const auto warm_start = Clock::now();
+    fn();
+    const double warm_ms = std::chrono::duration<double, std::milli>(Clock::now() - warm_start).count();
+    BenchmarkResult result;
+    result.name = name;
+    result.bytes = bytes;
+    result.iterations = warm_ms >= 1.0 ? 1 : warm_ms * 10000 < 1 ? 10000 : static_cast<int>(1.0 / warm_ms) + 1;
+    for (int sample = 0; sample < benchmarkRepetitions(); ++sample)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < result.iterations; ++i)
+        {
+            fn();
+        }
+        const auto end = Clock::now();
+        result.samples_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count() /
+                                    result.iterations);
+    }
+    recordBenchmark(std::move(result));
+}
+
+void benchmarkAccess();
+void benchmarkCopy();
+void benchmarkIteration();
+void benchmarkExpression();
+void benchmarkSimd();
+void benchmarkReduce();
+void benchmarkMatmul();
+void benchmarkPrint();
+void benchmarkStaticShape();
+void benchmarkConvert();
+void benchmarkBlocked();
+void benchmarkGenerate();
+void benchmarkConv();
+
+#endif // MINITENSOR_BENCHMARKS_HPP
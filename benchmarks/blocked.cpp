@@ -0,0 +1,68 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Blocked.hpp>
+
+#include <vector>
+
+void benchmarkBlocked()
+{
+    // Activations of a ResNet stage into and out of the channel blocked layout of a convolution
+    const uint32_t channels = 64;
+    const uint32_t height = 56;
+    const uint32_t width = 56;
+    std::vector<float> plain(channels * height * width);
+    for (size_t i = 0; i < plain.size(); ++i)
+    {
+        plain[i] = static_cast<float>(i % 251);
+    }
+    mt::Tensor<float, 4> nchw(plain.data(), {1, channels, height, width});
+    const mt::BlockedShape<4, 1> layout = mt::channelBlocked(nchw.getShape(), 16);
+    std::vector<float> storage(layout.numPhysicalElements());
+    const mt::BlockedTensor<float, 4, 1> blocked(storage.data(), layout);
+    const size_t bytes = 2 * plain.size() * sizeof(float);
+    measure("nchw -> nchw16c element loop", bytes, [&]() {
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    blocked(0, c, y, x) = nchw(0, c, y, x);
+                }
+            }
+        }
+    });
+    measure("nchw -> nchw16c toBlocked", bytes, [&]() { mt::toBlocked(nchw, blocked); });
+    measure("nchw16c -> nchw element loop", bytes, [&]() {
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    nchw(0, c, y, x) = blocked(0, c, y, x);
+                }
+            }
+        }
+    });
+    measure("nchw16c -> nchw fromBlocked", bytes, [&]() { mt::fromBlocked(blocked, nchw); });
+
+    // A matrix into 8x8 tiles
+    const uint32_t size = 1024;
+    std::vector<float> matrix_storage(size * size);
+    mt::Tensor<float, 2> matrix(matrix_storage.data(), {size, size});
+    const mt::BlockedShape<2, 2> tile_layout = mt::tiled(matrix.getShape(), 8, 8);
+    std::vector<float> tile_storage(tile_layout.numPhysicalElements());
+    const mt::BlockedTensor<float, 2, 2> tiles(tile_storage.data(), tile_layout);
+    const size_t matrix_bytes = 2 * matrix_storage.size() * sizeof(float);
+    measure("matrix -> 8x8 tiles element loop", matrix_bytes, [&]() {
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            for (uint32_t j = 0; j < size; ++j)
+            {
+                tiles(i, j) = matrix(i, j);
+            }
+        }
+    });
+    measure("matrix -> 8x8 tiles toBlocked", matrix_bytes, [&]() { mt::toBlocked(matrix, tiles); });
+}
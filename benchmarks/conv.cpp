@@ -0,0 +1,163 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Conv.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::vector<float> randomImage(size_t size)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(-1, 1);
+        std::vector<float> out(size);
+        for (float& value : out)
+        {
+            value = dist(rng);
+        }
+        return out;
+    }
+} // namespace
+
+void benchmarkConv()
+{
+    // A 3x3 convolution with padding 1 in the middle of a small network
+    const uint32_t channels = 32;
+    const uint32_t outputs = 64;
+    const uint32_t size = 56;
+    std::vector<float> in_data = randomImage(channels * size * size);
+    std::vector<float> w_data = randomImage(outputs * channels * 9);
+    std::vector<float> out_data(outputs * size * size);
+    mt::Tensor<float, 3> in(in_data.data(), {channels, size, size});
+    mt::Tensor<float, 4> weights(w_data.data(), {outputs, channels, 3, 3});
+    mt::Tensor<float, 3> out(out_data.data(), {outputs, size, size});
+    mt::ThreadPool& pool = *mt::ThreadPool::getDefault();
+    const size_t bytes = (in_data.size() + w_data.size() + out_data.size()) * sizeof(float);
+    measure("conv2d 3x3 naive", bytes, [&]() {
+        for (uint32_t o = 0; o < outputs; ++o)
+        {
+            for (uint32_t y = 0; y < size; ++y)
+            {
+                for (uint32_t x = 0; x < size; ++x)
+                {
+                    float sum = 0;
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        for (uint32_t ky = 0; ky < 3; ++ky)
+                        {
+                            for (uint32_t kx = 0; kx < 3; ++kx)
+                            {
+                                const int64_t iy = static_cast<int64_t>(y) + ky - 1;
+                                const int64_t ix = static_cast<int64_t>(x) + kx - 1;
+                                if (iy >= 0 && iy < size && ix >= 0 && ix < size)
+                                {
+                                    sum += weights(o, c, ky, kx) * in(c, iy, ix);
+                                }
+                            }
+                        }
+                    }
+                    out(o, y, x) = sum;
+                }
+            }
+        }
+    });
+    // The usual lowering: a (channels * 9) x (size * size) matrix of input patches times the weights
+    std::vector<float> columns(channels * 9 * size * size);
+    mt::Tensor<float, 2> patches(columns.data(), {channels * 9, size * size});
+    const mt::Tensor<const float, 2> weight_matrix(w_data.data(), {outputs, channels * 9});
+    const mt::Tensor<float, 2> out_matrix(out_data.data(), {outputs, size * size});
+    measure("conv2d 3x3 im2col matmul", bytes, [&]() {
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            for (uint32_t k = 0; k < 9; ++k)
+            {
+                for (uint32_t y = 0; y < size; ++y)
+                {
+                    for (uint32_t x = 0; x < size; ++x)
+                    {
+                        const int64_t iy = static_cast<int64_t>(y) + k / 3 - 1;
+                        const int64_t ix = static_cast<int64_t>(x) + k % 3 - 1;
+                        const bool inside = iy >= 0 && iy < size && ix >= 0 && ix < size;
+                        patches(c * 9 + k, y * size + x) = inside ? in(c, iy, ix) : 0.0F;
+                    }
+                }
+            }
+        }
+        mt::matmul(weight_matrix, patches, out_matrix);
+    });
+    measure("conv2d 3x3", bytes, [&]() { mt::conv2d(in, weights, out, mt::Window2d(1, 1)); });
+    measure("conv2d 3x3 parallel", bytes, [&]() { mt::conv2d(in, weights, out, mt::Window2d(1, 1), &pool); });
+    measure("conv2d 3x3 stride 2", bytes / 4, [&]() {
+        mt::conv2d(in, weights, mt::slice(out, mt::Range(), mt::Range(0, size / 2), mt::Range(0, size / 2)),
+                   mt::Window2d(2, 1));
+    });
+
+    // Per channel filters and pooling over a larger image
+    const uint32_t large = 112;
+    std::vector<float> image_data = randomImage(channels * large * large);
+    std::vector<float> filtered_data(channels * large * large);
+    mt::Tensor<float, 3> image(image_data.data(), {channels, large, large});
+    mt::Tensor<float, 3> filtered(filtered_data.data(), {channels, large, large});
+    mt::Tensor<float, 3> kernels(w_data.data(), {channels, 3, 3});
+    const size_t image_bytes = 2 * image_data.size() * sizeof(float);
+    measure("depthwise 3x3 naive", image_bytes, [&]() {
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            for (uint32_t y = 0; y < large; ++y)
+            {
+                for (uint32_t x = 0; x < large; ++x)
+                {
+                    float sum = 0;
+                    for (uint32_t ky = 0; ky < 3; ++ky)
+                    {
+                        for (uint32_t kx = 0; kx < 3; ++kx)
+                        {
+                            const int64_t iy = static_cast<int64_t>(y) + ky - 1;
+                            const int64_t ix = static_cast<int64_t>(x) + kx - 1;
+                            if (iy >= 0 && iy < large && ix >= 0 && ix < large)
+                            {
+                                sum += kernels(c, ky, kx) * image(c, iy, ix);
+                            }
+                        }
+                    }
+                    filtered(c, y, x) = sum;
+                }
+            }
+        }
+    });
+    measure("depthwise 3x3", image_bytes, [&]() { mt::depthwiseConv2d(image, kernels, filtered, mt::Window2d(1, 1)); });
+
+    const uint32_t half = large / 2;
+    mt::Tensor<float, 3> pooled(filtered_data.data(), {channels, half, half});
+    const size_t pool_bytes = image_bytes * 5 / 8;
+    measure("max pool 3x3 stride 2 naive", pool_bytes, [&]() {
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            for (uint32_t y = 0; y < half; ++y)
+            {
+                for (uint32_t x = 0; x < half; ++x)
+                {
+                    float max = -std::numeric_limits<float>::infinity();
+                    for (uint32_t ky = 0; ky < 3; ++ky)
+                    {
+                        for (uint32_t kx = 0; kx < 3; ++kx)
+                        {
+                            const int64_t iy = 2 * static_cast<int64_t>(y) + ky - 1;
+                            const int64_t ix = 2 * static_cast<int64_t>(x) + kx - 1;
+                            if (iy >= 0 && iy < large && ix >= 0 && ix < large)
+                            {
+                                max = std::max(max, image(c, iy, ix));
+                            }
+                        }
+                    }
+                    pooled(c, y, x) = max;
+                }
+            }
+        }
+    });
+    measure("max pool 3x3 stride 2", pool_bytes, [&]() { mt::maxPool2d(image, 3, 3, pooled, mt::Window2d(2, 1)); });
+    measure("avg pool 3x3 stride 2", pool_bytes, [&]() { mt::avgPool2d(image, 3, 3, pooled, mt::Window2d(2, 1)); });
+}
@@ -0,0 +1,93 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Convert.hpp>
+
+#include <vector>
+
+void benchmarkConvert()
+{
+    // Normalizing a 640x480 camera frame into the planar float input of a network
+    const uint32_t height = 480;
+    const uint32_t width = 640;
+    std::vector<uint8_t> image(height * width * 3);
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        image[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<float> planar(image.size());
+    const float scale[] = {1 / 58.5f, 1 / 57.25f, 1 / 57.5f};
+    const float offset[] = {-123.5f / 58.5f, -116.25f / 57.25f, -103.5f / 57.5f};
+    const size_t bytes = image.size() * (sizeof(uint8_t) + sizeof(float));
+
+    const mt::Tensor<const uint8_t, 3> hwc(image.data(), {height, width, 3});
+    mt::Tensor<float, 3> chw(planar.data(), {3, height, width});
+    measure("hwc uint8 -> chw float strided loop", bytes, [&]() {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    chw(c, y, x) = static_cast<float>(hwc(y, x, c)) * scale[c] + offset[c];
+                }
+            }
+        }
+    });
+    const uint8_t order[] = {2, 0, 1};
+    const mt::Tensor<const float, 1> scale_tensor(scale, 3);
+    const mt::Tensor<const float, 1> offset_tensor(offset, 3);
+    measure("hwc uint8 -> chw float convert", bytes, [&]() {
+        mt::convert(mt::permute(hwc, order), chw, scale_tensor, offset_tensor, 0);
+    });
+
+    // Dense conversions of the same number of elements
+    const mt::Tensor<const uint8_t, 1> bytes_in(image.data(), static_cast<uint32_t>(image.size()));
+    mt::Tensor<float, 1> floats(planar.data(), static_cast<uint32_t>(planar.size()));
+    measure("uint8 -> float scaled loop", bytes, [&]() {
+        for (uint32_t i = 0; i < bytes_in.getShape()[0]; ++i)
+        {
+            floats(i) = static_cast<float>(bytes_in(i)) * scale[0] + offset[0];
+        }
+    });
+    measure("uint8 -> float scaled convert", bytes, [&]() { mt::convert(bytes_in, floats, scale[0], offset[0]); });
+    std::vector<uint8_t> saturated(image.size());
+    mt::Tensor<uint8_t, 1> bytes_out(saturated.data(), static_cast<uint32_t>(saturated.size()));
+    const mt::Tensor<const float, 1> floats_in(planar.data(), floats.getShape());
+    measure("float -> uint8 saturating loop", bytes, [&]() {
+        for (uint32_t i = 0; i < bytes_out.getShape()[0]; ++i)
+        {
+            const float x = floats_in(i) * 255.F;
+            bytes_out(i) = static_cast<uint8_t>(x < 0 ? 0 : x > 255 ? 255 : x);
+        }
+    });
+    measure("float -> uint8 saturating convert", bytes, [&]() { mt::convert(floats_in, bytes_out, 255, 0); });
+
+    // Half precision storage of the normalized frame
+    std::vector<mt::float16> halves(planar.size());
+    mt::Tensor<mt::float16, 1> half_out(halves.data(), floats.getShape());
+    const mt::Tensor<const mt::float16, 1> half_in(halves.data(), floats.getShape());
+    const size_t half_bytes = planar.size() * (sizeof(float) + sizeof(mt::float16));
+    measure("float -> float16 loop", half_bytes, [&]() {
+        for (uint32_t i = 0; i < half_out.getShape()[0]; ++i)
+        {
+            half_out(i) = floats_in(i);
+        }
+    });
+    measure("float -> float16 convert", half_bytes, [&]() { mt::convert(floats_in, half_out); });
+    measure("float16 -> float loop", half_bytes, [&]() {
+        for (uint32_t i = 0; i < floats.getShape()[0]; ++i)
+        {
+            floats(i) = half_in(i);
+        }
+    });
+    measure("float16 -> float convert", half_bytes, [&]() { mt::convert(half_in, floats); });
+    std::vector<mt::bfloat16> bhalves(planar.size());
+    mt::Tensor<mt::bfloat16, 1> bfloat_out(bhalves.data(), floats.getShape());
+    measure("float -> bfloat16 loop", half_bytes, [&]() {
+        for (uint32_t i = 0; i < bfloat_out.getShape()[0]; ++i)
+        {
+            bfloat_out(i) = floats_in(i);
+        }
+    });
+    measure("float -> bfloat16 convert", half_bytes, [&]() { mt::convert(floats_in, bfloat_out); });
+}
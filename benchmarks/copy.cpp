@@ -0,0 +1,102 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Tensor.hpp>
+
+#include <string>
+#include <vector>
+
+// The row by row recursion copyTo used before dimensions were coalesced, kept as a baseline
+template <class T>
+void recursiveCopy(mt::Tensor<const T, 1> src, mt::Tensor<T, 1> dst)
+{
+    for (uint32_t i = 0; i < dst.getShape()[0]; ++i)
+    {
+        dst[i] = src[i];
+    }
+}
+
+template <class T, uint8_t D>
+void recursiveCopy(mt::Tensor<const T, D> src, mt::Tensor<T, D> dst)
+{
+    for (uint32_t i = 0; i < dst.getShape()[0]; ++i)
+    {
+        recursiveCopy<T>(src[i], dst[i]);
+    }
+}
+
+template <uint8_t D>
+void benchCopy(const std::string& name, mt::Shape<D> src_shape, size_t src_elements)
+{
+    std::vector<float> src_data(src_elements, 1.0F);
+    mt::Shape<D> dst_shape = src_shape;
+    dst_shape.calculateStride();
+    std::vector<float> dst_data(dst_shape.numElements());
+
+    mt::Tensor<const float, D> src(src_data.data(), src_shape);
+    mt::Tensor<float, D> dst(dst_data.data(), dst_shape);
+
+    // Every element is read once and written once
+    const size_t bytes = 2 * dst_shape.numElements() * sizeof(float);
+    mt::ThreadPool& pool = *mt::ThreadPool::getDefault();
+    measure("copy recursive " + name, bytes, [&]() { recursiveCopy<float>(src, dst); });
+    measure("copy copyTo " + name, bytes, [&]() { src.copyTo(dst); });
+    measure("copy copyTo parallel " + name, bytes, [&]() { src.copyTo(dst, pool); });
+}
+
+void benchmarkCopy()
+{
+    {
+        mt::Shape<4> shape(8, 3, 224, 224);
+        benchCopy("dense 8x3x224x224", shape, shape.numElements());
+    }
+    {
+        mt::Shape<4> shape(64, 64, 8, 8);
+        benchCopy("dense 64x64x8x8", shape, shape.numElements());
+    }
+    {
+        // Center crop of a 8x3x256x256 batch
+        mt::Shape<4> shape(8, 3, 224, 224);
+        shape.setStride(3, 1);
+        shape.setStride(2, 256);
+        shape.setStride(1, 256 * 256);
+        shape.setStride(0, 3 * 256 * 256);
+        benchCopy("crop 8x3x224x224 of 256x256", shape, 8 * 3 * 256 * 256);
+    }
+    {
+        // Every other column of a 8x3x224x448 batch
+        mt::Shape<4> shape(8, 3, 224, 224);
+        shape.setStride(3, 2);
+        shape.setStride(2, 448);
+        shape.setStride(1, 224 * 448);
+        shape.setStride(0, 3 * 224 * 448);
+        benchCopy("step 2 8x3x224x224", shape, 8 * 3 * 224 * 448);
+    }
+    {
+        mt::Shape<2> shape = mt::permuteShape(mt::Shape<2>(4096, 4096), {1, 0});
+        benchCopy("transpose 4096x4096", shape, shape.numElements());
+    }
+    {
+        mt::Shape<4> shape = mt::permuteShape(mt::Shape<4>(8, 64, 112, 112), {0, 2, 3, 1});
+        benchCopy("NCHW to NHWC 8x64x112x112", shape, shape.numElements());
+    }
+    {
+        mt::Shape<4> shape = mt::permuteShape(mt::Shape<4>(8, 112, 112, 64), {0, 3, 1, 2});
+        benchCopy("NHWC to NCHW 8x64x112x112", shape, shape.numElements());
+    }
+    {
+        // Drop the oldest of 16 frames of 3x224x224 from a ring buffer by moving the others one slot forward,
+        // copyTo walks the overlapping views in memmove order instead of going through a temporary
+        std::vector<float> ring(16 * 3 * 224 * 224, 1.0F);
+        std::vector<float> temporary(15 * 3 * 224 * 224);
+        mt::Tensor<float, 4> all(ring.data(), {16, 3, 224, 224});
+        const mt::Tensor<float, 4> head = mt::slice(all, mt::Range(0, 15));
+        const mt::Tensor<float, 4> tail = mt::slice(all, mt::Range(1));
+        const mt::Tensor<float, 4> buffer(temporary.data(), head.getShape());
+        const size_t bytes = 2 * temporary.size() * sizeof(float);
+        measure("copy ring shift temporary 15x3x224x224", 2 * bytes, [&]() {
+            tail.copyTo(buffer);
+            buffer.copyTo(head);
+        });
+        measure("copy ring shift copyTo 15x3x224x224", bytes, [&]() { tail.copyTo(head); });
+    }
+}
@@ -0,0 +1,34 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Expression.hpp>
+
+#include <vector>
+
+void benchmarkExpression()
+{
+    const uint32_t rows = 1000;
+    const uint32_t cols = 10000;
+    std::vector<float> a_data(rows * cols, 1.0F);
+    std::vector<float> b_data(rows * cols, 2.0F);
+    std::vector<float> c_data(rows * cols, 3.0F);
+    std::vector<float> tmp_data(rows * cols);
+    std::vector<float> out_data(rows * cols);
+    mt::Tensor<float, 2> a(a_data.data(), {rows, cols});
+    mt::Tensor<float, 2> b(b_data.data(), {rows, cols});
+    mt::Tensor<float, 2> c(c_data.data(), {rows, cols});
+    mt::Tensor<float, 2> out(out_data.data(), {rows, cols});
+
+    // One pass per operation with a temporary, as chained hand written loops do
+    const size_t bytes = 4 * out_data.size() * sizeof(float);
+    measure("a * b + c 1000x10000 two passes", bytes, [&]() {
+        for (size_t i = 0; i < tmp_data.size(); ++i)
+        {
+            tmp_data[i] = a_data[i] * b_data[i];
+        }
+        for (size_t i = 0; i < out_data.size(); ++i)
+        {
+            out_data[i] = tmp_data[i] + c_data[i];
+        }
+    });
+    measure("a * b + c 1000x10000 fused", bytes, [&]() { out = a * b + c; });
+}
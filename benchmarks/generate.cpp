@@ -0,0 +1,51 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Generate.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+void benchmarkGenerate()
+{
+    // A batch of 16 RGB 224x224 images worth of floats
+    const uint32_t n = 16 * 3 * 224 * 224;
+    std::vector<float> data(n);
+    mt::Tensor<float, 1> dense(data.data(), n);
+    mt::ThreadPool& pool = *mt::ThreadPool::getDefault();
+    const size_t bytes = n * sizeof(float);
+    measure("fill std::fill", bytes, [&]() { std::fill(data.begin(), data.end(), 1.0F); });
+    measure("fill", bytes, [&]() { mt::fill(dense, 1.0F); });
+    measure("fill parallel", bytes, [&]() { mt::fill(dense, 1.0F, &pool); });
+    measure("iota std::iota", bytes, [&]() { std::iota(data.begin(), data.end(), 0.0F); });
+    measure("iota", bytes, [&]() { mt::iota(dense); });
+    measure("iota parallel", bytes, [&]() { mt::iota(dense, 0, 1, &pool); });
+
+    std::mt19937 engine(42);
+    std::uniform_real_distribution<float> uniform(-1, 1);
+    std::normal_distribution<float> normal(0, 1);
+    measure("uniform std::mt19937", bytes, [&]() {
+        for (float& value : data)
+        {
+            value = uniform(engine);
+        }
+    });
+    measure("uniform philox", bytes, [&]() { mt::randomUniform(dense, -1.0F, 1.0F, 42); });
+    measure("uniform philox parallel", bytes, [&]() { mt::randomUniform(dense, -1.0F, 1.0F, 42, &pool); });
+    measure("normal std::mt19937", bytes, [&]() {
+        for (float& value : data)
+        {
+            value = normal(engine);
+        }
+    });
+    measure("normal philox", bytes, [&]() { mt::randomNormal(dense, 0.0F, 1.0F, 42); });
+    measure("normal philox parallel", bytes, [&]() { mt::randomNormal(dense, 0.0F, 1.0F, 42, &pool); });
+
+    // Every other element of a strided view
+    std::vector<float> wide(2 * n);
+    mt::Shape<1> every_other(n);
+    every_other.setStride(0, 2);
+    const mt::Tensor<float, 1> strided(wide.data(), every_other);
+    measure("uniform philox step 2", bytes, [&]() { mt::randomUniform(strided, -1.0F, 1.0F, 42); });
+}
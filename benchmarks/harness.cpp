@@ -0,0 +1,85 @@
+#include "benchmarks.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+double BenchmarkResult::percentileMs(double percentile) const
+{
+    if (samples_ms.empty())
+    {
+        return 0;
+    }
+    std::vector<double> sorted(samples_ms);
+    std::sort(sorted.begin(), sorted.end());
+    // Linear interpolation between the closest ranks
+    const double rank = percentile / 100 * static_cast<double>(sorted.size() - 1);
+    const size_t lower = static_cast<size_t>(rank);
+    const size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+}
+
+double BenchmarkResult::gigabytesPerSecond() const
+{
+    const double median = medianMs();
+    return median > 0 ? static_cast<double>(bytes) / median * 1e-6 : 0;
+}
+
+int& benchmarkRepetitions()
+{
+    static int repetitions = 15;
+    return repetitions;
+}
+
+static std::vector<BenchmarkResult>& results()
+{
+    static std::vector<BenchmarkResult> out;
+    return out;
+}
+
+void recordBenchmark(BenchmarkResult result)
+{
+    std::printf("%-48s median %10.4f ms  p10 %10.4f ms  p90 %10.4f ms  %8.2f GB/s\n",
+                result.name.c_str(),
+                result.medianMs(),
+                result.percentileMs(10),
+                result.percentileMs(90),
+                result.gigabytesPerSecond());
+    results().push_back(std::move(result));
+}
+
+const std::vector<BenchmarkResult>& benchmarkResults()
+{
+    return results();
+}
+
+bool writeBenchmarkJson(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::fprintf(file, "[\n");
+    for (size_t i = 0; i < results().size(); ++i)
+    {
+        const BenchmarkResult& result = results()[i];
+        // Names are plain ascii without quotes or backslashes
+        std::fprintf(file,
+                     "  {\"name\": \"%s\", \"bytes\": %zu, \"iterations\": %d, \"repetitions\": %zu, "
+                     "\"median_ms\": %.6g, \"p10_ms\": %.6g, \"p90_ms\": %.6g, \"min_ms\": %.6g, "
+                     "\"max_ms\": %.6g, \"gb_per_s\": %.6g}%s\n",
+                     result.name.c_str(),
+                     result.bytes,
+                     result.iterations,
+                     result.samples_ms.size(),
+                     result.medianMs(),
+                     result.percentileMs(10),
+                     result.percentileMs(90),
+                     result.percentileMs(0),
+                     result.percentileMs(100),
+                     result.gigabytesPerSecond(),
+                     i + 1 == results().size() ? "" : ",");
+    }
+    std::fprintf(file, "]\n");
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,80 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Tensor.hpp>
+
+#include <string>
+#include <vector>
+
+// Fills the view the way operator= did before, with a division and modulo per dimension per element
+template <uint8_t D>
+void linearIndexFill(mt::Tensor<float, D> tensor, const std::vector<float>& data)
+{
+    const mt::Shape<D> shape = tensor.getShape();
+    const size_t size = shape.numElements();
+    for (size_t i = 0; i < size; ++i)
+    {
+        tensor.data()[shape.index(i)] = data[i];
+    }
+}
+
+void nestedLoopFill(mt::Tensor<float, 3> tensor, const std::vector<float>& data)
+{
+    const mt::Shape<3> shape = tensor.getShape();
+    float* ptr = tensor.data();
+    size_t i = 0;
+    for (uint32_t a = 0; a < shape[0]; ++a)
+    {
+        for (uint32_t b = 0; b < shape[1]; ++b)
+        {
+            for (uint32_t c = 0; c < shape[2]; ++c)
+            {
+                ptr[a * shape.getStride(0) + b * shape.getStride(1) + c * shape.getStride(2)] = data[i++];
+            }
+        }
+    }
+}
+
+void iteratorFill(mt::Tensor<float, 3> tensor, const std::vector<float>& data)
+{
+    auto src = data.begin();
+    for (float& val : mt::elements(tensor))
+    {
+        val = *src;
+        ++src;
+    }
+}
+
+void benchFill(const std::string& name, mt::Shape<3> shape, size_t elements)
+{
+    std::vector<float> storage(elements);
+    std::vector<float> data(shape.numElements(), 2.0F);
+    mt::Tensor<float, 3> tensor(storage.data(), shape);
+
+    const size_t bytes = 2 * data.size() * sizeof(float);
+    measure(name + " linear index", bytes, [&]() { linearIndexFill(tensor, data); });
+    measure(name + " nested loop", bytes, [&]() { nestedLoopFill(tensor, data); });
+    measure(name + " iterator", bytes, [&]() { iteratorFill(tensor, data); });
+}
+
+void benchmarkIteration()
+{
+    {
+        mt::Shape<3> shape(3, 512, 512);
+        benchFill("fill dense 3x512x512", shape, shape.numElements());
+    }
+    {
+        // Interleaved channel view of a 512x512x4 image
+        mt::Shape<3> shape(3, 512, 512);
+        shape.setStride(2, 4);
+        shape.setStride(1, 512 * 4);
+        shape.setStride(0, 1);
+        benchFill("fill channel view 3x512x512", shape, 512 * 512 * 4);
+    }
+    {
+        mt::Shape<3> shape(64, 64, 7);
+        shape.setStride(2, 1);
+        shape.setStride(1, 8);
+        shape.setStride(0, 64 * 8);
+        benchFill("fill padded rows 64x64x7", shape, 64 * 64 * 8);
+    }
+}
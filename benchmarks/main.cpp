@@ -0,0 +1,93 @@
+#include "benchmarks.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    struct Group
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const Group GROUPS[] = {{"access", benchmarkAccess},
+                            {"copy", benchmarkCopy},
+                            {"iteration", benchmarkIteration},
+                            {"expression", benchmarkExpression},
+                            {"simd", benchmarkSimd},
+                            {"reduce", benchmarkReduce},
+                            {"matmul", benchmarkMatmul},
+                            {"print", benchmarkPrint},
+                            {"static", benchmarkStaticShape},
+                            {"convert", benchmarkConvert},
+                            {"blocked", benchmarkBlocked},
+                            {"generate", benchmarkGenerate},
+                            {"conv", benchmarkConv}};
+
+    int usage(const char* program)
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--json PATH] [--repetitions N] [GROUP...]\n"
+                     "Runs every group when none are named, groups:",
+                     program);
+        for (const Group& group : GROUPS)
+        {
+            std::fprintf(stderr, " %s", group.name);
+        }
+        std::fprintf(stderr, "\n");
+        return 1;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string json;
+    bool selected[sizeof(GROUPS) / sizeof(GROUPS[0])] = {};
+    bool any_selected = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            json = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            benchmarkRepetitions() = std::atoi(argv[++i]);
+            if (benchmarkRepetitions() < 1)
+            {
+                return usage(argv[0]);
+            }
+            continue;
+        }
+        bool found = false;
+        for (size_t g = 0; g < sizeof(GROUPS) / sizeof(GROUPS[0]); ++g)
+        {
+            if (std::strcmp(argv[i], GROUPS[g].name) == 0)
+            {
+                selected[g] = found = any_selected = true;
+            }
+        }
+        if (!found)
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    for (size_t g = 0; g < sizeof(GROUPS) / sizeof(GROUPS[0]); ++g)
+    {
+        if (!any_selected || selected[g])
+        {
+            GROUPS[g].run();
+        }
+    }
+    if (!json.empty() && !writeBenchmarkJson(json))
+    {
+        std::fprintf(stderr, "Unable to write %s\n", json.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Matmul.hpp>
+
+#include <string>
+#include <vector>
+
+// Textbook triple loop with the inner loop running along rows of b and c
+void naiveMatmul(mt::Tensor<const float, 2> a, mt::Tensor<const float, 2> b, mt::Tensor<float, 2> c)
+{
+    const uint32_t m = a.getShape()[0];
+    const uint32_t k = a.getShape()[1];
+    const uint32_t n = b.getShape()[1];
+    for (uint32_t i = 0; i < m; ++i)
+    {
+        for (uint32_t j = 0; j < n; ++j)
+        {
+            c(i, j) = 0;
+        }
+        for (uint32_t p = 0; p < k; ++p)
+        {
+            const float value = a(i, p);
+            for (uint32_t j = 0; j < n; ++j)
+            {
+                c(i, j) += value * b(p, j);
+            }
+        }
+    }
+}
+
+void benchmarkMatmul()
+{
+    mt::ThreadPool& pool = *mt::ThreadPool::getDefault();
+    const uint32_t sizes[] = {64, 128, 256, 512};
+    for (uint32_t size : sizes)
+    {
+        std::vector<float> a_data(size * size, 0.5F);
+        std::vector<float> b_data(size * size, 0.25F);
+        std::vector<float> c_data(size * size);
+        mt::Tensor<const float, 2> a(a_data.data(), {size, size});
+        mt::Tensor<const float, 2> b(b_data.data(), {size, size});
+        mt::Tensor<const float, 2> b_t = mt::transpose(b, 0, 1);
+        mt::Tensor<float, 2> c(c_data.data(), {size, size});
+        const std::string name = "matmul " + std::to_string(size) + "x" + std::to_string(size);
+        // The three matrices, the throughput of a compute bound kernel is better read from the time
+        const size_t bytes = 3 * c_data.size() * sizeof(float);
+        measure(name + " naive", bytes, [&]() { naiveMatmul(a, b, c); });
+        measure(name, bytes, [&]() { mt::matmul(a, b, c); });
+        measure(name + " b transposed", bytes, [&]() { mt::matmul(a, b_t, c); });
+        measure(name + " parallel", bytes, [&]() { mt::matmul(a, b, c, &pool); });
+    }
+}
@@ -0,0 +1,49 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Format.hpp>
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Keeps the formatted text from being optimized away
+    volatile size_t g_print_chars = 0;
+} // namespace
+
+void benchmarkPrint()
+{
+    const uint32_t rows = 1000;
+    const uint32_t cols = 1000;
+    std::vector<float> float_data(rows * cols);
+    std::vector<int32_t> int_data(rows * cols);
+    for (uint32_t i = 0; i < rows * cols; ++i)
+    {
+        float_data[i] = static_cast<float>(i) * 0.001F;
+        int_data[i] = static_cast<int32_t>(i);
+    }
+    mt::Tensor<const float, 2> floats(float_data.data(), {rows, cols});
+    mt::Tensor<const int32_t, 2> ints(int_data.data(), {rows, cols});
+
+    mt::TensorFormatter formatter;
+    mt::FormatOptions summarized;
+    summarized.summarize = true;
+    mt::TensorFormatter summary(summarized);
+    // Bytes of the elements that are formatted
+    const size_t bytes = float_data.size() * sizeof(float);
+    size_t chars = 0;
+    measure("print 1000x1000 float operator<<", bytes, [&]() {
+        std::ostringstream os;
+        os << floats;
+        chars += os.str().size();
+    });
+    measure("print 1000x1000 float format", bytes, [&]() { chars += formatter.format(floats).size(); });
+    measure("print 1000x1000 float summarized", 0, [&]() { chars += summary.format(floats).size(); });
+    measure("print 1000x1000 int operator<<", bytes, [&]() {
+        std::ostringstream os;
+        os << ints;
+        chars += os.str().size();
+    });
+    measure("print 1000x1000 int format", bytes, [&]() { chars += formatter.format(ints).size(); });
+    g_print_chars = chars;
+}
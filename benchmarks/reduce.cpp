@@ -0,0 +1,51 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Reduce.hpp>
+
+#include <string>
+#include <vector>
+
+// Straight loops over the logical indices, accumulating in float like a hand written reduction would
+void naiveSum(mt::Tensor<const float, 2> in, uint8_t axis, float* out)
+{
+    const mt::Shape<2> shape = in.getShape();
+    const uint32_t outer = shape[axis == 0 ? 1 : 0];
+    for (uint32_t i = 0; i < outer; ++i)
+    {
+        float acc = 0;
+        for (uint32_t k = 0; k < shape[axis]; ++k)
+        {
+            acc += axis == 0 ? in(k, i) : in(i, k);
+        }
+        out[i] = acc;
+    }
+}
+
+void benchmarkReduce()
+{
+    const uint32_t rows = 1024;
+    const uint32_t cols = 4096;
+    std::vector<float> data(rows * cols, 0.5F);
+    std::vector<float> out(cols);
+    mt::Tensor<const float, 2> in(data.data(), {rows, cols});
+    mt::Tensor<float, 1> row_sums(out.data(), rows);
+    mt::Tensor<float, 1> col_sums(out.data(), cols);
+    mt::ThreadPool& pool = *mt::ThreadPool::getDefault();
+    const size_t bytes = data.size() * sizeof(float);
+
+    const mt::SimdIsa supported = mt::detectSimdIsa();
+    for (uint8_t isa = 0; isa <= static_cast<uint8_t>(supported); ++isa)
+    {
+        mt::setSimdIsa(static_cast<mt::SimdIsa>(isa));
+        measure(std::string("sum axis 1 1024x4096 ") + mt::simdIsaName(mt::getSimdIsa()), bytes, [&]() {
+            mt::sum(in, 1, row_sums);
+        });
+    }
+    mt::setSimdIsa(supported);
+
+    measure("sum axis 1 1024x4096 naive", bytes, [&]() { naiveSum(in, 1, out.data()); });
+    measure("sum axis 1 1024x4096 parallel", bytes, [&]() { mt::sum(in, 1, row_sums, &pool); });
+    measure("sum axis 0 1024x4096 naive", bytes, [&]() { naiveSum(in, 0, out.data()); });
+    measure("sum axis 0 1024x4096", bytes, [&]() { mt::sum(in, 0, col_sums); });
+    measure("sum axis 0 1024x4096 parallel", bytes, [&]() { mt::sum(in, 0, col_sums, &pool); });
+}
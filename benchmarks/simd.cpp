@@ -0,0 +1,38 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/Elementwise.hpp>
+
+#include <string>
+#include <vector>
+
+template <class T>
+void benchIsa(const char* type_name, uint32_t size)
+{
+    std::vector<T> a_data(size, T(3));
+    std::vector<T> b_data(size, T(2));
+    std::vector<T> out_data(size);
+    mt::Tensor<const T, 1> a(a_data.data(), size);
+    mt::Tensor<const T, 1> b(b_data.data(), size);
+    mt::Tensor<T, 1> out(out_data.data(), size);
+
+    const mt::SimdIsa supported = mt::detectSimdIsa();
+    for (uint8_t isa = 0; isa <= static_cast<uint8_t>(supported); ++isa)
+    {
+        mt::setSimdIsa(static_cast<mt::SimdIsa>(isa));
+        const std::string suffix = std::string(" ") + type_name + " " + mt::simdIsaName(mt::getSimdIsa()) + " " +
+                                   std::to_string(size);
+        const size_t bytes = size * sizeof(T);
+        measure("add" + suffix, 3 * bytes, [&]() { mt::add(a, b, out); });
+        measure("fma" + suffix, 4 * bytes, [&]() { mt::fma(a, b, a, out); });
+        measure("clamp" + suffix, 2 * bytes, [&]() { mt::clamp(a, T(1), T(2), out); });
+    }
+    mt::setSimdIsa(supported);
+}
+
+void benchmarkSimd()
+{
+    benchIsa<float>("float", 1 << 20);
+    benchIsa<double>("double", 1 << 20);
+    benchIsa<int32_t>("int32", 1 << 20);
+    benchIsa<uint8_t>("uint8", 1 << 22);
+}
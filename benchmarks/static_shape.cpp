@@ -0,0 +1,60 @@
+#include "benchmarks.hpp"
+
+#include <minitensor/StaticShape.hpp>
+
+#include <vector>
+
+namespace
+{
+    // out = a * b for 4x4 transforms, the same source for both kinds of views. Kept out of line like a call
+    // into geometry code would be, so the shape of a runtime view has to be read on every call.
+    template <class A, class B, class OUT>
+#ifdef __GNUC__
+    __attribute__((noinline))
+#endif
+    void compose(const A& a, const B& b, OUT out)
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            for (uint32_t j = 0; j < 4; ++j)
+            {
+                float sum = 0;
+                for (uint32_t k = 0; k < 4; ++k)
+                {
+                    sum += a(i, k) * b(k, j);
+                }
+                out(i, j) = sum;
+            }
+        }
+    }
+} // namespace
+
+void benchmarkStaticShape()
+{
+    const uint32_t count = 1 << 16;
+    std::vector<float> a_data(count * 16, 0.5F);
+    std::vector<float> b_data(count * 16, 0.25F);
+    std::vector<float> out_data(count * 16);
+    const size_t bytes = 3 * out_data.size() * sizeof(float);
+
+    mt::Tensor<const float, 3> a(a_data.data(), {count, 4, 4});
+    mt::Tensor<const float, 3> b(b_data.data(), {count, 4, 4});
+    mt::Tensor<float, 3> out(out_data.data(), {count, 4, 4});
+    measure("compose 4x4 transforms Shape<3>", bytes, [&]() {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            compose(a[i], b[i], out[i]);
+        }
+    });
+
+    typedef mt::StaticShape<mt::DYNAMIC_SIZE, 4, 4> BatchShape;
+    const mt::StaticTensor<const float, BatchShape> static_a(a_data.data(), BatchShape(count));
+    const mt::StaticTensor<const float, BatchShape> static_b(b_data.data(), BatchShape(count));
+    mt::StaticTensor<float, BatchShape> static_out(out_data.data(), BatchShape(count));
+    measure("compose 4x4 transforms StaticShape", bytes, [&]() {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            compose(static_a[i], static_b[i], static_out[i]);
+        }
+    });
+}
@@ -0,0 +1,240 @@
+#ifndef MINITENSOR_ALLOCATOR_HPP
+#define MINITENSOR_ALLOCATOR_HPP
+#include "defines.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    struct AllocatorStats
+    {
+        // Bytes currently handed out, rounded up to the allocator's size class
+        size_t live_bytes = 0;
+        size_t peak_bytes = 0;
+        // Bytes held by the allocator for reuse that are not handed out
+        size_t cached_bytes = 0;
+        size_t allocations = 0;
+        // Allocations served from previously released memory
+        size_t pool_hits = 0;
+
+        double hitRate() const { return allocations == 0 ? 0.0 : static_cast<double>(pool_hits) / allocations; }
+    };
+
+    // Interface used by TensorBuffer to obtain storage, every allocation is aligned to ALIGNMENT bytes
+    class Allocator
+    {
+      public:
+        static constexpr const size_t ALIGNMENT = 64;
+
+        virtual ~Allocator() = default;
+        virtual void* allocate(size_t bytes) = 0;
+        virtual void deallocate(void* ptr, size_t bytes) = 0;
+        virtual AllocatorStats stats() const = 0;
+
+        static Allocator* getDefault();
+        static void setDefault(Allocator* allocator);
+
+      protected:
+        static void* alignedMalloc(size_t bytes)
+        {
+            // Over allocate and keep the pointer returned by malloc just before the aligned block
+            if (bytes > std::numeric_limits<size_t>::max() - ALIGNMENT - sizeof(void*))
+            {
+                throw std::bad_alloc();
+            }
+            void* raw = std::malloc(bytes + ALIGNMENT + sizeof(void*));
+            if (raw == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+            void* aligned = reinterpret_cast<void*>((start + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+            static_cast<void**>(aligned)[-1] = raw;
+            return aligned;
+        }
+
+        static void alignedFree(void* ptr)
+        {
+            if (ptr != nullptr)
+            {
+                std::free(static_cast<void**>(ptr)[-1]);
+            }
+        }
+    };
+
+    // Allocates and releases directly from the heap on every call
+    class AlignedAllocator : public Allocator
+    {
+        mutable std::mutex m_mtx;
+        AllocatorStats m_stats;
+
+      public:
+        void* allocate(size_t bytes) override
+        {
+            void* ptr = alignedMalloc(bytes);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            ++m_stats.allocations;
+            m_stats.live_bytes += bytes;
+            m_stats.peak_bytes = m_stats.live_bytes > m_stats.peak_bytes ? m_stats.live_bytes : m_stats.peak_bytes;
+            return ptr;
+        }
+
+        void deallocate(void* ptr, size_t bytes) override
+        {
+            alignedFree(ptr);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stats.live_bytes -= bytes;
+        }
+
+        AllocatorStats stats() const override
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_stats;
+        }
+    };
+
+    // Keeps released blocks in per size class free lists so buffers of recurring sizes are recycled.
+    // Size classes split every power of two into four steps which bounds the rounding waste to 25%.
+    class PoolAllocator : public Allocator
+    {
+        mutable std::mutex m_mtx;
+        std::map<size_t, std::vector<void*>> m_free;
+        AllocatorStats m_stats;
+        size_t m_max_cached;
+
+        void releaseCached(size_t target)
+        {
+            auto itr = m_free.end();
+            while (m_stats.cached_bytes > target && itr != m_free.begin())
+            {
+                // Largest blocks first, they return the most memory per free
+                --itr;
+                while (!itr->second.empty() && m_stats.cached_bytes > target)
+                {
+                    alignedFree(itr->second.back());
+                    itr->second.pop_back();
+                    m_stats.cached_bytes -= itr->first;
+                }
+            }
+        }
+
+      public:
+        explicit PoolAllocator(size_t max_cached_bytes = size_t(1) << 31) : m_max_cached(max_cached_bytes) {}
+
+        ~PoolAllocator() override { releaseCached(0); }
+
+        static size_t sizeClass(size_t bytes)
+        {
+            if (bytes <= ALIGNMENT)
+            {
+                return ALIGNMENT;
+            }
+            uint8_t log2 = 0;
+            for (size_t val = bytes - 1; val > 1; val >>= 1)
+            {
+                ++log2;
+            }
+            const size_t step = size_t(1) << (log2 - 2);
+            if (bytes > std::numeric_limits<size_t>::max() - (step - 1))
+            {
+                throw std::bad_alloc();
+            }
+            return (bytes + step - 1) & ~(step - 1);
+        }
+
+        void* allocate(size_t bytes) override
+        {
+            const size_t size = sizeClass(bytes);
+            void* ptr = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                auto itr = m_free.find(size);
+                if (itr != m_free.end() && !itr->second.empty())
+                {
+                    ptr = itr->second.back();
+                    itr->second.pop_back();
+                    m_stats.cached_bytes -= size;
+                    ++m_stats.pool_hits;
+                }
+            }
+            // Counted once the block exists, a failed allocation leaves the stats untouched
+            if (ptr == nullptr)
+            {
+                ptr = alignedMalloc(size);
+            }
+            std::lock_guard<std::mutex> lock(m_mtx);
+            ++m_stats.allocations;
+            m_stats.live_bytes += size;
+            m_stats.peak_bytes = m_stats.live_bytes > m_stats.peak_bytes ? m_stats.live_bytes : m_stats.peak_bytes;
+            return ptr;
+        }
+
+        void deallocate(void* ptr, size_t bytes) override
+        {
+            if (ptr == nullptr)
+            {
+                return;
+            }
+            const size_t size = sizeClass(bytes);
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stats.live_bytes -= size;
+            if (size > m_max_cached)
+            {
+                alignedFree(ptr);
+                return;
+            }
+            m_free[size].push_back(ptr);
+            m_stats.cached_bytes += size;
+            releaseCached(m_max_cached);
+        }
+
+        // Returns all cached blocks to the heap
+        void trim()
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            releaseCached(0);
+        }
+
+        AllocatorStats stats() const override
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_stats;
+        }
+    };
+
+    namespace detail
+    {
+        inline PoolAllocator& defaultPool()
+        {
+            static PoolAllocator pool;
+            return pool;
+        }
+
+        inline Allocator*& defaultAllocator()
+        {
+            static Allocator* allocator = &defaultPool();
+            return allocator;
+        }
+    } // namespace detail
+
+    inline Allocator* Allocator::getDefault() { return detail::defaultAllocator(); }
+
+    // Passing nullptr restores the built in pool
+    inline void Allocator::setDefault(Allocator* allocator)
+    {
+        detail::defaultAllocator() = allocator != nullptr ? allocator : &detail::defaultPool();
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_ALLOCATOR_HPP
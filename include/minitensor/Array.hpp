@@ -5,10 +5,16 @@
 #include <cstddef>
 
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 namespace mt
 {
+    MT_INDEX_NAMESPACE_BEGIN
+
+    template <class T, uint8_t N>
+    class Array;
+
     template <class T, class U>
     constexpr auto revIndex(T val, U) -> typename std::enable_if<std::is_unsigned<T>::value, size_t>::type
     {
@@ -21,35 +27,29 @@ namespace mt
         return val < 0 ? n + val : val;
     }
 
+    template <uint8_t N, class... T>
+    struct IsArray : std::false_type
+    {
+    };
+
+    template <uint8_t N, class T>
+    struct IsArray<N, Array<T, N>> : std::true_type
+    {
+    };
+
     template <class T, uint8_t N>
     class Array
     {
         T m_data[N];
 
       public:
-        MT_XINLINE Array(const Array& other)
-        {
-            for(uint8_t i = 0; i < N; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
-        }
-        MT_XINLINE Array(Array& other)
-        {
-            for(uint8_t i = 0; i < N; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
-        }
-        MT_XINLINE Array(Array&& other)
-        {
-            for(uint8_t i = 0; i < N; ++i)
-            {
-                m_data[i] = other.m_data[i];
-            }
-        }
+        // Copies are the compiler generated member wise ones so arrays stay trivially copyable, the forwarding
+        // constructor is disabled for a single Array argument to not take over copies from non const lvalues
+        MT_XINLINE constexpr Array(const Array& other) = default;
+        MT_XINLINE constexpr Array(Array&& other) = default;
 
-        template <class... ARGS>
+        template <class... ARGS,
+                  class = typename std::enable_if<!IsArray<N, typename std::decay<ARGS>::type...>::value>::type>
         MT_XINLINE constexpr Array(ARGS&&... args) : m_data{static_cast<T>(std::forward<ARGS>(args))...}
         {
         }
@@ -58,16 +58,18 @@ namespace mt
         MT_XINLINE Array<T, N>& operator=(Array<T, N>&& other) = default;
 
         MT_XINLINE T& operator[](int16_t idx) { return m_data[revIndex(idx, N)]; }
-        MT_XINLINE const T& operator[](int16_t idx) const { return m_data[revIndex(idx, N)]; }
+        MT_XINLINE constexpr const T& operator[](int16_t idx) const { return m_data[revIndex(idx, N)]; }
 
         MT_XINLINE constexpr uint8_t size() const { return N; }
 
         T* begin() { return m_data; }
-        const T* begin() const { return m_data; }
+        constexpr const T* begin() const { return m_data; }
 
         T* end() { return m_data + N; }
-        const T* end() const { return m_data + N; }
+        constexpr const T* end() const { return m_data + N; }
     };
+
+    MT_INDEX_NAMESPACE_END
 } // namespace mt
 
 #include <ostream>
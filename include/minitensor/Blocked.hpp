@@ -0,0 +1,303 @@
+#ifndef MINITENSOR_BLOCKED_HPP
+#define MINITENSOR_BLOCKED_HPP
+#include "Shape.hpp"
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+#include <assert.h>
+#include <cstdint>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Layout of a D dimensional tensor with K of its dimensions split into blocks, like NCHW16c where channels
+    // come in blocks of 16 stored innermost, or a matrix stored as 8x8 tiles. The storage is dense in physical
+    // order: the D logical dimensions with the index of every blocked dimension divided by its block size,
+    // followed by the K positions inside the blocks in the order the dimensions were given. Sizes that are not a
+    // multiple of their block are padded to whole blocks. Block sizes are powers of two so indexing shifts and
+    // masks instead of dividing.
+    template <uint8_t D, uint8_t K>
+    class BlockedShape
+    {
+        Array<DimSize_t, D> m_size;
+        Array<uint8_t, K> m_dims;
+        // Per logical dimension, log2 of its block size and the mask of the position inside the block. Both are
+        // zero for dimensions that are not blocked, which also have an inner stride of zero.
+        Array<uint8_t, D> m_shift;
+        Array<DimSize_t, D> m_mask;
+        Array<Stride_t, D> m_outer_stride;
+        Array<Stride_t, D> m_inner_stride;
+        Shape<D + K> m_physical;
+
+        template <uint8_t I, class T>
+        size_t indexHelper(size_t out, T arg) const
+        {
+            const size_t idx = revIndex(arg, m_size[I]);
+            return out + m_outer_stride[I] * (idx >> m_shift[I]) + m_inner_stride[I] * (idx & m_mask[I]);
+        }
+
+        template <uint8_t I, class T, class... Ts>
+        size_t indexHelper(size_t out, T arg, Ts... args) const
+        {
+            return indexHelper<I + 1>(indexHelper<I>(out, arg), args...);
+        }
+
+      public:
+        BlockedShape() = default;
+
+        // Sizes of shape with dimension dims[k] split into blocks of blocks[k], the strides of shape are ignored
+        BlockedShape(const Shape<D>& shape, const uint8_t (&dims)[K], const DimSize_t (&blocks)[K])
+        {
+            for (uint8_t d = 0; d < D; ++d)
+            {
+                m_size[d] = shape[d];
+                m_shift[d] = 0;
+                m_mask[d] = 0;
+                m_physical.setShape(d, shape[d]);
+            }
+            for (uint8_t k = 0; k < K; ++k)
+            {
+                const uint8_t dim = dims[k];
+                assert(dim < D && m_mask[dim] == 0 && "Each dimension can be blocked once");
+                assert(blocks[k] > 1 && (blocks[k] & (blocks[k] - 1)) == 0 && "Blocks are powers of two");
+                m_dims[k] = dim;
+                while ((DimSize_t(1) << m_shift[dim]) < blocks[k])
+                {
+                    ++m_shift[dim];
+                }
+                m_mask[dim] = blocks[k] - 1;
+                m_physical.setShape(dim, (shape[dim] + blocks[k] - 1) >> m_shift[dim]);
+                m_physical.setShape(D + k, blocks[k]);
+            }
+            m_physical.calculateStride();
+            for (uint8_t d = 0; d < D; ++d)
+            {
+                m_outer_stride[d] = static_cast<Stride_t>(m_physical.getStride(d));
+                m_inner_stride[d] = 0;
+            }
+            for (uint8_t k = 0; k < K; ++k)
+            {
+                m_inner_stride[m_dims[k]] = static_cast<Stride_t>(m_physical.getStride(D + k));
+            }
+        }
+
+        // Offset of an element from its logical indices
+        template <class... T>
+        MT_XINLINE size_t index(T... args) const
+        {
+            static_assert(sizeof...(args) == D, "Expected an index per dimension");
+            return indexHelper<0>(0, args...);
+        }
+
+        // Logical size of dim
+        MT_XINLINE DimSize_t operator[](int16_t dim) const { return m_size[dim]; }
+
+        bool isBlocked(uint8_t dim) const { return m_mask[dim] != 0; }
+        // 1 for dimensions that are not blocked
+        DimSize_t blockSize(uint8_t dim) const { return m_mask[dim] + 1; }
+        // Logical dimension of block k, the physical dimension D + k
+        uint8_t blockedDim(uint8_t k) const { return m_dims[k]; }
+
+        // Dense shape of the storage in physical order, see BlockedTensor::physical
+        const Shape<D + K>& physicalShape() const { return m_physical; }
+
+        size_t numElements() const
+        {
+            size_t size = 1;
+            for (uint8_t d = 0; d < D; ++d)
+            {
+                size *= m_size[d];
+            }
+            return size;
+        }
+
+        // Elements of the storage including the padding of partial blocks
+        size_t numPhysicalElements() const { return m_physical.numElements(); }
+
+        bool operator==(const BlockedShape& other) const
+        {
+            for (uint8_t d = 0; d < D; ++d)
+            {
+                if (m_size[d] != other.m_size[d] || m_mask[d] != other.m_mask[d])
+                {
+                    return false;
+                }
+            }
+            for (uint8_t k = 0; k < K; ++k)
+            {
+                if (m_dims[k] != other.m_dims[k])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // NCHW sizes stored as NCHW<block>c, the layout of channel blocked convolutions
+    inline BlockedShape<4, 1> channelBlocked(const Shape<4>& nchw, DimSize_t block)
+    {
+        const uint8_t dims[] = {1};
+        const DimSize_t blocks[] = {block};
+        return BlockedShape<4, 1>(nchw, dims, blocks);
+    }
+
+    // Matrix stored as dense rows x cols tiles, the tiles in row major order
+    inline BlockedShape<2, 2> tiled(const Shape<2>& shape, DimSize_t rows, DimSize_t cols)
+    {
+        const uint8_t dims[] = {0, 1};
+        const DimSize_t blocks[] = {rows, cols};
+        return BlockedShape<2, 2>(shape, dims, blocks);
+    }
+
+    // View of elements in a blocked layout. Element access takes logical indices like Tensor, kernels that
+    // know the layout work on physical() instead, where the block is the innermost dense dimension.
+    template <class T, uint8_t D, uint8_t K>
+    class BlockedTensor
+    {
+        T* m_ptr;
+        BlockedShape<D, K> m_shape;
+
+      public:
+        BlockedTensor(T* ptr = nullptr, const BlockedShape<D, K>& shape = BlockedShape<D, K>())
+            : m_ptr(ptr), m_shape(shape)
+        {
+        }
+
+        template <class U, class = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        BlockedTensor(const BlockedTensor<U, D, K>& other) : m_ptr(other.data()), m_shape(other.getShape())
+        {
+        }
+
+        template <class... ARGS>
+        MT_XINLINE T* ptr(ARGS... args) const
+        {
+            return m_ptr + m_shape.index(args...);
+        }
+
+        template <class... ARGS>
+        MT_XINLINE T& operator()(ARGS... args) const
+        {
+            return *ptr(args...);
+        }
+
+        // The storage as a strided view in physical order, dimensions D to D + K - 1 are the positions inside
+        // the blocks. Padding elements are part of the view.
+        Tensor<T, D + K> physical() const { return Tensor<T, D + K>(m_ptr, m_shape.physicalShape()); }
+
+        MT_XINLINE const BlockedShape<D, K>& getShape() const { return m_shape; }
+        MT_XINLINE T* data() const { return m_ptr; }
+    };
+
+    namespace detail
+    {
+        // Splits a blocked layout into the regions of whole blocks and of the partial last block of every blocked
+        // dimension. fn gets each region as a strided view with the dimensions of the physical layout in both a
+        // logical tensor with shape logical and in the blocked storage, each with its offset in elements.
+        template <uint8_t D, uint8_t K, class F>
+        void forEachBlockRegion(const BlockedShape<D, K>& layout, const Shape<D>& logical, F&& fn)
+        {
+            for (uint32_t region = 0; region < (1U << K); ++region)
+            {
+                Shape<D + K> src;
+                Shape<D + K> dst = layout.physicalShape();
+                for (uint8_t d = 0; d < D; ++d)
+                {
+                    src.setShape(d, logical[d]);
+                    src.setStride(d, static_cast<Stride_t>(logical.getStride(d)));
+                }
+                int64_t src_offset = 0;
+                int64_t dst_offset = 0;
+                bool empty = false;
+                for (uint8_t k = 0; k < K; ++k)
+                {
+                    const uint8_t dim = layout.blockedDim(k);
+                    const DimSize_t block = layout.blockSize(dim);
+                    const DimSize_t whole = logical[dim] / block;
+                    const bool tail = (region >> k) & 1;
+                    const DimSize_t count = tail ? 1 : whole;
+                    const DimSize_t inner = tail ? logical[dim] % block : block;
+                    const int64_t stride = static_cast<Stride_t>(logical.getStride(dim));
+                    empty = empty || count == 0 || inner == 0;
+                    src.setShape(dim, count);
+                    src.setStride(dim, static_cast<Stride_t>(stride * block));
+                    src.setShape(D + k, inner);
+                    src.setStride(D + k, static_cast<Stride_t>(stride));
+                    dst.setShape(dim, count);
+                    dst.setShape(D + k, inner);
+                    if (tail)
+                    {
+                        src_offset += static_cast<int64_t>(whole) * block * stride;
+                        dst_offset += static_cast<int64_t>(whole) * static_cast<Stride_t>(dst.getStride(dim));
+                    }
+                }
+                if (!empty)
+                {
+                    fn(src, src_offset, dst, dst_offset);
+                }
+            }
+        }
+    } // namespace detail
+
+    // Copies a strided tensor into a blocked layout of the same logical sizes, padding elements are set to zero.
+    // Each region of whole or partial blocks is one copyStrided, which tiles the transposition the layouts need.
+    template <class A, class T, uint8_t D, uint8_t K>
+    void toBlocked(const Tensor<A, D>& src,
+                   const BlockedTensor<T, D, K>& dst,
+                   ThreadPool* pool = nullptr,
+                   uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(std::is_same<typename std::remove_const<A>::type, T>::value, "Use convert to change types");
+        const BlockedShape<D, K>& layout = dst.getShape();
+        const Shape<D> src_shape = src.getShape();
+        for (uint8_t d = 0; d < D; ++d)
+        {
+            assert(src_shape[d] == layout[d]);
+        }
+        const Tensor<T, D + K> physical = dst.physical();
+        for (uint8_t k = 0; k < K; ++k)
+        {
+            const uint8_t dim = layout.blockedDim(k);
+            const DimSize_t block = layout.blockSize(dim);
+            const int64_t used = layout[dim] % block;
+            if (used != 0)
+            {
+                // The positions past the end in the last block of dim
+                Shape<D + K> padding = physical.getShape();
+                int64_t offset = sliceDim(padding, dim, Range(-1));
+                offset += sliceDim(padding, D + k, Range(used));
+                fill(Tensor<T, D + K>(dst.data() + offset, padding), T(), pool, grain);
+            }
+        }
+        auto copy = [&](const Shape<D + K>& in, int64_t in_offset, const Shape<D + K>& out, int64_t out_offset) {
+            copyStrided<T, D + K>(src.data() + in_offset, in, dst.data() + out_offset, out, pool, grain);
+        };
+        detail::forEachBlockRegion(layout, src_shape, copy);
+    }
+
+    // Copies the elements of a blocked layout into a strided tensor of the same logical sizes
+    template <class A, class T, uint8_t D, uint8_t K>
+    void fromBlocked(const BlockedTensor<A, D, K>& src,
+                     Tensor<T, D> dst,
+                     ThreadPool* pool = nullptr,
+                     uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(std::is_same<typename std::remove_const<A>::type, T>::value, "Use convert to change types");
+        const BlockedShape<D, K>& layout = src.getShape();
+        const Shape<D> dst_shape = dst.getShape();
+        for (uint8_t d = 0; d < D; ++d)
+        {
+            assert(dst_shape[d] == layout[d]);
+        }
+        auto copy = [&](const Shape<D + K>& out, int64_t out_offset, const Shape<D + K>& in, int64_t in_offset) {
+            copyStrided<T, D + K>(src.data() + in_offset, in, dst.data() + out_offset, out, pool, grain);
+        };
+        detail::forEachBlockRegion(layout, dst_shape, copy);
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_BLOCKED_HPP
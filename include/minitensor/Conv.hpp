@@ -0,0 +1,789 @@
+#ifndef MINITENSOR_CONV_HPP
+#define MINITENSOR_CONV_HPP
+#include "Matmul.hpp"
+#include "Simd.hpp"
+#include "Tensor.hpp"
+#include "TensorBuffer.hpp"
+#include "ThreadPool.hpp"
+
+#include <assert.h>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Direct 2-D convolution and pooling over the last two dimensions of NCHW tensors, CHW images are a batch of one.
+// There is no im2col matrix: every output row packs the few input rows it reads, with their padding, into a small
+// buffer and the kernels slide over those rows with vector loads. Any operand can be a strided view such as a
+// crop, a slice or a permuted NHWC tensor.
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Stride, zero padding and dilation of a sliding window, index 0 along the height and 1 along the width
+    struct Window2d
+    {
+        uint32_t stride[2];
+        uint32_t padding[2];
+        uint32_t dilation[2];
+
+        Window2d(uint32_t stride_ = 1, uint32_t padding_ = 0, uint32_t dilation_ = 1)
+            : stride{stride_, stride_}, padding{padding_, padding_}, dilation{dilation_, dilation_}
+        {
+        }
+
+        // Number of window positions along axis for an input of size in and a kernel of size kernel
+        uint32_t outputSize(uint8_t axis, uint32_t in, uint32_t kernel) const
+        {
+            const int64_t extent = static_cast<int64_t>(dilation[axis]) * (kernel - 1) + 1;
+            const int64_t padded = static_cast<int64_t>(in) + 2 * padding[axis];
+            return padded < extent ? 0 : static_cast<uint32_t>((padded - extent) / stride[axis] + 1);
+        }
+    };
+
+    namespace detail
+    {
+        // Output row oy reads the kernel_h input rows oy * sy - py + ky * dy. Each is packed with its padding and
+        // split into sx phases of row_length elements, so that the input column ox * sx + kx * dx - px is element
+        // (kx * dx) % sx * row_length + ox + (kx * dx) / sx of the packed row. For every kx the inputs of
+        // consecutive outputs are then contiguous, whatever the stride. Rows are computed in blocks, padded_w
+        // rounds the output width up to whole blocks.
+        struct WindowGeometry
+        {
+            uint32_t in_h;
+            uint32_t in_w;
+            uint32_t out_h;
+            uint32_t out_w;
+            uint32_t kernel_h;
+            uint32_t kernel_w;
+            Window2d window;
+            uint32_t padded_w;
+            uint32_t row_length;
+            uint32_t row_size;
+            // Offset of every tap ky * kernel_w + kx in the packed rows of a channel
+            std::vector<int64_t> taps;
+
+            WindowGeometry(uint32_t in_h_,
+                           uint32_t in_w_,
+                           uint32_t kernel_h_,
+                           uint32_t kernel_w_,
+                           const Window2d& window_,
+                           uint32_t block)
+                : in_h(in_h_), in_w(in_w_), kernel_h(kernel_h_), kernel_w(kernel_w_), window(window_)
+            {
+                assert(window.stride[0] > 0 && window.stride[1] > 0 && window.dilation[0] > 0 &&
+                       window.dilation[1] > 0);
+                out_h = window.outputSize(0, in_h, kernel_h);
+                out_w = window.outputSize(1, in_w, kernel_w);
+                const uint32_t sx = window.stride[1];
+                const uint32_t dx = window.dilation[1];
+                padded_w = (out_w + block - 1) / block * block;
+                row_length = padded_w + (kernel_w - 1) * dx / sx;
+                row_size = row_length * sx;
+                taps.resize(static_cast<size_t>(kernel_h) * kernel_w);
+                for (uint32_t ky = 0; ky < kernel_h; ++ky)
+                {
+                    for (uint32_t kx = 0; kx < kernel_w; ++kx)
+                    {
+                        const uint32_t x = kx * dx;
+                        taps[ky * kernel_w + kx] = static_cast<int64_t>(ky) * row_size + x % sx * row_length + x / sx;
+                    }
+                }
+            }
+
+            // Elements of the packed rows of one channel
+            size_t channelSize() const { return static_cast<size_t>(kernel_h) * row_size; }
+        };
+
+        // Packs the input rows of output row oy of one channel plane into rows, positions in the padding are pad
+        template <class T>
+        void packWindowRows(const WindowGeometry& geometry,
+                            const T* plane,
+                            int64_t row_stride,
+                            int64_t col_stride,
+                            uint32_t oy,
+                            T pad,
+                            T* rows)
+        {
+            const Window2d& window = geometry.window;
+            const int64_t sx = window.stride[1];
+            const int64_t px = window.padding[1];
+            for (uint32_t ky = 0; ky < geometry.kernel_h; ++ky, rows += geometry.row_size)
+            {
+                const int64_t iy = static_cast<int64_t>(oy) * window.stride[0] - window.padding[0] +
+                                   static_cast<int64_t>(ky) * window.dilation[0];
+                if (iy < 0 || iy >= geometry.in_h)
+                {
+                    std::fill(rows, rows + geometry.row_size, pad);
+                    continue;
+                }
+                const T* src = plane + iy * row_stride;
+                for (int64_t phase = 0; phase < sx; ++phase)
+                {
+                    // Element j of the phase is input column j * sx + phase - px
+                    T* dst = rows + phase * geometry.row_length;
+                    const int64_t length = geometry.row_length;
+                    int64_t begin = px > phase ? (px - phase + sx - 1) / sx : 0;
+                    int64_t end = (geometry.in_w + px - phase + sx - 1) / sx;
+                    begin = begin < length ? begin : length;
+                    end = end < begin ? begin : end < length ? end : length;
+                    std::fill(dst, dst + begin, pad);
+                    copyRow(src + (begin * sx + phase - px) * col_stride,
+                            sx * col_stride,
+                            dst + begin,
+                            1,
+                            static_cast<uint32_t>(end - begin));
+                    std::fill(dst + end, dst + length, pad);
+                }
+            }
+        }
+
+        // Computes a tile of OB output channels by NB consecutive outputs of one row into tile, row major with NB
+        // columns. rows holds the packed rows of every input channel channel_stride apart, weights the OB
+        // weights of every channel and tap in that order.
+        template <class T>
+        struct ConvKernel
+        {
+            // Upper bound of ob x nb over the kernels
+            static constexpr const uint32_t MAX_TILE = 12 * 2 * 64 / sizeof(T);
+
+            void (*fn)(const T* rows,
+                       int64_t channel_stride,
+                       uint32_t channels,
+                       const int64_t* taps,
+                       uint32_t tap_count,
+                       const T* weights,
+                       T* tile);
+            uint32_t ob;
+            uint32_t nb;
+        };
+
+        template <class T, uint32_t OB, uint32_t NB>
+        void convScalar(const T* rows,
+                        int64_t channel_stride,
+                        uint32_t channels,
+                        const int64_t* taps,
+                        uint32_t tap_count,
+                        const T* weights,
+                        T* tile)
+        {
+            T acc[OB * NB] = {};
+            for (uint32_t c = 0; c < channels; ++c, rows += channel_stride)
+            {
+                for (uint32_t t = 0; t < tap_count; ++t, weights += OB)
+                {
+                    const T* x = rows + taps[t];
+                    for (uint32_t o = 0; o < OB; ++o)
+                    {
+                        for (uint32_t i = 0; i < NB; ++i)
+                        {
+                            acc[o * NB + i] += weights[o] * x[i];
+                        }
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < OB * NB; ++i)
+            {
+                tile[i] = acc[i];
+            }
+        }
+
+#if MT_SIMD_X86
+// The micro kernel of gemm with the packed rows in place of the B panel: every tap loads two vectors of inputs
+// and broadcasts the OB weights of the tap
+#define MT_CONV_KERNEL(NAME, TARGET, BYTES, FUSED)                                                                     \
+    template <class T, uint32_t OB>                                                                                    \
+    TARGET MT_SIMD_FLATTEN void NAME(const T* rows,                                                                    \
+                                     int64_t channel_stride,                                                           \
+                                     uint32_t channels,                                                                \
+                                     const int64_t* taps,                                                              \
+                                     uint32_t tap_count,                                                               \
+                                     const T* weights,                                                                 \
+                                     T* tile)                                                                          \
+    {                                                                                                                  \
+        typedef typename Vector<T, BYTES>::type V;                                                                     \
+        const uint32_t lanes = BYTES / sizeof(T);                                                                      \
+        V acc[OB][2] = {};                                                                                             \
+        for (uint32_t c = 0; c < channels; ++c, rows += channel_stride)                                                \
+        {                                                                                                              \
+            for (uint32_t t = 0; t < tap_count; ++t, weights += OB)                                                    \
+            {                                                                                                          \
+                V x0;                                                                                                  \
+                V x1;                                                                                                  \
+                load(x0, rows + taps[t]);                                                                              \
+                load(x1, rows + taps[t] + lanes);                                                                      \
+                GemmRows<OB, FUSED, BYTES>::update(acc, weights, x0, x1);                                              \
+            }                                                                                                          \
+        }                                                                                                              \
+        for (uint32_t o = 0; o < OB; ++o)                                                                              \
+        {                                                                                                              \
+            store(tile + o * 2 * lanes, acc[o][0]);                                                                    \
+            store(tile + o * 2 * lanes + lanes, acc[o][1]);                                                            \
+        }                                                                                                              \
+    }
+
+        MT_CONV_KERNEL(convSSE2, MT_SIMD_TARGET_SSE2, 16, false)
+        MT_CONV_KERNEL(convAVX2, MT_SIMD_TARGET_AVX2, 32, true)
+        MT_CONV_KERNEL(convAVX512, MT_SIMD_TARGET_AVX512, 64, true)
+#undef MT_CONV_KERNEL
+#endif
+
+        // Same register budget as selectGemmKernel
+        template <class T>
+        ConvKernel<T> selectConvKernel(SimdIsa isa)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return ConvKernel<T>{&convAVX512<T, 12>, 12, 2 * 64 / sizeof(T)};
+            case SimdIsa::AVX2:
+                return ConvKernel<T>{&convAVX2<T, 6>, 6, 2 * 32 / sizeof(T)};
+            case SimdIsa::SSE2:
+                return ConvKernel<T>{&convSSE2<T, 6>, 6, 2 * 16 / sizeof(T)};
+            default:
+                break;
+            }
+#endif
+            return ConvKernel<T>{&convScalar<T, 4, 4>, 4, 4};
+        }
+
+        // Per channel windows: depthwise convolution and pooling. Accumulators start at initial and apply folds
+        // in the input x of a tap with its weight w, the weights are only read when WEIGHTED.
+        struct DepthwiseWindow
+        {
+            static constexpr const bool WEIGHTED = true;
+
+            template <class T>
+            static T initial()
+            {
+                return T(0);
+            }
+
+            template <bool FUSED, size_t BYTES, class T, class V>
+            static MT_XINLINE void apply(V& acc, const V& x, const V& w)
+            {
+                if (FUSED)
+                {
+                    FusedMultiplyAdd<T, BYTES>::apply(acc, x, w, acc);
+                }
+                else
+                {
+                    acc += x * w;
+                }
+            }
+        };
+
+        struct MaxWindow
+        {
+            static constexpr const bool WEIGHTED = false;
+
+            // Also the padding, which never wins
+            template <class T>
+            static T initial()
+            {
+                return -std::numeric_limits<T>::infinity();
+            }
+
+            template <bool FUSED, size_t BYTES, class T, class V>
+            static MT_XINLINE void apply(V& acc, const V& x, const V&)
+            {
+                ops::SimdMax()(acc, acc, x);
+            }
+        };
+
+        // Sums, the caller divides by the number of taps inside the input
+        struct SumWindow
+        {
+            static constexpr const bool WEIGHTED = false;
+
+            template <class T>
+            static T initial()
+            {
+                return T(0);
+            }
+
+            template <bool FUSED, size_t BYTES, class T, class V>
+            static MT_XINLINE void apply(V& acc, const V& x, const V&)
+            {
+                acc += x;
+            }
+        };
+
+        // Computes n outputs of one row into the dense out, n is a multiple of the block of the kernel
+        template <class T>
+        using WindowKernel =
+            void (*)(const T* rows, const int64_t* taps, uint32_t tap_count, const T* weights, T* out, uint32_t n);
+
+        template <class OP, class T>
+        void windowScalar(const T* rows, const int64_t* taps, uint32_t tap_count, const T* weights, T* out, uint32_t n)
+        {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                T acc = OP::template initial<T>();
+                for (uint32_t t = 0; t < tap_count; ++t)
+                {
+                    const T w = OP::WEIGHTED ? weights[t] : T();
+                    OP::template apply<false, sizeof(T), T>(acc, rows[taps[t] + i], w);
+                }
+                out[i] = acc;
+            }
+        }
+
+#if MT_SIMD_X86
+// UNROLL independent vectors of outputs are in flight for every tap
+#define MT_WINDOW_KERNEL(NAME, TARGET, BYTES, FUSED, UNROLL)                                                           \
+    template <class OP, class T>                                                                                       \
+    TARGET MT_SIMD_FLATTEN void NAME(                                                                                  \
+        const T* rows, const int64_t* taps, uint32_t tap_count, const T* weights, T* out, uint32_t n)                  \
+    {                                                                                                                  \
+        typedef typename Vector<T, BYTES>::type V;                                                                     \
+        const uint32_t lanes = BYTES / sizeof(T);                                                                      \
+        V initial = {};                                                                                                \
+        for (uint32_t l = 0; l < lanes; ++l)                                                                           \
+        {                                                                                                              \
+            initial[l] = OP::template initial<T>();                                                                    \
+        }                                                                                                              \
+        for (uint32_t i = 0; i < n; i += UNROLL * lanes)                                                               \
+        {                                                                                                              \
+            V acc[UNROLL];                                                                                             \
+            for (uint32_t u = 0; u < UNROLL; ++u)                                                                      \
+            {                                                                                                          \
+                acc[u] = initial;                                                                                      \
+            }                                                                                                          \
+            for (uint32_t t = 0; t < tap_count; ++t)                                                                   \
+            {                                                                                                          \
+                V w = {};                                                                                              \
+                for (uint32_t l = 0; l < lanes; ++l)                                                                   \
+                {                                                                                                      \
+                    w[l] = OP::WEIGHTED ? weights[t] : T();                                                            \
+                }                                                                                                      \
+                const T* x = rows + taps[t] + i;                                                                       \
+                for (uint32_t u = 0; u < UNROLL; ++u)                                                                  \
+                {                                                                                                      \
+                    V v;                                                                                               \
+                    load(v, x + u * lanes);                                                                            \
+                    OP::template apply<FUSED, BYTES, T>(acc[u], v, w);                                                 \
+                }                                                                                                      \
+            }                                                                                                          \
+            for (uint32_t u = 0; u < UNROLL; ++u)                                                                      \
+            {                                                                                                          \
+                store(out + i + u * lanes, acc[u]);                                                                    \
+            }                                                                                                          \
+        }                                                                                                              \
+    }
+
+        MT_WINDOW_KERNEL(windowSSE2, MT_SIMD_TARGET_SSE2, 16, false, 4)
+        MT_WINDOW_KERNEL(windowAVX2, MT_SIMD_TARGET_AVX2, 32, true, 4)
+        MT_WINDOW_KERNEL(windowAVX512, MT_SIMD_TARGET_AVX512, 64, true, 4)
+#undef MT_WINDOW_KERNEL
+#endif
+
+        // Kernel and the number of outputs it computes at a time
+        template <class OP, class T>
+        WindowKernel<T> selectWindowKernel(SimdIsa isa, uint32_t& block)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                block = 4 * 64 / sizeof(T);
+                return &windowAVX512<OP, T>;
+            case SimdIsa::AVX2:
+                block = 4 * 32 / sizeof(T);
+                return &windowAVX2<OP, T>;
+            case SimdIsa::SSE2:
+                block = 4 * 16 / sizeof(T);
+                return &windowSSE2<OP, T>;
+            default:
+                break;
+            }
+#endif
+            block = 1;
+            return &windowScalar<OP, T>;
+        }
+
+        // Checks the operands of an NCHW window operation and narrows the sizes to the 32 bits the kernels use
+        template <class A, class T>
+        void checkWindowShapes(const Shape<4>& in,
+                               const Shape<4>& out,
+                               uint32_t kernel_h,
+                               uint32_t kernel_w,
+                               const Window2d& window)
+        {
+            static_assert(std::is_same<typename std::remove_const<A>::type, T>::value,
+                          "Input and output must have the same element type");
+            static_assert(std::is_floating_point<T>::value, "Windows support floating point types");
+            assert(in[2] <= std::numeric_limits<uint32_t>::max() && in[3] <= std::numeric_limits<uint32_t>::max());
+            assert(kernel_h > 0 && kernel_w > 0);
+            // Before outputSize, which divides by the stride
+            assert(window.stride[0] > 0 && window.stride[1] > 0 && window.dilation[0] > 0 &&
+                   window.dilation[1] > 0);
+            assert(out[0] == in[0]);
+            assert(out[2] == window.outputSize(0, static_cast<uint32_t>(in[2]), kernel_h));
+            assert(out[3] == window.outputSize(1, static_cast<uint32_t>(in[3]), kernel_w));
+            (void)in;
+            (void)out;
+            (void)kernel_h;
+            (void)kernel_w;
+            (void)window;
+        }
+
+        // Runs OP over every channel plane of in. weights holds the taps of every channel kernel_h * kernel_w
+        // apart, or is null. Average pooling passes average to divide every output by the taps inside the input.
+        template <class OP, class T>
+        void window2d(const T* in,
+                      const Shape<4>& in_shape,
+                      const T* weights,
+                      T* out,
+                      const Shape<4>& out_shape,
+                      uint32_t kernel_h,
+                      uint32_t kernel_w,
+                      const Window2d& window,
+                      T pad,
+                      bool average,
+                      ThreadPool* pool,
+                      uint64_t grain)
+        {
+            uint32_t block;
+            const WindowKernel<T> kernel = selectWindowKernel<OP, T>(getSimdIsa(), block);
+            const WindowGeometry geometry(static_cast<uint32_t>(in_shape[2]),
+                                          static_cast<uint32_t>(in_shape[3]),
+                                          kernel_h,
+                                          kernel_w,
+                                          window,
+                                          block);
+            const uint32_t channels = static_cast<uint32_t>(in_shape[1]);
+            const uint64_t rows = static_cast<uint64_t>(in_shape[0]) * channels * geometry.out_h;
+            if (rows == 0 || geometry.out_w == 0)
+            {
+                return;
+            }
+            const uint32_t taps = kernel_h * kernel_w;
+            // Taps inside the input of every output column
+            std::vector<T> inside_x(average ? geometry.out_w : 0);
+            for (uint32_t ox = 0; ox < inside_x.size(); ++ox)
+            {
+                uint32_t count = 0;
+                for (uint32_t kx = 0; kx < kernel_w; ++kx)
+                {
+                    const int64_t x = static_cast<int64_t>(ox) * window.stride[1] - window.padding[1] +
+                                      static_cast<int64_t>(kx) * window.dilation[1];
+                    count += x >= 0 && x < geometry.in_w;
+                }
+                inside_x[ox] = static_cast<T>(count);
+            }
+            auto run = [&](uint64_t begin, uint64_t end) {
+                TensorBuffer<T, 1> packed(Shape<1>(static_cast<DimSize_t>(geometry.channelSize())));
+                TensorBuffer<T, 1> result(Shape<1>(geometry.padded_w));
+                for (uint64_t item = begin; item < end; ++item)
+                {
+                    const uint32_t oy = static_cast<uint32_t>(item % geometry.out_h);
+                    const uint32_t c = static_cast<uint32_t>(item / geometry.out_h % channels);
+                    const DimSize_t n = static_cast<DimSize_t>(item / geometry.out_h / channels);
+                    const T* plane = in + in_shape.index(n, c, 0, 0);
+                    packWindowRows(geometry,
+                                   plane,
+                                   static_cast<Stride_t>(in_shape.getStride(2)),
+                                   static_cast<Stride_t>(in_shape.getStride(3)),
+                                   oy,
+                                   pad,
+                                   packed.data());
+                    kernel(packed.data(),
+                           geometry.taps.data(),
+                           taps,
+                           weights == nullptr ? nullptr : weights + static_cast<size_t>(c) * taps,
+                           result.data(),
+                           geometry.padded_w);
+                    T* dst = out + out_shape.index(n, c, oy, 0);
+                    const int64_t step = static_cast<Stride_t>(out_shape.getStride(3));
+                    if (!average)
+                    {
+                        copyRow<T>(result.data(), 1, dst, step, geometry.out_w);
+                        continue;
+                    }
+                    uint32_t inside_y = 0;
+                    for (uint32_t ky = 0; ky < kernel_h; ++ky)
+                    {
+                        const int64_t y = static_cast<int64_t>(oy) * window.stride[0] - window.padding[0] +
+                                          static_cast<int64_t>(ky) * window.dilation[0];
+                        inside_y += y >= 0 && y < geometry.in_h;
+                    }
+                    for (uint32_t ox = 0; ox < geometry.out_w; ++ox)
+                    {
+                        const T count = static_cast<T>(inside_y) * inside_x[ox];
+                        dst[ox * step] = count == 0 ? T(0) : result.data()[ox] / count;
+                    }
+                }
+            };
+            if (pool == nullptr)
+            {
+                run(0, rows);
+                return;
+            }
+            pool->parallelFor(0, rows, grain / (static_cast<uint64_t>(taps) * geometry.out_w), run);
+        }
+
+        // A CHW tensor as a batch of one
+        template <class T>
+        Tensor<T, 4> asBatch(Tensor<T, 3> chw)
+        {
+            const Shape<3> shape = chw.getShape();
+            Shape<4> batch(1, shape[0], shape[1], shape[2]);
+            for (uint8_t d = 0; d < 3; ++d)
+            {
+                batch.setStride(d + 1, static_cast<Stride_t>(shape.getStride(d)));
+            }
+            return Tensor<T, 4>(chw.data(), batch);
+        }
+    } // namespace detail
+
+    // out[n, o, y, x] = sum over c, ky and kx of weights[o, c, ky, kx] * in[n, c, y * sy - py + ky * dy,
+    // x * sx - px + kx * dx], inputs outside the image being zero. in is NCHW, weights OIHW and out NOHW with the
+    // sizes given by Window2d::outputSize. Outputs are computed in tiles of output channels by output columns
+    // held in registers, every packed input row is reused by all output channels of a tile. Like matmul the
+    // last bits can differ between instruction sets.
+    template <class A, class B, class T>
+    void conv2d(const Tensor<A, 4>& in,
+                const Tensor<B, 4>& weights,
+                Tensor<T, 4> out,
+                const Window2d& window = Window2d(),
+                ThreadPool* pool = nullptr,
+                uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(std::is_same<typename std::remove_const<B>::type, T>::value,
+                      "Weights and output must have the same element type");
+        const Shape<4> in_shape = in.getShape();
+        const Shape<4> w_shape = weights.getShape();
+        const Shape<4> out_shape = out.getShape();
+        const uint32_t kernel_h = static_cast<uint32_t>(w_shape[2]);
+        const uint32_t kernel_w = static_cast<uint32_t>(w_shape[3]);
+        detail::checkWindowShapes<A, T>(in_shape, out_shape, kernel_h, kernel_w, window);
+        assert(w_shape[1] == in_shape[1] && out_shape[1] == w_shape[0]);
+        const detail::ConvKernel<T> kernel = detail::selectConvKernel<T>(getSimdIsa());
+        const detail::WindowGeometry geometry(static_cast<uint32_t>(in_shape[2]),
+                                              static_cast<uint32_t>(in_shape[3]),
+                                              kernel_h,
+                                              kernel_w,
+                                              window,
+                                              kernel.nb);
+        const uint32_t channels = static_cast<uint32_t>(in_shape[1]);
+        const uint32_t outputs = static_cast<uint32_t>(w_shape[0]);
+        const uint32_t taps = kernel_h * kernel_w;
+        const uint64_t rows = static_cast<uint64_t>(in_shape[0]) * geometry.out_h;
+        if (rows == 0 || geometry.out_w == 0 || outputs == 0)
+        {
+            return;
+        }
+        // Weights in blocks of ob output channels, the ob values of a channel and tap together. Output channels
+        // past the end are zero.
+        const uint32_t blocks = (outputs + kernel.ob - 1) / kernel.ob;
+        const size_t block_size = static_cast<size_t>(kernel.ob) * channels * taps;
+        TensorBuffer<T, 1> packed_weights(Shape<1>(static_cast<DimSize_t>(blocks * block_size)));
+        T* pw = packed_weights.data();
+        for (uint32_t b = 0; b < blocks; ++b)
+        {
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                for (uint32_t t = 0; t < taps; ++t)
+                {
+                    for (uint32_t i = 0; i < kernel.ob; ++i, ++pw)
+                    {
+                        const uint32_t o = b * kernel.ob + i;
+                        *pw = o < outputs ? weights.data()[w_shape.index(o, c, t / kernel_w, t % kernel_w)] : T(0);
+                    }
+                }
+            }
+        }
+        const size_t channel_size = geometry.channelSize();
+        auto run = [&](uint64_t begin, uint64_t end) {
+            TensorBuffer<T, 1> packed(Shape<1>(static_cast<DimSize_t>(channel_size * channels)));
+            T tile[detail::ConvKernel<T>::MAX_TILE];
+            for (uint64_t item = begin; item < end; ++item)
+            {
+                const uint32_t oy = static_cast<uint32_t>(item % geometry.out_h);
+                const DimSize_t n = static_cast<DimSize_t>(item / geometry.out_h);
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    detail::packWindowRows(geometry,
+                                           in.data() + in_shape.index(n, c, 0, 0),
+                                           static_cast<Stride_t>(in_shape.getStride(2)),
+                                           static_cast<Stride_t>(in_shape.getStride(3)),
+                                           oy,
+                                           T(0),
+                                           packed.data() + c * channel_size);
+                }
+                for (uint32_t b = 0; b < blocks; ++b)
+                {
+                    const T* block_weights = packed_weights.data() + b * block_size;
+                    const uint32_t count = outputs - b * kernel.ob < kernel.ob ? outputs - b * kernel.ob : kernel.ob;
+                    for (uint32_t x = 0; x < geometry.out_w; x += kernel.nb)
+                    {
+                        kernel.fn(packed.data() + x,
+                                  static_cast<int64_t>(channel_size),
+                                  channels,
+                                  geometry.taps.data(),
+                                  taps,
+                                  block_weights,
+                                  tile);
+                        const uint32_t cols = geometry.out_w - x < kernel.nb ? geometry.out_w - x : kernel.nb;
+                        const int64_t step = static_cast<Stride_t>(out_shape.getStride(3));
+                        for (uint32_t i = 0; i < count; ++i)
+                        {
+                            detail::copyRow<T>(tile + i * kernel.nb,
+                                       1,
+                                       out.data() + out_shape.index(n, b * kernel.ob + i, oy, x),
+                                       step,
+                                       cols);
+                        }
+                    }
+                }
+            }
+        };
+        if (pool == nullptr)
+        {
+            run(0, rows);
+            return;
+        }
+        const uint64_t work = static_cast<uint64_t>(outputs) * channels * taps * geometry.out_w;
+        pool->parallelFor(0, rows, grain / work, run);
+    }
+
+    // conv2d with a separate kernel per channel, out[n, c] only reads in[n, c]. weights is CHW with one
+    // kernel_h x kernel_w kernel per channel, like a blur or Sobel filter applied to every channel.
+    template <class A, class B, class T>
+    void depthwiseConv2d(const Tensor<A, 4>& in,
+                         const Tensor<B, 3>& weights,
+                         Tensor<T, 4> out,
+                         const Window2d& window = Window2d(),
+                         ThreadPool* pool = nullptr,
+                         uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(std::is_same<typename std::remove_const<B>::type, T>::value,
+                      "Weights and output must have the same element type");
+        const Shape<4> in_shape = in.getShape();
+        const Shape<3> w_shape = weights.getShape();
+        const uint32_t kernel_h = static_cast<uint32_t>(w_shape[1]);
+        const uint32_t kernel_w = static_cast<uint32_t>(w_shape[2]);
+        detail::checkWindowShapes<A, T>(in_shape, out.getShape(), kernel_h, kernel_w, window);
+        assert(w_shape[0] == in_shape[1] && out.getShape()[1] == in_shape[1]);
+        // The taps of every channel together
+        TensorBuffer<T, 3> dense(Shape<3>(w_shape[0], w_shape[1], w_shape[2]));
+        weights.copyTo(dense.view());
+        detail::window2d<detail::DepthwiseWindow, T>(in.data(),
+                                                     in_shape,
+                                                     dense.data(),
+                                                     out.data(),
+                                                     out.getShape(),
+                                                     kernel_h,
+                                                     kernel_w,
+                                                     window,
+                                                     T(0),
+                                                     false,
+                                                     pool,
+                                                     grain);
+    }
+
+    // Maximum of every kernel_h x kernel_w window, padding never wins. Pass Window2d(k) for the common k x k
+    // pooling with a stride of k.
+    template <class A, class T>
+    void maxPool2d(const Tensor<A, 4>& in,
+                   uint32_t kernel_h,
+                   uint32_t kernel_w,
+                   Tensor<T, 4> out,
+                   const Window2d& window = Window2d(),
+                   ThreadPool* pool = nullptr,
+                   uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        detail::checkWindowShapes<A, T>(in.getShape(), out.getShape(), kernel_h, kernel_w, window);
+        assert(out.getShape()[1] == in.getShape()[1]);
+        detail::window2d<detail::MaxWindow, T>(in.data(),
+                                               in.getShape(),
+                                               nullptr,
+                                               out.data(),
+                                               out.getShape(),
+                                               kernel_h,
+                                               kernel_w,
+                                               window,
+                                               detail::MaxWindow::initial<T>(),
+                                               false,
+                                               pool,
+                                               grain);
+    }
+
+    // Mean of every kernel_h x kernel_w window over the positions inside the input, padding is not counted
+    template <class A, class T>
+    void avgPool2d(const Tensor<A, 4>& in,
+                   uint32_t kernel_h,
+                   uint32_t kernel_w,
+                   Tensor<T, 4> out,
+                   const Window2d& window = Window2d(),
+                   ThreadPool* pool = nullptr,
+                   uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        detail::checkWindowShapes<A, T>(in.getShape(), out.getShape(), kernel_h, kernel_w, window);
+        assert(out.getShape()[1] == in.getShape()[1]);
+        detail::window2d<detail::SumWindow, T>(in.data(),
+                                               in.getShape(),
+                                               nullptr,
+                                               out.data(),
+                                               out.getShape(),
+                                               kernel_h,
+                                               kernel_w,
+                                               window,
+                                               T(0),
+                                               true,
+                                               pool,
+                                               grain);
+    }
+
+    // CHW images
+    template <class A, class B, class T>
+    void conv2d(const Tensor<A, 3>& in,
+                const Tensor<B, 4>& weights,
+                Tensor<T, 3> out,
+                const Window2d& window = Window2d(),
+                ThreadPool* pool = nullptr,
+                uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        conv2d(detail::asBatch(in), weights, detail::asBatch(out), window, pool, grain);
+    }
+
+    template <class A, class B, class T>
+    void depthwiseConv2d(const Tensor<A, 3>& in,
+                         const Tensor<B, 3>& weights,
+                         Tensor<T, 3> out,
+                         const Window2d& window = Window2d(),
+                         ThreadPool* pool = nullptr,
+                         uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        depthwiseConv2d(detail::asBatch(in), weights, detail::asBatch(out), window, pool, grain);
+    }
+
+    template <class A, class T>
+    void maxPool2d(const Tensor<A, 3>& in,
+                   uint32_t kernel_h,
+                   uint32_t kernel_w,
+                   Tensor<T, 3> out,
+                   const Window2d& window = Window2d(),
+                   ThreadPool* pool = nullptr,
+                   uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        maxPool2d(detail::asBatch(in), kernel_h, kernel_w, detail::asBatch(out), window, pool, grain);
+    }
+
+    template <class A, class T>
+    void avgPool2d(const Tensor<A, 3>& in,
+                   uint32_t kernel_h,
+                   uint32_t kernel_w,
+                   Tensor<T, 3> out,
+                   const Window2d& window = Window2d(),
+                   ThreadPool* pool = nullptr,
+                   uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        avgPool2d(detail::asBatch(in), kernel_h, kernel_w, detail::asBatch(out), window, pool, grain);
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_CONV_HPP
@@ -0,0 +1,554 @@
+#ifndef MINITENSOR_CONVERT_HPP
+#define MINITENSOR_CONVERT_HPP
+#include "Half.hpp"
+#include "LoopNest.hpp"
+#include "Simd.hpp"
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+#include <assert.h>
+#include <limits>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    namespace detail
+    {
+        // Conversions between arithmetic types of at most 32 bits, float16, bfloat16, float and double are
+        // computed in Work_t and saturate to the range of the destination, NaN becomes 0. Work_t is float when
+        // it represents every value of both types and double otherwise. Bool and 64 bit integers are converted
+        // with a plain static_cast.
+        template <class S, class T>
+        struct ConvertTraits
+        {
+            template <class U>
+            struct Saturable
+            {
+                static constexpr const bool value =
+                    IsHalf<U>::value || (std::is_arithmetic<U>::value && !std::is_same<U, bool>::value &&
+                                         (std::is_floating_point<U>::value || sizeof(U) <= 4));
+            };
+
+            template <class U>
+            struct Wide
+            {
+                static constexpr const bool value =
+                    std::is_same<U, double>::value || (std::is_integral<U>::value && sizeof(U) >= 4);
+            };
+
+            static constexpr const bool SATURATE = Saturable<S>::value && Saturable<T>::value;
+            // The 16 bit float types have no vector arithmetic
+            static constexpr const bool VECTOR =
+                SATURATE && std::is_arithmetic<S>::value && std::is_arithmetic<T>::value;
+            typedef typename std::conditional<Wide<S>::value || Wide<T>::value, double, float>::type Work_t;
+            // Integer lanes are widened or narrowed to Index_t on their way to and from Work_t, the instruction
+            // sets only convert between 32 bit integers and floating point directly
+            typedef typename std::conditional<std::is_same<S, uint32_t>::value || std::is_same<T, uint32_t>::value,
+                                              int64_t,
+                                              int32_t>::type Index_t;
+        };
+
+        template <class T, class W, bool = std::is_integral<T>::value>
+        struct Saturate
+        {
+            template <class V>
+            static MT_XINLINE void apply(V& x)
+            {
+                const V lo = V() + static_cast<W>(std::numeric_limits<T>::lowest());
+                const V hi = V() + static_cast<W>(std::numeric_limits<T>::max());
+                x = x == x ? x : V();
+                x = x < lo ? lo : x;
+                x = hi < x ? hi : x;
+            }
+        };
+
+        template <class T, class W>
+        struct Saturate<T, W, false>
+        {
+            template <class V>
+            static MT_XINLINE void apply(V&)
+            {
+            }
+        };
+
+        // out = saturate(in * scale + offset) on scalars and vectors of Work_t, the multiply and add are
+        // skipped when not SCALED so plain conversions are exact
+        template <class S, class T, bool SCALED>
+        struct ConvertOp
+        {
+            typedef typename ConvertTraits<S, T>::Work_t Work_t;
+            static constexpr const bool SATURATE = ConvertTraits<S, T>::SATURATE;
+
+            Work_t scale = 1;
+            Work_t offset = 0;
+
+            template <class V>
+            MT_XINLINE void apply(V& x) const
+            {
+                if (SCALED)
+                {
+                    x = x * scale + offset;
+                }
+                if (SATURATE)
+                {
+                    Saturate<T, Work_t>::apply(x);
+                }
+            }
+
+            MT_XINLINE T operator()(S in) const
+            {
+                if (!SATURATE && !SCALED)
+                {
+                    return static_cast<T>(in);
+                }
+                Work_t x = static_cast<Work_t>(in);
+                apply(x);
+                return static_cast<T>(x);
+            }
+        };
+
+        // Converts one dense row
+        template <class S, class T, bool SCALED>
+        using ConvertKernel = void (*)(const ConvertOp<S, T, SCALED>& op, const S* in, T* out, uint32_t n);
+
+        template <class S, class T, bool SCALED>
+        MT_SIMD_NO_CONTRACT void convertScalar(const ConvertOp<S, T, SCALED>& op, const S* in, T* out, uint32_t n)
+        {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                out[i] = op(in[i]);
+            }
+        }
+
+#if MT_SIMD_X86
+        template <size_t SIZE, bool SIGNED>
+        struct IntegerOf;
+
+        template <>
+        struct IntegerOf<1, true>
+        {
+            typedef int8_t type;
+        };
+
+        template <>
+        struct IntegerOf<1, false>
+        {
+            typedef uint8_t type;
+        };
+
+        template <>
+        struct IntegerOf<2, true>
+        {
+            typedef int16_t type;
+        };
+
+        template <>
+        struct IntegerOf<2, false>
+        {
+            typedef uint16_t type;
+        };
+
+        template <>
+        struct IntegerOf<4, true>
+        {
+            typedef int32_t type;
+        };
+
+        template <>
+        struct IntegerOf<4, false>
+        {
+            typedef uint32_t type;
+        };
+
+        template <>
+        struct IntegerOf<8, true>
+        {
+            typedef int64_t type;
+        };
+
+        template <>
+        struct IntegerOf<8, false>
+        {
+            typedef uint64_t type;
+        };
+
+        // Converts LANES integer lanes from FROM to TO. GCC only emits vector code for conversions that at most
+        // double or halve the lane width, wider changes are done in such steps. Narrowing assumes the values
+        // fit in TO.
+        template <class TO,
+                  class FROM,
+                  uint32_t LANES,
+                  bool WIDEN = (sizeof(TO) > 2 * sizeof(FROM)),
+                  bool NARROW = (2 * sizeof(TO) < sizeof(FROM))>
+        struct ResizeLanes
+        {
+            typedef typename Vector<TO, LANES * sizeof(TO)>::type VTO;
+            typedef typename Vector<FROM, LANES * sizeof(FROM)>::type VFROM;
+
+            static MT_XINLINE void apply(VTO& out, const VFROM& in) { out = __builtin_convertvector(in, VTO); }
+        };
+
+        template <class TO, class FROM, uint32_t LANES>
+        struct ResizeLanes<TO, FROM, LANES, true, false>
+        {
+            typedef typename IntegerOf<2 * sizeof(FROM), std::is_signed<FROM>::value>::type Mid_t;
+            typedef typename Vector<Mid_t, LANES * sizeof(Mid_t)>::type VMID;
+
+            static MT_XINLINE void apply(typename Vector<TO, LANES * sizeof(TO)>::type& out,
+                                         const typename Vector<FROM, LANES * sizeof(FROM)>::type& in)
+            {
+                const VMID mid = __builtin_convertvector(in, VMID);
+                ResizeLanes<TO, Mid_t, LANES>::apply(out, mid);
+            }
+        };
+
+        template <class TO, class FROM, uint32_t LANES>
+        struct ResizeLanes<TO, FROM, LANES, false, true>
+        {
+            typedef typename IntegerOf<sizeof(FROM) / 2, std::is_signed<TO>::value>::type Mid_t;
+            typedef typename Vector<Mid_t, LANES * sizeof(Mid_t)>::type VMID;
+
+            static MT_XINLINE void apply(typename Vector<TO, LANES * sizeof(TO)>::type& out,
+                                         const typename Vector<FROM, LANES * sizeof(FROM)>::type& in)
+            {
+                const VMID mid = __builtin_convertvector(in, VMID);
+                ResizeLanes<TO, Mid_t, LANES>::apply(out, mid);
+            }
+        };
+
+        // Lanes of an integer type S are resized to Index_t before they become Work_t, and Work_t goes through
+        // Index_t on its way to an integer type T
+        template <class S, class T, uint32_t LANES, bool = std::is_integral<S>::value>
+        struct LoadLanes
+        {
+            template <class VW, class VS>
+            static MT_XINLINE void apply(VW& out, const VS& in)
+            {
+                typedef typename ConvertTraits<S, T>::Index_t I;
+                typename Vector<I, LANES * sizeof(I)>::type index;
+                ResizeLanes<I, S, LANES>::apply(index, in);
+                out = __builtin_convertvector(index, VW);
+            }
+        };
+
+        template <class S, class T, uint32_t LANES>
+        struct LoadLanes<S, T, LANES, false>
+        {
+            template <class VW, class VS>
+            static MT_XINLINE void apply(VW& out, const VS& in)
+            {
+                out = __builtin_convertvector(in, VW);
+            }
+        };
+
+        template <class S, class T, uint32_t LANES, bool = std::is_integral<T>::value>
+        struct StoreLanes
+        {
+            template <class VT, class VW>
+            static MT_XINLINE void apply(VT& out, const VW& in)
+            {
+                typedef typename ConvertTraits<S, T>::Index_t I;
+                typedef typename Vector<I, LANES * sizeof(I)>::type VI;
+                const VI index = __builtin_convertvector(in, VI);
+                ResizeLanes<T, I, LANES>::apply(out, index);
+            }
+        };
+
+        template <class S, class T, uint32_t LANES>
+        struct StoreLanes<S, T, LANES, false>
+        {
+            template <class VT, class VW>
+            static MT_XINLINE void apply(VT& out, const VW& in)
+            {
+                out = __builtin_convertvector(in, VT);
+            }
+        };
+
+// Every lane is converted to Work_t for the arithmetic, a vector holds BYTES worth of Work_t
+#define MT_CONVERT_KERNEL(NAME, TARGET, BYTES)                                                                         \
+    template <class S, class T, bool SCALED>                                                                           \
+    TARGET MT_SIMD_FLATTEN MT_SIMD_NO_CONTRACT void NAME(                                                              \
+        const ConvertOp<S, T, SCALED>& op, const S* in, T* out, uint32_t n)                                            \
+    {                                                                                                                  \
+        typedef typename ConvertOp<S, T, SCALED>::Work_t W;                                                            \
+        const uint32_t lanes = BYTES / sizeof(W);                                                                      \
+        typedef typename Vector<S, lanes * sizeof(S)>::type VS;                                                        \
+        typedef typename Vector<W, lanes * sizeof(W)>::type VW;                                                        \
+        typedef typename Vector<T, lanes * sizeof(T)>::type VT;                                                        \
+        uint32_t i = 0;                                                                                                \
+        for (; i + lanes <= n; i += lanes)                                                                             \
+        {                                                                                                              \
+            VS x;                                                                                                      \
+            load(x, in + i);                                                                                           \
+            VW work;                                                                                                   \
+            LoadLanes<S, T, lanes>::apply(work, x);                                                                    \
+            op.apply(work);                                                                                            \
+            VT result;                                                                                                 \
+            StoreLanes<S, T, lanes>::apply(result, work);                                                              \
+            store(out + i, result);                                                                                    \
+        }                                                                                                              \
+        convertScalar(op, in + i, out + i, n - i);                                                                     \
+    }
+
+        MT_CONVERT_KERNEL(convertSSE2, MT_SIMD_TARGET_SSE2, 16)
+        MT_CONVERT_KERNEL(convertAVX2, MT_SIMD_TARGET_AVX2, 32)
+        MT_CONVERT_KERNEL(convertAVX512, MT_SIMD_TARGET_AVX512, 64)
+#undef MT_CONVERT_KERNEL
+#endif
+
+        // Conversions without saturation have no vector kernel
+        template <class S, class T, bool SCALED, bool = ConvertTraits<S, T>::VECTOR>
+        struct ConvertKernelSelector
+        {
+            static ConvertKernel<S, T, SCALED> select(SimdIsa isa)
+            {
+#if MT_SIMD_X86
+                switch (isa)
+                {
+                case SimdIsa::AVX512:
+                    return &convertAVX512<S, T, SCALED>;
+                case SimdIsa::AVX2:
+                    return &convertAVX2<S, T, SCALED>;
+                case SimdIsa::SSE2:
+                    return &convertSSE2<S, T, SCALED>;
+                default:
+                    break;
+                }
+#endif
+                return &convertScalar<S, T, SCALED>;
+            }
+        };
+
+        template <class S, class T, bool SCALED>
+        struct ConvertKernelSelector<S, T, SCALED, false>
+        {
+            static ConvertKernel<S, T, SCALED> select(SimdIsa) { return &convertScalar<S, T, SCALED>; }
+        };
+
+        // Plain conversions between float and the 16 bit float types use the bulk conversions of Half.hpp
+        template <class S,
+                  class T,
+                  bool SCALED,
+                  bool = !SCALED && ((IsHalf<S>::value && std::is_same<T, float>::value) ||
+                                     (std::is_same<S, float>::value && IsHalf<T>::value))>
+        struct BulkConvertSelector
+        {
+            static BulkConvert<S, T> select(SimdIsa) { return nullptr; }
+        };
+
+        template <class S, class T, bool SCALED>
+        struct BulkConvertSelector<S, T, SCALED, true>
+        {
+            static BulkConvert<S, T> select(SimdIsa isa)
+            {
+                return selectBulkConvert(isa, static_cast<const S*>(nullptr), static_cast<const T*>(nullptr));
+            }
+        };
+
+        // Moves n elements between a strided and a dense buffer
+        template <class T>
+        using StridedCopyKernel = void (*)(const T* in, int64_t in_step, T* out, int64_t out_step, uint32_t n);
+
+        template <class T>
+        void stridedCopyScalar(const T* in, int64_t in_step, T* out, int64_t out_step, uint32_t n)
+        {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                out[i * out_step] = in[i * in_step];
+            }
+        }
+
+#if MT_SIMD_X86
+// Constant steps are vectorized with shuffles
+#define MT_STRIDED_COPY_KERNEL(NAME, TARGET)                                                                           \
+    template <class T, uint32_t IN_STEP, uint32_t OUT_STEP>                                                            \
+    TARGET MT_SIMD_VECTORIZE void NAME(const T* __restrict in, int64_t, T* __restrict out, int64_t, uint32_t n)        \
+    {                                                                                                                  \
+        for (size_t i = 0; i < n; ++i)                                                                                 \
+        {                                                                                                              \
+            out[i * OUT_STEP] = in[i * IN_STEP];                                                                       \
+        }                                                                                                              \
+    }
+
+        MT_STRIDED_COPY_KERNEL(stridedCopySSE2, MT_SIMD_TARGET_SSE2)
+        MT_STRIDED_COPY_KERNEL(stridedCopyAVX2, MT_SIMD_TARGET_AVX2)
+        MT_STRIDED_COPY_KERNEL(stridedCopyAVX512, MT_SIMD_TARGET_AVX512)
+#undef MT_STRIDED_COPY_KERNEL
+
+        template <class T, uint32_t IN_STEP, uint32_t OUT_STEP>
+        StridedCopyKernel<T> selectStridedCopy(SimdIsa isa)
+        {
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return &stridedCopyAVX512<T, IN_STEP, OUT_STEP>;
+            case SimdIsa::AVX2:
+                return &stridedCopyAVX2<T, IN_STEP, OUT_STEP>;
+            case SimdIsa::SSE2:
+                return &stridedCopySSE2<T, IN_STEP, OUT_STEP>;
+            default:
+                return &stridedCopyScalar<T>;
+            }
+        }
+#endif
+
+        // Kernel for one of in_step and out_step being 1, the interleaved channels of an image have steps of 2
+        // to 4
+        template <class T>
+        StridedCopyKernel<T> selectStridedCopy(SimdIsa isa, int64_t in_step, int64_t out_step)
+        {
+#if MT_SIMD_X86
+            const int64_t step = in_step == 1 ? out_step : in_step;
+            const bool gather = in_step != 1;
+            switch (step)
+            {
+            case 2:
+                return gather ? selectStridedCopy<T, 2, 1>(isa) : selectStridedCopy<T, 1, 2>(isa);
+            case 3:
+                return gather ? selectStridedCopy<T, 3, 1>(isa) : selectStridedCopy<T, 1, 3>(isa);
+            case 4:
+                return gather ? selectStridedCopy<T, 4, 1>(isa) : selectStridedCopy<T, 1, 4>(isa);
+            default:
+                break;
+            }
+#endif
+            return &stridedCopyScalar<T>;
+        }
+
+        // Elements of strided rows go through a buffer of this many elements so the dense kernel does the
+        // arithmetic. Permuted views, such as an interleaved HWC image read as CHW, take this path.
+        static constexpr const uint32_t CONVERT_CHUNK = 256;
+
+        template <class S, class T, bool SCALED, uint8_t D>
+        void convert(const ConvertOp<S, T, SCALED>& op,
+                     const S* src,
+                     const Shape<D>& src_shape,
+                     T* dst,
+                     const Shape<D>& dst_shape,
+                     ThreadPool* pool,
+                     uint64_t grain)
+        {
+            assert(src_shape == dst_shape);
+            const LoopNest<D, 2> loop(dst_shape, src_shape);
+            const int64_t dst_step = loop.innerStride(0);
+            const int64_t src_step = loop.innerStride(1);
+            const SimdIsa isa = getSimdIsa();
+            const ConvertKernel<S, T, SCALED> kernel = ConvertKernelSelector<S, T, SCALED>::select(isa);
+            const BulkConvert<S, T> bulk = BulkConvertSelector<S, T, SCALED>::select(isa);
+            const StridedCopyKernel<S> gather = selectStridedCopy<S>(isa, src_step, 1);
+            const StridedCopyKernel<T> scatter = selectStridedCopy<T>(isa, 1, dst_step);
+            auto dense = [&op, kernel, bulk](const S* in, T* out, uint32_t n) {
+                if (bulk != nullptr)
+                {
+                    bulk(in, out, n);
+                    return;
+                }
+                kernel(op, in, out, n);
+            };
+            auto row = [&](const int64_t* offsets, uint32_t n) {
+                T* out = dst + offsets[0];
+                const S* in = src + offsets[1];
+                if (dst_step == 1 && src_step == 1)
+                {
+                    dense(in, out, n);
+                    return;
+                }
+                S in_chunk[CONVERT_CHUNK];
+                T out_chunk[CONVERT_CHUNK];
+                for (uint32_t begin = 0; begin < n; begin += CONVERT_CHUNK)
+                {
+                    const uint32_t count = n - begin < CONVERT_CHUNK ? n - begin : CONVERT_CHUNK;
+                    const S* chunk_in = in + begin * src_step;
+                    if (src_step != 1)
+                    {
+                        gather(chunk_in, src_step, in_chunk, 1, count);
+                        chunk_in = in_chunk;
+                    }
+                    T* chunk_out = dst_step == 1 ? out + begin : out_chunk;
+                    dense(chunk_in, chunk_out, count);
+                    if (dst_step != 1)
+                    {
+                        scatter(out_chunk, 1, out + begin * dst_step, dst_step, count);
+                    }
+                }
+            };
+            if (pool == nullptr)
+            {
+                loop.forEachRow(row);
+                return;
+            }
+            pool->parallelFor(0, loop.numElements(), grain, [&loop, &row](uint64_t begin, uint64_t end) {
+                loop.forEachRow(begin, end, row);
+            });
+        }
+    } // namespace detail
+
+    // dst = src converted to the element type of dst, for two views of the same shape. Values outside the range
+    // of an integer destination saturate and NaN becomes 0, see detail::ConvertTraits for the types this
+    // applies to. Optionally split across pool like copyStrided.
+    template <class T, class A, uint8_t D>
+    void convert(const Tensor<A, D>& src,
+                 Tensor<T, D> dst,
+                 ThreadPool* pool = nullptr,
+                 uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        typedef typename std::remove_const<A>::type S;
+        detail::ConvertOp<S, T, false> op;
+        detail::convert(op, src.data(), src.getShape(), dst.data(), dst.getShape(), pool, grain);
+    }
+
+    // dst = saturate(src * scale + offset), computed in the work type of the conversion
+    template <class T, class A, uint8_t D>
+    void convert(const Tensor<A, D>& src,
+                 Tensor<T, D> dst,
+                 double scale,
+                 double offset,
+                 ThreadPool* pool = nullptr,
+                 uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        typedef typename std::remove_const<A>::type S;
+        detail::ConvertOp<S, T, true> op;
+        op.scale = static_cast<typename detail::ConvertOp<S, T, true>::Work_t>(scale);
+        op.offset = static_cast<typename detail::ConvertOp<S, T, true>::Work_t>(offset);
+        detail::convert(op, src.data(), src.getShape(), dst.data(), dst.getShape(), pool, grain);
+    }
+
+    // Per channel version, index c along axis uses scale[c] and offset[c]. Normalizing an interleaved HWC
+    // image into a planar CHW one is convert(permute(hwc, {2, 0, 1}), chw, scale, offset, 0).
+    template <class T, class A, class U, uint8_t D>
+    void convert(const Tensor<A, D>& src,
+                 Tensor<T, D> dst,
+                 const Tensor<U, 1>& scale,
+                 const Tensor<U, 1>& offset,
+                 uint8_t axis,
+                 ThreadPool* pool = nullptr,
+                 uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(D > 1, "Every channel converts a slice of at least one dimension");
+        typedef typename std::remove_const<A>::type S;
+        typedef typename detail::ConvertOp<S, T, true>::Work_t W;
+        const Shape<D> src_shape = src.getShape();
+        const Shape<D> dst_shape = dst.getShape();
+        assert(src_shape == dst_shape);
+        assert(scale.getShape()[0] == dst_shape[axis] && offset.getShape()[0] == dst_shape[axis]);
+        const Shape<D - 1> src_slice = squeezeDim(axis, src_shape);
+        const Shape<D - 1> dst_slice = squeezeDim(axis, dst_shape);
+        const int64_t src_stride = static_cast<Stride_t>(src_shape.getStride(axis));
+        const int64_t dst_stride = static_cast<Stride_t>(dst_shape.getStride(axis));
+        for (DimSize_t c = 0; c < dst_shape[axis]; ++c)
+        {
+            detail::ConvertOp<S, T, true> op;
+            op.scale = static_cast<W>(scale(c));
+            op.offset = static_cast<W>(offset(c));
+            const int64_t i = static_cast<int64_t>(c);
+            detail::convert(op, src.data() + i * src_stride, src_slice, dst.data() + i * dst_stride, dst_slice, pool,
+                            grain);
+        }
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_CONVERT_HPP
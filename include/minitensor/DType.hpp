@@ -0,0 +1,294 @@
+#ifndef MINITENSOR_DTYPE_HPP
+#define MINITENSOR_DTYPE_HPP
+#include "Half.hpp"
+#include "Tensor.hpp"
+
+#include <assert.h>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Element type of a tensor that is only known at runtime
+    enum class DType : uint8_t
+    {
+        Bool,
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Int64,
+        UInt64,
+        Float32,
+        Float64,
+        Float16,
+        BFloat16
+    };
+
+    static constexpr const uint8_t DTYPE_COUNT = 13;
+
+    // DType of an element type, DTypeOf<float>::value is DType::Float32
+    template <class T>
+    struct DTypeOf;
+
+    template <class T>
+    struct DTypeOf<const T> : DTypeOf<T>
+    {
+    };
+
+#define MT_DTYPE_OF(TYPE, DTYPE)                                                                                       \
+    template <>                                                                                                        \
+    struct DTypeOf<TYPE>                                                                                               \
+    {                                                                                                                  \
+        static constexpr const DType value = DType::DTYPE;                                                             \
+    };
+
+    MT_DTYPE_OF(bool, Bool)
+    MT_DTYPE_OF(int8_t, Int8)
+    MT_DTYPE_OF(uint8_t, UInt8)
+    MT_DTYPE_OF(int16_t, Int16)
+    MT_DTYPE_OF(uint16_t, UInt16)
+    MT_DTYPE_OF(int32_t, Int32)
+    MT_DTYPE_OF(uint32_t, UInt32)
+    MT_DTYPE_OF(int64_t, Int64)
+    MT_DTYPE_OF(uint64_t, UInt64)
+    MT_DTYPE_OF(float, Float32)
+    MT_DTYPE_OF(double, Float64)
+    MT_DTYPE_OF(float16, Float16)
+    MT_DTYPE_OF(bfloat16, BFloat16)
+#undef MT_DTYPE_OF
+
+    inline size_t dtypeSize(DType dtype)
+    {
+        static const uint8_t SIZES[DTYPE_COUNT] = {1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8, 2, 2};
+        return SIZES[static_cast<uint8_t>(dtype)];
+    }
+
+    // NumPy style name, for example "float32"
+    inline const char* dtypeName(DType dtype)
+    {
+        static const char* const NAMES[DTYPE_COUNT] = {"bool",
+                                                       "int8",
+                                                       "uint8",
+                                                       "int16",
+                                                       "uint16",
+                                                       "int32",
+                                                       "uint32",
+                                                       "int64",
+                                                       "uint64",
+                                                       "float32",
+                                                       "float64",
+                                                       "float16",
+                                                       "bfloat16"};
+        return NAMES[static_cast<uint8_t>(dtype)];
+    }
+
+    namespace detail
+    {
+        template <class... T>
+        struct TypeList
+        {
+        };
+
+        // Types a registry is filled with by default
+        typedef TypeList<bool,
+                         int8_t,
+                         uint8_t,
+                         int16_t,
+                         uint16_t,
+                         int32_t,
+                         uint32_t,
+                         int64_t,
+                         uint64_t,
+                         float,
+                         double,
+                         float16,
+                         bfloat16>
+            AllDTypes_t;
+        // Types with vector arithmetic, bool has no vector type and the 16 bit floats are storage only
+        typedef TypeList<int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t, float, double>
+            ArithmeticDTypes_t;
+
+        // copyScaled for factors only known at runtime
+        template <uint8_t N>
+        Shape<N> scaleShape(const Shape<N>& shape, size_t numerator, size_t denominator)
+        {
+            Shape<N> out_shape;
+            for (uint8_t i = 0; i < N; ++i)
+            {
+                assert((shape[i] * numerator) % denominator == 0);
+                out_shape.setShape(i, static_cast<DimSize_t>(shape[i] * numerator / denominator));
+                const Stride_t stride = static_cast<Stride_t>(shape.getStride(i));
+                out_shape.setStride(i, stride * Stride_t(numerator) / Stride_t(denominator));
+            }
+            return out_shape;
+        }
+    } // namespace detail
+
+    // Table of kernels indexed by DType. FN is a function pointer type shared by every entry, typically a
+    // template instantiated once per element type. Looking up the kernel is the only per call cost, the
+    // kernel itself runs on typed pointers.
+    template <class FN>
+    class KernelRegistry
+    {
+        FN m_kernels[DTYPE_COUNT];
+
+      public:
+        KernelRegistry()
+        {
+            for (uint8_t i = 0; i < DTYPE_COUNT; ++i)
+            {
+                m_kernels[i] = nullptr;
+            }
+        }
+
+        void set(DType dtype, FN kernel) { m_kernels[static_cast<uint8_t>(dtype)] = kernel; }
+        FN get(DType dtype) const { return m_kernels[static_cast<uint8_t>(dtype)]; }
+        bool supports(DType dtype) const { return get(dtype) != nullptr; }
+
+        template <class... ARGS>
+        void operator()(DType dtype, ARGS&&... args) const
+        {
+            const FN kernel = get(dtype);
+            assert(kernel != nullptr && "No kernel registered for this dtype");
+            kernel(std::forward<ARGS>(args)...);
+        }
+    };
+
+    namespace detail
+    {
+        template <template <class> class KERNEL, class FN>
+        void registerKernels(KernelRegistry<FN>&, TypeList<>)
+        {
+        }
+
+        template <template <class> class KERNEL, class FN, class T, class... TYPES>
+        void registerKernels(KernelRegistry<FN>& registry, TypeList<T, TYPES...>)
+        {
+            registry.set(DTypeOf<T>::value, static_cast<FN>(&KERNEL<T>::apply));
+            registerKernels<KERNEL>(registry, TypeList<TYPES...>());
+        }
+    } // namespace detail
+
+    // Registry holding KERNEL<T>::apply for every T of TYPES, built once on first use
+    template <template <class> class KERNEL, class FN, class TYPES = detail::AllDTypes_t>
+    const KernelRegistry<FN>& kernelRegistry()
+    {
+        struct Builder
+        {
+            static KernelRegistry<FN> build()
+            {
+                KernelRegistry<FN> registry;
+                detail::registerKernels<KERNEL>(registry, TYPES());
+                return registry;
+            }
+        };
+        static const KernelRegistry<FN> registry = Builder::build();
+        return registry;
+    }
+
+    namespace detail
+    {
+        template <class T>
+        struct DynamicCopy;
+    } // namespace detail
+
+    // Type erased tensor that remembers its element type. T is void or const void. The shape is in elements,
+    // bytes() gives the Tensor<void, D> view with the shape in bytes and as<U>() gives the typed view back.
+    template <class T, uint8_t D>
+    class DynamicTensor
+    {
+        static_assert(std::is_void<T>::value, "DynamicTensor holds void or const void pointers");
+
+        T* m_ptr;
+        Shape<D> m_shape;
+        DType m_dtype;
+
+      public:
+        DynamicTensor(T* ptr = nullptr, DType dtype = DType::UInt8, Shape<D> shape = Shape<D>())
+            : m_ptr(ptr), m_shape(shape), m_dtype(dtype)
+        {
+        }
+
+        template <class U, class = typename std::enable_if<!std::is_void<U>::value>::type>
+        DynamicTensor(Tensor<U, D> tensor)
+            : m_ptr(static_cast<T*>(tensor.data())), m_shape(tensor.getShape()), m_dtype(DTypeOf<U>::value)
+        {
+        }
+
+        // From a view whose shape is in bytes, such as one obtained from a mapped .npy file
+        DynamicTensor(Tensor<T, D> bytes, DType dtype)
+            : m_ptr(bytes.data()), m_shape(detail::scaleShape(bytes.getShape(), 1, dtypeSize(dtype))),
+              m_dtype(dtype)
+        {
+        }
+
+        template <class U, class = typename std::enable_if<std::is_const<T>::value && !std::is_const<U>::value>::type>
+        DynamicTensor(const DynamicTensor<U, D>& other)
+            : m_ptr(other.data()), m_shape(other.getShape()), m_dtype(other.dtype())
+        {
+        }
+
+        // Typed view, U must match dtype()
+        template <class U>
+        Tensor<U, D> as() const
+        {
+            static_assert(std::is_const<U>::value || !std::is_const<T>::value, "Cannot drop const");
+            assert(DTypeOf<U>::value == m_dtype);
+            return Tensor<U, D>(static_cast<U*>(m_ptr), m_shape);
+        }
+
+        Tensor<T, D> bytes() const { return Tensor<T, D>(m_ptr, detail::scaleShape(m_shape, dtypeSize(m_dtype), 1)); }
+
+        // Same dtype and shape, see copyStrided
+        void copyTo(const DynamicTensor<void, D>& dst) const { copyTo(dst, nullptr, ThreadPool::DEFAULT_GRAIN); }
+
+        void copyTo(const DynamicTensor<void, D>& dst,
+                    ThreadPool& pool,
+                    uint64_t grain = ThreadPool::DEFAULT_GRAIN) const
+        {
+            copyTo(dst, &pool, grain);
+        }
+
+        MT_XINLINE DType dtype() const { return m_dtype; }
+        MT_XINLINE size_t elementSize() const { return dtypeSize(m_dtype); }
+        MT_XINLINE const Shape<D>& getShape() const { return m_shape; }
+        MT_XINLINE T* data() const { return m_ptr; }
+
+      private:
+        void copyTo(const DynamicTensor<void, D>& dst, ThreadPool* pool, uint64_t grain) const
+        {
+            assert(m_dtype == dst.dtype());
+            typedef void (*Kernel_t)(const DynamicTensor<const void, D>&, const DynamicTensor<void, D>&, ThreadPool*,
+                                     uint64_t);
+            kernelRegistry<detail::DynamicCopy, Kernel_t>()(m_dtype, *this, dst, pool, grain);
+        }
+    };
+
+    namespace detail
+    {
+        template <class T>
+        struct DynamicCopy
+        {
+            template <uint8_t D>
+            static void apply(const DynamicTensor<const void, D>& src,
+                              const DynamicTensor<void, D>& dst,
+                              ThreadPool* pool,
+                              uint64_t grain)
+            {
+                const Tensor<const T, D> in = src.template as<const T>();
+                Tensor<T, D> out = dst.template as<T>();
+                copyStrided<T, D>(in.data(), in.getShape(), out.data(), out.getShape(), pool, grain);
+            }
+        };
+    } // namespace detail
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_DTYPE_HPP
@@ -0,0 +1,212 @@
+#ifndef MINITENSOR_DISPATCH_HPP
+#define MINITENSOR_DISPATCH_HPP
+#include "Convert.hpp"
+#include "DType.hpp"
+#include "Elementwise.hpp"
+#include "Reduce.hpp"
+
+#include <assert.h>
+
+// Operations on DynamicTensor. Each call looks up the kernel of its dtype once and runs the typed
+// implementation, there is no per element dispatch. Operands of arithmetic must share one dtype, convert first
+// otherwise.
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    namespace detail
+    {
+        template <class T>
+        struct DynamicFill
+        {
+            template <uint8_t D>
+            static void apply(const DynamicTensor<void, D>& dst, double value, ThreadPool* pool, uint64_t grain)
+            {
+                fill(dst.template as<T>(), static_cast<T>(value), pool, grain);
+            }
+        };
+
+        // Dispatches on the source dtype, then on the destination dtype. affine holds scale and offset, or is
+        // null for a plain conversion.
+        template <class A>
+        struct DynamicConvert
+        {
+            template <class T>
+            struct To
+            {
+                template <uint8_t D>
+                static void apply(const DynamicTensor<const void, D>& src,
+                                  const DynamicTensor<void, D>& dst,
+                                  const double* affine,
+                                  ThreadPool* pool,
+                                  uint64_t grain)
+                {
+                    if (affine == nullptr)
+                    {
+                        convert(src.template as<const A>(), dst.template as<T>(), pool, grain);
+                        return;
+                    }
+                    convert(src.template as<const A>(), dst.template as<T>(), affine[0], affine[1], pool, grain);
+                }
+            };
+
+            template <uint8_t D>
+            static void apply(const DynamicTensor<const void, D>& src,
+                              const DynamicTensor<void, D>& dst,
+                              const double* affine,
+                              ThreadPool* pool,
+                              uint64_t grain)
+            {
+                typedef void (*Kernel_t)(const DynamicTensor<const void, D>&, const DynamicTensor<void, D>&,
+                                         const double*, ThreadPool*, uint64_t);
+                kernelRegistry<To, Kernel_t>()(dst.dtype(), src, dst, affine, pool, grain);
+            }
+        };
+
+        template <class OP>
+        struct DynamicReduce
+        {
+            template <class T>
+            struct Kernel
+            {
+                template <uint8_t D>
+                static void apply(const DynamicTensor<const void, D>& in,
+                                  uint8_t axis,
+                                  const DynamicTensor<void, D - 1>& out,
+                                  ThreadPool* pool,
+                                  uint64_t grain)
+                {
+                    reduce(in.template as<const T>(), axis, OP(), out.template as<T>(), pool, grain);
+                }
+            };
+        };
+
+        template <class OP>
+        struct DynamicBinary
+        {
+            template <class T>
+            struct Kernel
+            {
+                template <uint8_t DA, uint8_t DB, uint8_t D>
+                static void apply(const DynamicTensor<const void, DA>& a,
+                                  const DynamicTensor<const void, DB>& b,
+                                  const DynamicTensor<void, D>& out)
+                {
+                    elementwise(OP(), a.template as<const T>(), b.template as<const T>(), out.template as<T>());
+                }
+            };
+        };
+
+        template <class OP, class A, class B, uint8_t DA, uint8_t DB, uint8_t D>
+        void elementwise(const OP&,
+                         const DynamicTensor<A, DA>& a,
+                         const DynamicTensor<B, DB>& b,
+                         const DynamicTensor<void, D>& out)
+        {
+            assert(a.dtype() == out.dtype() && b.dtype() == out.dtype());
+            typedef void (*Kernel_t)(const DynamicTensor<const void, DA>&, const DynamicTensor<const void, DB>&,
+                                     const DynamicTensor<void, D>&);
+            kernelRegistry<DynamicBinary<OP>::template Kernel, Kernel_t, ArithmeticDTypes_t>()(
+                out.dtype(), DynamicTensor<const void, DA>(a), DynamicTensor<const void, DB>(b), out);
+        }
+    } // namespace detail
+
+    // Sets every element of dst to value converted to its dtype
+    template <uint8_t D>
+    void fill(const DynamicTensor<void, D>& dst,
+              double value,
+              ThreadPool* pool = nullptr,
+              uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        typedef void (*Kernel_t)(const DynamicTensor<void, D>&, double, ThreadPool*, uint64_t);
+        kernelRegistry<detail::DynamicFill, Kernel_t>()(dst.dtype(), dst, value, pool, grain);
+    }
+
+    namespace detail
+    {
+        template <class A, uint8_t D>
+        void convert(const DynamicTensor<A, D>& src,
+                     const DynamicTensor<void, D>& dst,
+                     const double* affine,
+                     ThreadPool* pool,
+                     uint64_t grain)
+        {
+            typedef void (*Kernel_t)(const DynamicTensor<const void, D>&, const DynamicTensor<void, D>&,
+                                     const double*, ThreadPool*, uint64_t);
+            kernelRegistry<DynamicConvert, Kernel_t>()(
+                src.dtype(), DynamicTensor<const void, D>(src), dst, affine, pool, grain);
+        }
+    } // namespace detail
+
+    // Conversion between any pair of dtypes, see convert on Tensor
+    template <class A, uint8_t D>
+    void convert(const DynamicTensor<A, D>& src,
+                 const DynamicTensor<void, D>& dst,
+                 ThreadPool* pool = nullptr,
+                 uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        detail::convert(src, dst, nullptr, pool, grain);
+    }
+
+    // dst = saturate(src * scale + offset)
+    template <class A, uint8_t D>
+    void convert(const DynamicTensor<A, D>& src,
+                 const DynamicTensor<void, D>& dst,
+                 double scale,
+                 double offset,
+                 ThreadPool* pool = nullptr,
+                 uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        const double affine[] = {scale, offset};
+        detail::convert(src, dst, affine, pool, grain);
+    }
+
+    // Reduces axis of in with op into out, see reduce on Tensor
+    template <class OP, class A, uint8_t D>
+    void reduce(const DynamicTensor<A, D>& in,
+                uint8_t axis,
+                OP,
+                const DynamicTensor<void, D - 1>& out,
+                ThreadPool* pool = nullptr,
+                uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        assert(in.dtype() == out.dtype());
+        typedef void (*Kernel_t)(const DynamicTensor<const void, D>&, uint8_t, const DynamicTensor<void, D - 1>&,
+                                 ThreadPool*, uint64_t);
+        kernelRegistry<detail::DynamicReduce<OP>::template Kernel, Kernel_t, detail::ArithmeticDTypes_t>()(
+            in.dtype(), DynamicTensor<const void, D>(in), axis, out, pool, grain);
+    }
+
+#define MT_DYNAMIC_REDUCTION(NAME, OP)                                                                                 \
+    template <class A, uint8_t D>                                                                                      \
+    void NAME(const DynamicTensor<A, D>& in, uint8_t axis, const DynamicTensor<void, D - 1>& out,                      \
+              ThreadPool* pool = nullptr)                                                                              \
+    {                                                                                                                  \
+        reduce(in, axis, OP(), out, pool);                                                                             \
+    }
+
+    MT_DYNAMIC_REDUCTION(sum, ops::ReduceSum)
+    MT_DYNAMIC_REDUCTION(mean, ops::ReduceMean)
+    MT_DYNAMIC_REDUCTION(norm, ops::ReduceNorm)
+    MT_DYNAMIC_REDUCTION(max, ops::ReduceMax)
+    MT_DYNAMIC_REDUCTION(min, ops::ReduceMin)
+#undef MT_DYNAMIC_REDUCTION
+
+// Inputs are broadcast to the shape of out like the Tensor versions
+#define MT_DYNAMIC_BINARY(NAME, OP)                                                                                    \
+    template <class A, class B, uint8_t DA, uint8_t DB, uint8_t D>                                                     \
+    void NAME(const DynamicTensor<A, DA>& a, const DynamicTensor<B, DB>& b, const DynamicTensor<void, D>& out)         \
+    {                                                                                                                  \
+        detail::elementwise(OP(), a, b, out);                                                                          \
+    }
+
+    MT_DYNAMIC_BINARY(add, ops::SimdAdd)
+    MT_DYNAMIC_BINARY(mul, ops::SimdMul)
+    MT_DYNAMIC_BINARY(min, ops::SimdMin)
+    MT_DYNAMIC_BINARY(max, ops::SimdMax)
+#undef MT_DYNAMIC_BINARY
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_DISPATCH_HPP
@@ -0,0 +1,172 @@
+#ifndef MINITENSOR_ELEMENTWISE_HPP
+#define MINITENSOR_ELEMENTWISE_HPP
+#include "LoopNest.hpp"
+#include "Simd.hpp"
+#include "Tensor.hpp"
+
+#include <memory>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    namespace detail
+    {
+        // Applies op to every element. Inputs are broadcast to the shape of out, see broadcastShape. Rows
+        // where the output and every input are dense go through the vector kernel of the active instruction
+        // set, inputs repeated along the row are hoisted out of the kernel's loop. Other rows are processed
+        // with a scalar strided loop. out may be one of the inputs. Inputs that overlap out otherwise are read
+        // from a dense copy, unless walking the rows in order reads every element before it is overwritten.
+        template <uint8_t ARITY, class OP, class T, uint8_t D>
+        void elementwise(const OP& op, Tensor<T, D> out, const T* const* in, const Shape<D>* const* in_shapes)
+        {
+            const Shape<D> out_shape = out.getShape();
+            const Shape<D>* shapes[ARITY + 1];
+            const T* inputs[ARITY];
+            std::unique_ptr<T[]> buffers[ARITY];
+            Shape<D> buffer_shape = out_shape;
+            buffer_shape.calculateStride();
+            shapes[0] = &out_shape;
+            for (uint8_t a = 0; a < ARITY; ++a)
+            {
+                shapes[a + 1] = in_shapes[a];
+                inputs[a] = in[a];
+                const AliasOrder order = aliasOrder(out.data(), out_shape, in[a], *in_shapes[a], sizeof(T));
+                if (order == AliasOrder::Backward || order == AliasOrder::Buffered)
+                {
+                    buffers[a].reset(new T[buffer_shape.numElements()]);
+                    copyStrided(in[a], *in_shapes[a], buffers[a].get(), buffer_shape);
+                    shapes[a + 1] = &buffer_shape;
+                    inputs[a] = buffers[a].get();
+                }
+            }
+            const LoopNest<D, ARITY + 1> loop(shapes);
+            int64_t steps[ARITY + 1];
+            bool dense = loop.innerStride(0) == 1;
+            uint8_t broadcast = 0;
+            steps[0] = loop.innerStride(0);
+            for (uint8_t a = 0; a < ARITY; ++a)
+            {
+                steps[a + 1] = loop.innerStride(a + 1);
+                dense = dense && (steps[a + 1] == 1 || steps[a + 1] == 0);
+                broadcast |= steps[a + 1] == 0 ? 1 << a : 0;
+            }
+            const RowKernel<OP, T, ARITY> kernel = selectRowKernel<OP, T, ARITY>(getSimdIsa(), broadcast);
+            T* dst = out.data();
+            loop.forEachRow([&](const int64_t* offsets, uint32_t n) {
+                T* row = dst + offsets[0];
+                const T* rows[ARITY];
+                for (uint8_t a = 0; a < ARITY; ++a)
+                {
+                    rows[a] = inputs[a] + offsets[a + 1];
+                }
+                if (dense)
+                {
+                    kernel(op, row, rows, n);
+                    return;
+                }
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    T args[ARITY];
+                    for (uint8_t a = 0; a < ARITY; ++a)
+                    {
+                        args[a] = rows[a][i * steps[a + 1]];
+                    }
+                    Invoke<ARITY>::call(op, row[i * steps[0]], static_cast<const T*>(args));
+                }
+            });
+        }
+
+        template <class OP, class T, class A, class B, uint8_t DA, uint8_t DB, uint8_t D>
+        void elementwise(const OP& op, const Tensor<A, DA>& a, const Tensor<B, DB>& b, Tensor<T, D> out)
+        {
+            static_assert(std::is_same<typename std::remove_const<A>::type, T>::value &&
+                              std::is_same<typename std::remove_const<B>::type, T>::value,
+                          "Inputs and output must have the same element type");
+            const T* const in[] = {a.data(), b.data()};
+            const Shape<D> a_shape = broadcastShape(a.getShape(), out.getShape());
+            const Shape<D> b_shape = broadcastShape(b.getShape(), out.getShape());
+            const Shape<D>* const shapes[] = {&a_shape, &b_shape};
+            elementwise<2>(op, out, in, shapes);
+        }
+
+        template <class OP, class T, class A, uint8_t DA, uint8_t D>
+        void elementwise(const OP& op, const Tensor<A, DA>& a, Tensor<T, D> out)
+        {
+            static_assert(std::is_same<typename std::remove_const<A>::type, T>::value,
+                          "Input and output must have the same element type");
+            const T* const in[] = {a.data()};
+            const Shape<D> a_shape = broadcastShape(a.getShape(), out.getShape());
+            const Shape<D>* const shapes[] = {&a_shape};
+            elementwise<1>(op, out, in, shapes);
+        }
+    } // namespace detail
+
+    // Inputs of the functions below are broadcast to the shape of out
+
+    // out = a + b
+    template <class T, class A, class B, uint8_t DA, uint8_t DB, uint8_t D>
+    void add(const Tensor<A, DA>& a, const Tensor<B, DB>& b, Tensor<T, D> out)
+    {
+        detail::elementwise(ops::SimdAdd(), a, b, out);
+    }
+
+    // out = a * b
+    template <class T, class A, class B, uint8_t DA, uint8_t DB, uint8_t D>
+    void mul(const Tensor<A, DA>& a, const Tensor<B, DB>& b, Tensor<T, D> out)
+    {
+        detail::elementwise(ops::SimdMul(), a, b, out);
+    }
+
+    // out = b < a ? b : a
+    template <class T, class A, class B, uint8_t DA, uint8_t DB, uint8_t D>
+    void min(const Tensor<A, DA>& a, const Tensor<B, DB>& b, Tensor<T, D> out)
+    {
+        detail::elementwise(ops::SimdMin(), a, b, out);
+    }
+
+    // out = a < b ? b : a
+    template <class T, class A, class B, uint8_t DA, uint8_t DB, uint8_t D>
+    void max(const Tensor<A, DA>& a, const Tensor<B, DB>& b, Tensor<T, D> out)
+    {
+        detail::elementwise(ops::SimdMax(), a, b, out);
+    }
+
+    // out = a * b + c, rounded once for floating point types like std::fma
+    template <class T, class A, class B, class C, uint8_t DA, uint8_t DB, uint8_t DC, uint8_t D>
+    void fma(const Tensor<A, DA>& a, const Tensor<B, DB>& b, const Tensor<C, DC>& c, Tensor<T, D> out)
+    {
+        static_assert(std::is_same<typename std::remove_const<A>::type, T>::value &&
+                          std::is_same<typename std::remove_const<B>::type, T>::value &&
+                          std::is_same<typename std::remove_const<C>::type, T>::value,
+                      "Inputs and output must have the same element type");
+        const T* const in[] = {a.data(), b.data(), c.data()};
+        const Shape<D> a_shape = broadcastShape(a.getShape(), out.getShape());
+        const Shape<D> b_shape = broadcastShape(b.getShape(), out.getShape());
+        const Shape<D> c_shape = broadcastShape(c.getShape(), out.getShape());
+        const Shape<D>* const shapes[] = {&a_shape, &b_shape, &c_shape};
+        detail::elementwise<3>(ops::SimdFma<T>(), out, in, shapes);
+    }
+
+    // out = |a|
+    template <class T, class A, uint8_t DA, uint8_t D>
+    void abs(const Tensor<A, DA>& a, Tensor<T, D> out)
+    {
+        detail::elementwise(ops::SimdAbs<T>(), a, out);
+    }
+
+    // out = min(max(a, lo), hi)
+    template <class T, class A, uint8_t DA, uint8_t D>
+    void clamp(const Tensor<A, DA>& a, T lo, T hi, Tensor<T, D> out)
+    {
+        ops::SimdClamp<T> op;
+        op.lo = lo;
+        op.hi = hi;
+        detail::elementwise(op, a, out);
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_ELEMENTWISE_HPP
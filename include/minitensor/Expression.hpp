@@ -0,0 +1,542 @@
+#ifndef MINITENSOR_EXPRESSION_HPP
+#define MINITENSOR_EXPRESSION_HPP
+#include "LoopNest.hpp"
+#include "Tensor.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Lazy elementwise expressions over tensor views. Arithmetic on tensors builds a tree of nodes, nothing
+    // is computed until the tree is assigned into a destination tensor, at which point every node is
+    // evaluated in a single pass over the destination without intermediate buffers.
+    //
+    // Every node provides
+    //   value_type, DIM (0 for scalars) and NUM_TENSORS (number of tensor leaves)
+    //   collectShapes(out, target) writes the shape of each tensor leaf broadcast to target, left to right
+    //   visitLeaves(visit)         calls visit(data, shape) for each tensor leaf, left to right
+    //   seek<I>(offsets, steps) positions the leaves at the start of a row, leaf k uses offsets[I + k]
+    //   at(i) / atDense(i)     value of the i'th element of the current row, atDense assumes unit steps
+    //   atHoisted(i)           like atDense but leaves with a zero step return the value read by seek
+    template <class DERIVED>
+    struct Expression
+    {
+        const DERIVED& derived() const { return *static_cast<const DERIVED*>(this); }
+    };
+
+    template <class T, uint8_t D>
+    class TensorExpr : public Expression<TensorExpr<T, D>>
+    {
+        const T* m_ptr;
+        Shape<D> m_shape;
+        const T* m_row = nullptr;
+        int64_t m_step = 0;
+        T m_value = T();
+
+      public:
+        using value_type = T;
+        static constexpr const uint8_t DIM = D;
+        static constexpr const uint8_t NUM_TENSORS = 1;
+
+        TensorExpr(const T* ptr, const Shape<D>& shape) : m_ptr(ptr), m_shape(shape) {}
+
+        template <uint8_t N>
+        void collectShapes(Shape<N>* out, const Shape<N>& target) const
+        {
+            out[0] = broadcastShape(m_shape, target);
+        }
+
+        template <class V>
+        void visitLeaves(V& visit) const
+        {
+            visit(m_ptr, m_shape);
+        }
+
+        template <uint8_t I>
+        void seek(const int64_t* offsets, const int64_t* steps)
+        {
+            m_row = m_ptr + offsets[I];
+            m_step = steps[I];
+            // A leaf broadcast along the row reads the same element for every i
+            m_value = m_step == 0 ? *m_row : T();
+        }
+
+        MT_XINLINE T at(uint32_t i) const { return m_row[i * m_step]; }
+        MT_XINLINE T atDense(uint32_t i) const { return m_row[i]; }
+        MT_XINLINE T atHoisted(uint32_t i) const { return m_step == 0 ? m_value : m_row[i]; }
+    };
+
+    template <class T>
+    class ScalarExpr : public Expression<ScalarExpr<T>>
+    {
+        T m_value;
+
+      public:
+        using value_type = T;
+        static constexpr const uint8_t DIM = 0;
+        static constexpr const uint8_t NUM_TENSORS = 0;
+
+        ScalarExpr(T value) : m_value(value) {}
+
+        template <uint8_t N>
+        void collectShapes(Shape<N>*, const Shape<N>&) const
+        {
+        }
+
+        template <class V>
+        void visitLeaves(V&) const
+        {
+        }
+
+        template <uint8_t I>
+        void seek(const int64_t*, const int64_t*)
+        {
+        }
+
+        MT_XINLINE T at(uint32_t) const { return m_value; }
+        MT_XINLINE T atDense(uint32_t) const { return m_value; }
+        MT_XINLINE T atHoisted(uint32_t) const { return m_value; }
+    };
+
+    template <class OP, class E>
+    class UnaryExpr : public Expression<UnaryExpr<OP, E>>
+    {
+        E m_arg;
+
+      public:
+        using value_type = decltype(OP::apply(std::declval<typename E::value_type>()));
+        static constexpr const uint8_t DIM = E::DIM;
+        static constexpr const uint8_t NUM_TENSORS = E::NUM_TENSORS;
+
+        UnaryExpr(const E& arg) : m_arg(arg) {}
+
+        template <uint8_t N>
+        void collectShapes(Shape<N>* out, const Shape<N>& target) const
+        {
+            m_arg.collectShapes(out, target);
+        }
+
+        template <class V>
+        void visitLeaves(V& visit) const
+        {
+            m_arg.visitLeaves(visit);
+        }
+
+        template <uint8_t I>
+        void seek(const int64_t* offsets, const int64_t* steps)
+        {
+            m_arg.template seek<I>(offsets, steps);
+        }
+
+        MT_XINLINE value_type at(uint32_t i) const { return OP::apply(m_arg.at(i)); }
+        MT_XINLINE value_type atDense(uint32_t i) const { return OP::apply(m_arg.atDense(i)); }
+        MT_XINLINE value_type atHoisted(uint32_t i) const { return OP::apply(m_arg.atHoisted(i)); }
+    };
+
+    template <class OP, class L, class R>
+    class BinaryExpr : public Expression<BinaryExpr<OP, L, R>>
+    {
+        L m_lhs;
+        R m_rhs;
+
+      public:
+        using value_type =
+            decltype(OP::apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+        static constexpr const uint8_t DIM = L::DIM > R::DIM ? L::DIM : R::DIM;
+        static constexpr const uint8_t NUM_TENSORS = L::NUM_TENSORS + R::NUM_TENSORS;
+
+        BinaryExpr(const L& lhs, const R& rhs) : m_lhs(lhs), m_rhs(rhs) {}
+
+        template <uint8_t N>
+        void collectShapes(Shape<N>* out, const Shape<N>& target) const
+        {
+            m_lhs.collectShapes(out, target);
+            m_rhs.collectShapes(out + L::NUM_TENSORS, target);
+        }
+
+        template <class V>
+        void visitLeaves(V& visit) const
+        {
+            m_lhs.visitLeaves(visit);
+            m_rhs.visitLeaves(visit);
+        }
+
+        template <uint8_t I>
+        void seek(const int64_t* offsets, const int64_t* steps)
+        {
+            m_lhs.template seek<I>(offsets, steps);
+            m_rhs.template seek<I + L::NUM_TENSORS>(offsets, steps);
+        }
+
+        MT_XINLINE value_type at(uint32_t i) const { return OP::apply(m_lhs.at(i), m_rhs.at(i)); }
+        MT_XINLINE value_type atDense(uint32_t i) const { return OP::apply(m_lhs.atDense(i), m_rhs.atDense(i)); }
+        MT_XINLINE value_type atHoisted(uint32_t i) const
+        {
+            return OP::apply(m_lhs.atHoisted(i), m_rhs.atHoisted(i));
+        }
+    };
+
+    template <class C, class A, class B>
+    class WhereExpr : public Expression<WhereExpr<C, A, B>>
+    {
+        C m_cond;
+        A m_true;
+        B m_false;
+
+      public:
+        using value_type = typename std::common_type<typename A::value_type, typename B::value_type>::type;
+        static constexpr const uint8_t DIM =
+            C::DIM > A::DIM ? (C::DIM > B::DIM ? C::DIM : B::DIM) : (A::DIM > B::DIM ? A::DIM : B::DIM);
+        static constexpr const uint8_t NUM_TENSORS = C::NUM_TENSORS + A::NUM_TENSORS + B::NUM_TENSORS;
+
+        WhereExpr(const C& cond, const A& if_true, const B& if_false)
+            : m_cond(cond), m_true(if_true), m_false(if_false)
+        {
+        }
+
+        template <uint8_t N>
+        void collectShapes(Shape<N>* out, const Shape<N>& target) const
+        {
+            m_cond.collectShapes(out, target);
+            m_true.collectShapes(out + C::NUM_TENSORS, target);
+            m_false.collectShapes(out + C::NUM_TENSORS + A::NUM_TENSORS, target);
+        }
+
+        template <class V>
+        void visitLeaves(V& visit) const
+        {
+            m_cond.visitLeaves(visit);
+            m_true.visitLeaves(visit);
+            m_false.visitLeaves(visit);
+        }
+
+        template <uint8_t I>
+        void seek(const int64_t* offsets, const int64_t* steps)
+        {
+            m_cond.template seek<I>(offsets, steps);
+            m_true.template seek<I + C::NUM_TENSORS>(offsets, steps);
+            m_false.template seek<I + C::NUM_TENSORS + A::NUM_TENSORS>(offsets, steps);
+        }
+
+        MT_XINLINE value_type at(uint32_t i) const
+        {
+            return m_cond.at(i) ? value_type(m_true.at(i)) : value_type(m_false.at(i));
+        }
+        MT_XINLINE value_type atDense(uint32_t i) const
+        {
+            return m_cond.atDense(i) ? value_type(m_true.atDense(i)) : value_type(m_false.atDense(i));
+        }
+        MT_XINLINE value_type atHoisted(uint32_t i) const
+        {
+            return m_cond.atHoisted(i) ? value_type(m_true.atHoisted(i)) : value_type(m_false.atHoisted(i));
+        }
+    };
+
+    namespace ops
+    {
+#define MT_BINARY_FUNCTOR(NAME, EXPR)                                                                                  \
+    struct NAME                                                                                                        \
+    {                                                                                                                  \
+        template <class A, class B>                                                                                    \
+        static MT_XINLINE auto apply(A a, B b) -> typename std::decay<decltype(EXPR)>::type                            \
+        {                                                                                                              \
+            return EXPR;                                                                                               \
+        }                                                                                                              \
+    };
+
+        MT_BINARY_FUNCTOR(Add, a + b)
+        MT_BINARY_FUNCTOR(Sub, a - b)
+        MT_BINARY_FUNCTOR(Mul, a* b)
+        MT_BINARY_FUNCTOR(Div, a / b)
+        MT_BINARY_FUNCTOR(Less, a < b)
+        MT_BINARY_FUNCTOR(LessEqual, a <= b)
+        MT_BINARY_FUNCTOR(Greater, a > b)
+        MT_BINARY_FUNCTOR(GreaterEqual, a >= b)
+        MT_BINARY_FUNCTOR(Equal, a == b)
+        MT_BINARY_FUNCTOR(NotEqual, a != b)
+        MT_BINARY_FUNCTOR(Min, b < a ? b : a)
+        MT_BINARY_FUNCTOR(Max, a < b ? b : a)
+#undef MT_BINARY_FUNCTOR
+
+#define MT_UNARY_FUNCTOR(NAME, EXPR)                                                                                   \
+    struct NAME                                                                                                        \
+    {                                                                                                                  \
+        template <class A>                                                                                             \
+        static MT_XINLINE auto apply(A a) -> typename std::decay<decltype(EXPR)>::type                                 \
+        {                                                                                                              \
+            return EXPR;                                                                                               \
+        }                                                                                                              \
+    };
+
+        MT_UNARY_FUNCTOR(Neg, -a)
+        MT_UNARY_FUNCTOR(Abs, a < 0 ? -a : a)
+        MT_UNARY_FUNCTOR(Exp, std::exp(a))
+        MT_UNARY_FUNCTOR(Log, std::log(a))
+        MT_UNARY_FUNCTOR(Sqrt, std::sqrt(a))
+        MT_UNARY_FUNCTOR(Tanh, std::tanh(a))
+#undef MT_UNARY_FUNCTOR
+    } // namespace ops
+
+    // Maps the operands of an expression building function onto expression nodes
+    template <class X, class ENABLE = void>
+    struct ExprTraits
+    {
+        static constexpr const bool IS_OPERAND = false;
+    };
+
+    template <class E>
+    struct ExprTraits<E, typename std::enable_if<std::is_base_of<Expression<E>, E>::value>::type>
+    {
+        static constexpr const bool IS_OPERAND = true;
+        using type = E;
+        static const E& make(const E& expr) { return expr; }
+    };
+
+    template <class T, uint8_t D>
+    struct ExprTraits<Tensor<T, D>, typename std::enable_if<!std::is_void<T>::value && !std::is_const<T>::value>::type>
+    {
+        static constexpr const bool IS_OPERAND = D != 0;
+        using type = TensorExpr<T, D>;
+        static type make(const Tensor<T, D>& tensor) { return type(tensor.data(), tensor.getShape()); }
+    };
+
+    template <class T, uint8_t D>
+    struct ExprTraits<Tensor<const T, D>, typename std::enable_if<!std::is_void<T>::value>::type>
+    {
+        static constexpr const bool IS_OPERAND = D != 0;
+        using type = TensorExpr<T, D>;
+        static type make(const Tensor<const T, D>& tensor) { return type(tensor.data(), tensor.getShape()); }
+    };
+
+    // Scalars take the value type of the expression they are combined with so that tensor * 2.0 stays
+    // in the precision of the tensor. Integer expressions take the common type instead, converting the
+    // scalar would turn int_tensor * 0.5 into a multiplication by 0 and byte_tensor < 300 into < 44.
+    template <class S, class E, bool = std::is_integral<E>::value>
+    struct ScalarType
+    {
+        using type = E;
+    };
+
+    template <class S, class E>
+    struct ScalarType<S, E, true>
+    {
+        using type = typename std::common_type<S, E>::type;
+    };
+
+    template <class X, class OTHER, bool = ExprTraits<X>::IS_OPERAND>
+    struct Operand
+    {
+        using type = typename ExprTraits<X>::type;
+        static type make(const X& x) { return ExprTraits<X>::make(x); }
+    };
+
+    template <class X, class OTHER>
+    struct Operand<X, OTHER, false>
+    {
+        using type = ScalarExpr<typename ScalarType<X, typename ExprTraits<OTHER>::type::value_type>::type>;
+        static type make(const X& x) { return type(static_cast<typename type::value_type>(x)); }
+    };
+
+    template <class X>
+    struct IsOperandOrScalar
+    {
+        static constexpr const bool value = ExprTraits<X>::IS_OPERAND || std::is_arithmetic<X>::value;
+    };
+
+    template <class OP,
+              class L,
+              class R,
+              bool = (ExprTraits<L>::IS_OPERAND || ExprTraits<R>::IS_OPERAND) && IsOperandOrScalar<L>::value &&
+                     IsOperandOrScalar<R>::value>
+    struct BinaryOp
+    {
+    };
+
+    template <class OP, class L, class R>
+    struct BinaryOp<OP, L, R, true>
+    {
+        using type = BinaryExpr<OP, typename Operand<L, R>::type, typename Operand<R, L>::type>;
+        static type make(const L& lhs, const R& rhs) { return type(Operand<L, R>::make(lhs), Operand<R, L>::make(rhs)); }
+    };
+
+    template <class OP, class X, bool = ExprTraits<X>::IS_OPERAND>
+    struct UnaryOp
+    {
+    };
+
+    template <class OP, class X>
+    struct UnaryOp<OP, X, true>
+    {
+        using type = UnaryExpr<OP, typename ExprTraits<X>::type>;
+        static type make(const X& x) { return type(ExprTraits<X>::make(x)); }
+    };
+
+#define MT_BINARY_EXPRESSION(NAME, OP)                                                                                 \
+    template <class L, class R>                                                                                        \
+    typename BinaryOp<ops::OP, L, R>::type NAME(const L& lhs, const R& rhs)                                            \
+    {                                                                                                                  \
+        return BinaryOp<ops::OP, L, R>::make(lhs, rhs);                                                                \
+    }
+
+    MT_BINARY_EXPRESSION(operator+, Add)
+    MT_BINARY_EXPRESSION(operator-, Sub)
+    MT_BINARY_EXPRESSION(operator*, Mul)
+    MT_BINARY_EXPRESSION(operator/, Div)
+    MT_BINARY_EXPRESSION(operator<, Less)
+    MT_BINARY_EXPRESSION(operator<=, LessEqual)
+    MT_BINARY_EXPRESSION(operator>, Greater)
+    MT_BINARY_EXPRESSION(operator>=, GreaterEqual)
+    MT_BINARY_EXPRESSION(operator==, Equal)
+    MT_BINARY_EXPRESSION(operator!=, NotEqual)
+    MT_BINARY_EXPRESSION(minimum, Min)
+    MT_BINARY_EXPRESSION(maximum, Max)
+#undef MT_BINARY_EXPRESSION
+
+#define MT_UNARY_EXPRESSION(NAME, OP)                                                                                  \
+    template <class X>                                                                                                 \
+    typename UnaryOp<ops::OP, X>::type NAME(const X& x)                                                                \
+    {                                                                                                                  \
+        return UnaryOp<ops::OP, X>::make(x);                                                                           \
+    }
+
+    MT_UNARY_EXPRESSION(operator-, Neg)
+    MT_UNARY_EXPRESSION(abs, Abs)
+    MT_UNARY_EXPRESSION(exp, Exp)
+    MT_UNARY_EXPRESSION(log, Log)
+    MT_UNARY_EXPRESSION(sqrt, Sqrt)
+    MT_UNARY_EXPRESSION(tanh, Tanh)
+#undef MT_UNARY_EXPRESSION
+
+    // Elementwise select, cond must be a tensor or expression, either branch may be a scalar
+    template <class C, class A, class B>
+    auto where(const C& cond, const A& if_true, const B& if_false) -> typename std::enable_if<
+        ExprTraits<C>::IS_OPERAND && (ExprTraits<A>::IS_OPERAND || ExprTraits<B>::IS_OPERAND),
+        WhereExpr<typename ExprTraits<C>::type, typename Operand<A, B>::type, typename Operand<B, A>::type>>::type
+    {
+        using Result =
+            WhereExpr<typename ExprTraits<C>::type, typename Operand<A, B>::type, typename Operand<B, A>::type>;
+        return Result(ExprTraits<C>::make(cond), Operand<A, B>::make(if_true), Operand<B, A>::make(if_false));
+    }
+
+    namespace detail
+    {
+        // Folds the order each tensor leaf of an expression needs against the destination into one. Leaves
+        // of a different element size only pass when their bytes are disjoint from the destination.
+        template <class T, uint8_t D>
+        struct LeafAliasing
+        {
+            const T* dst;
+            Shape<D> dst_shape;
+            AliasOrder order;
+
+            template <class U, uint8_t N>
+            void operator()(const U* src, const Shape<N>& shape)
+            {
+                const Shape<D> src_shape = broadcastShape(shape, dst_shape);
+                AliasOrder leaf = AliasOrder::Any;
+                if (sizeof(U) == sizeof(T))
+                {
+                    leaf = aliasOrder(dst, dst_shape, src, src_shape, sizeof(T));
+                }
+                else
+                {
+                    int64_t dst_begin;
+                    int64_t dst_end;
+                    int64_t src_begin;
+                    int64_t src_end;
+                    elementExtent(dst_shape, dst_begin, dst_end);
+                    elementExtent(src_shape, src_begin, src_end);
+                    const uintptr_t dst_first = reinterpret_cast<uintptr_t>(dst + dst_begin);
+                    const uintptr_t dst_last = reinterpret_cast<uintptr_t>(dst + dst_end);
+                    const uintptr_t src_first = reinterpret_cast<uintptr_t>(src + src_begin);
+                    const uintptr_t src_last = reinterpret_cast<uintptr_t>(src + src_end);
+                    const bool empty = dst_begin == dst_end || src_begin == src_end;
+                    leaf = empty || dst_last <= src_first || src_last <= dst_first ? AliasOrder::Any
+                                                                                   : AliasOrder::Buffered;
+                }
+                if (leaf == AliasOrder::Any || leaf == AliasOrder::Same)
+                {
+                    return;
+                }
+                order = order == AliasOrder::Any || order == leaf ? leaf : AliasOrder::Buffered;
+            }
+        };
+    } // namespace detail
+
+    // Evaluates expr into dst in a single pass. Tensor leaves are broadcast to the shape of dst, then the
+    // destination and every leaf are coalesced into one loop nest. Rows where every operand has unit stride
+    // take the dense path, rows where some leaves are repeated along the row read those leaves once per row.
+    // A leaf that overlaps dst is fine when row major order reads each of its elements before it is written,
+    // like a += a or a shift towards the front, otherwise the expression is evaluated into a temporary first.
+    template <class T, uint8_t D, class E>
+    void assign(Tensor<T, D> dst, const Expression<E>& expr)
+    {
+        static constexpr const uint8_t K = E::NUM_TENSORS + 1;
+        E eval = expr.derived();
+        detail::LeafAliasing<T, D> aliasing{dst.data(), dst.getShape(), detail::AliasOrder::Any};
+        eval.visitLeaves(aliasing);
+        if (aliasing.order == detail::AliasOrder::Backward || aliasing.order == detail::AliasOrder::Buffered)
+        {
+            Shape<D> dense = dst.getShape();
+            dense.calculateStride();
+            // Not a std::vector, which packs bool
+            const std::unique_ptr<T[]> buffer(new T[dense.numElements()]);
+            assign(Tensor<T, D>(buffer.get(), dense), expr);
+            copyStrided<T, D>(buffer.get(), dense, dst.data(), dst.getShape());
+            return;
+        }
+        Shape<D> leaf_shapes[K];
+        leaf_shapes[0] = dst.getShape();
+        eval.collectShapes(leaf_shapes + 1, leaf_shapes[0]);
+        const Shape<D>* shapes[K];
+        for (uint8_t k = 0; k < K; ++k)
+        {
+            shapes[k] = &leaf_shapes[k];
+        }
+        const LoopNest<D, K> loop(shapes);
+        int64_t steps[K];
+        bool dense = true;
+        bool hoisted = loop.innerStride(0) == 1;
+        for (uint8_t k = 0; k < K; ++k)
+        {
+            steps[k] = loop.innerStride(k);
+            dense = dense && steps[k] == 1;
+            hoisted = hoisted && (steps[k] == 1 || steps[k] == 0);
+        }
+        T* out = dst.data();
+        loop.forEachRow([out, &eval, &steps, dense, hoisted](const int64_t* offsets, uint32_t n) {
+            T* row = out + offsets[0];
+            eval.template seek<0>(offsets + 1, steps + 1);
+            if (dense)
+            {
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    row[i] = static_cast<T>(eval.atDense(i));
+                }
+            }
+            else if (hoisted)
+            {
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    row[i] = static_cast<T>(eval.atHoisted(i));
+                }
+            }
+            else
+            {
+                const int64_t step = steps[0];
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    row[i * step] = static_cast<T>(eval.at(i));
+                }
+            }
+        });
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_EXPRESSION_HPP
@@ -0,0 +1,378 @@
+#ifndef MINITENSOR_FORMAT_HPP
+#define MINITENSOR_FORMAT_HPP
+#include "Half.hpp"
+#include "Tensor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    struct FormatOptions
+    {
+        // Significant digits of floating point values, the default matches std::ostream. Values are printed
+        // with at most 17 digits, which round trips every double.
+        int precision = 6;
+        // Tensors with more than threshold elements only show edge_items at both ends of every dimension
+        bool summarize = false;
+        size_t threshold = 1000;
+        uint32_t edge_items = 3;
+        // Every dimension on one line and no column alignment
+        bool single_line = false;
+    };
+
+    namespace detail
+    {
+        // Longest text formatValue produces
+        static constexpr const uint32_t FORMAT_CHARS = 32;
+
+        template <class T>
+        bool isNegative(T value, std::true_type)
+        {
+            return value < 0;
+        }
+
+        template <class T>
+        bool isNegative(T, std::false_type)
+        {
+            return false;
+        }
+
+        // Writes the text of value to out and returns its length, floating point values use %g with precision
+        // significant digits like std::ostream
+        template <class T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, uint32_t>::type
+        formatValue(char* out, T value, int)
+        {
+            typedef typename std::make_unsigned<T>::type U;
+            const bool negative = isNegative(value, std::is_signed<T>());
+            U magnitude = negative ? static_cast<U>(U(0) - static_cast<U>(value)) : static_cast<U>(value);
+            char digits[FORMAT_CHARS];
+            uint32_t n = 0;
+            do
+            {
+                digits[n++] = static_cast<char>('0' + magnitude % 10);
+                magnitude = static_cast<U>(magnitude / 10);
+            } while (magnitude != 0);
+            uint32_t length = 0;
+            if (negative)
+            {
+                out[length++] = '-';
+            }
+            while (n != 0)
+            {
+                out[length++] = digits[--n];
+            }
+            return length;
+        }
+
+        // Like std::boolalpha
+        inline uint32_t formatValue(char* out, bool value, int)
+        {
+            static const char TEXT[2][6] = {"false", "true"};
+            const uint32_t length = value ? 4 : 5;
+            std::copy(TEXT[value], TEXT[value] + length, out);
+            return length;
+        }
+
+        // %g of value when it needs no exponent, which is most values in practice. value is scaled by a power
+        // of ten to an integer of precision digits, this is only done when the rounding of the scaled value is
+        // the rounding of the exact decimal value so the text is identical to snprintf. Returns 0 otherwise.
+        inline uint32_t formatFixed(char* out, double value, int precision)
+        {
+            static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            const double magnitude = std::fabs(value);
+            if (precision < 1 || precision > 15 || !(magnitude >= 1e-4) || !(magnitude < POW10[precision]))
+            {
+                return 0;
+            }
+            // Decimal exponent estimate, corrected below once rounded
+            int exponent = precision - 1;
+            while (exponent > 0 && magnitude < POW10[exponent])
+            {
+                --exponent;
+            }
+            const double low = POW10[precision - 1];
+            const double high = POW10[precision];
+            double digits = 0;
+            for (;; --exponent)
+            {
+                if (exponent < -4)
+                {
+                    return 0;
+                }
+                const double scaled = magnitude * POW10[precision - 1 - exponent];
+                // Half way cases are only trusted when the product is exact
+                const double half = std::floor(scaled) + 0.5;
+                if (std::fabs(scaled - half) <= scaled * std::numeric_limits<double>::epsilon() &&
+                    std::fma(magnitude, POW10[precision - 1 - exponent], -scaled) != 0)
+                {
+                    return 0;
+                }
+                if (scaled >= low)
+                {
+                    digits = std::nearbyint(scaled);
+                    break;
+                }
+            }
+            if (digits >= high)
+            {
+                // Rounding carried into a new digit
+                if (++exponent >= precision)
+                {
+                    return 0;
+                }
+                digits = low;
+            }
+
+            char text[FORMAT_CHARS];
+            uint64_t integer = static_cast<uint64_t>(digits);
+            for (int i = precision - 1; i >= 0; --i)
+            {
+                text[i] = static_cast<char>('0' + integer % 10);
+                integer /= 10;
+            }
+            // Trailing zeros of the fraction are dropped like %g does
+            int last = precision;
+            while (last > exponent + 1 && text[last - 1] == '0')
+            {
+                --last;
+            }
+            uint32_t length = 0;
+            if (std::signbit(value))
+            {
+                out[length++] = '-';
+            }
+            if (exponent < 0)
+            {
+                out[length++] = '0';
+                out[length++] = '.';
+                for (int i = -1; i > exponent; --i)
+                {
+                    out[length++] = '0';
+                }
+                for (int i = 0; i < last; ++i)
+                {
+                    out[length++] = text[i];
+                }
+                return length;
+            }
+            for (int i = 0; i < last; ++i)
+            {
+                if (i == exponent + 1)
+                {
+                    out[length++] = '.';
+                }
+                out[length++] = text[i];
+            }
+            return length;
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_floating_point<T>::value, uint32_t>::type
+        formatValue(char* out, T value, int precision)
+        {
+            if (value == 0 && precision > 0)
+            {
+                uint32_t length = 0;
+                if (std::signbit(value))
+                {
+                    out[length++] = '-';
+                }
+                out[length++] = '0';
+                return length;
+            }
+            const uint32_t fixed = formatFixed(out, static_cast<double>(value), precision);
+            if (fixed != 0)
+            {
+                return fixed;
+            }
+            // More digits than round trip a double only spell out its binary value and would not fit the buffer
+            const int digits = std::min(precision, std::numeric_limits<double>::max_digits10);
+            const int length = std::snprintf(out, FORMAT_CHARS, "%.*g", digits, static_cast<double>(value));
+            return length < 0 ? 0 : std::min(static_cast<uint32_t>(length), FORMAT_CHARS - 1);
+        }
+
+        // 16 bit floats print like the float they convert to
+        template <class T>
+        typename std::enable_if<IsHalf<T>::value, uint32_t>::type formatValue(char* out, T value, int precision)
+        {
+            return formatValue(out, static_cast<float>(value), precision);
+        }
+
+        // Walks the printed elements of a tensor in row major order. With summarization the middle of a long
+        // dimension is replaced by "...". Nesting is tracked by axis number so no strings are built per row.
+        template <class T, uint8_t D>
+        class TensorPrinter
+        {
+            const T* m_data;
+            DimSize_t m_size[D];
+            int64_t m_stride[D];
+            const FormatOptions& m_options;
+            bool m_summarize;
+            uint32_t m_width = 0;
+
+            // Index after which the elements up to the last edge items are skipped, or the size when none are
+            DimSize_t gap(uint8_t axis) const
+            {
+                const DimSize_t edge = m_options.edge_items;
+                return m_summarize && m_size[axis] > 2 * edge ? edge : m_size[axis];
+            }
+
+            void measure(const T* ptr, uint8_t axis)
+            {
+                const DimSize_t skip = gap(axis);
+                for (DimSize_t i = 0; i < m_size[axis]; ++i)
+                {
+                    if (i == skip)
+                    {
+                        // Nothing follows the gap without edge items
+                        i = m_size[axis] - skip;
+                        if (i == m_size[axis])
+                        {
+                            break;
+                        }
+                    }
+                    const T* element = ptr + i * m_stride[axis];
+                    if (axis + 1 < D)
+                    {
+                        measure(element, axis + 1);
+                        continue;
+                    }
+                    char text[FORMAT_CHARS];
+                    const uint32_t length = formatValue(text, *element, m_options.precision);
+                    m_width = length > m_width ? length : m_width;
+                }
+            }
+
+            void separate(std::string& out, uint8_t axis) const
+            {
+                if (axis + 1 == D || m_options.single_line)
+                {
+                    out += ' ';
+                    return;
+                }
+                out.append(D - 1 - axis, '\n');
+                out.append(axis + 1, ' ');
+            }
+
+            void emit(std::string& out, const T* ptr, uint8_t axis) const
+            {
+                out += '[';
+                const DimSize_t skip = gap(axis);
+                for (DimSize_t i = 0; i < m_size[axis]; ++i)
+                {
+                    if (i != 0)
+                    {
+                        separate(out, axis);
+                    }
+                    if (i == skip)
+                    {
+                        out += "...";
+                        i = m_size[axis] - skip;
+                        if (i == m_size[axis])
+                        {
+                            break;
+                        }
+                        separate(out, axis);
+                    }
+                    const T* element = ptr + i * m_stride[axis];
+                    if (axis + 1 < D)
+                    {
+                        emit(out, element, axis + 1);
+                        continue;
+                    }
+                    char text[FORMAT_CHARS];
+                    const uint32_t length = formatValue(text, *element, m_options.precision);
+                    if (length < m_width)
+                    {
+                        out.append(m_width - length, ' ');
+                    }
+                    out.append(text, length);
+                }
+                out += ']';
+            }
+
+          public:
+            TensorPrinter(const Tensor<const T, D>& tensor, const FormatOptions& options)
+                : m_data(tensor.data()), m_options(options)
+            {
+                const Shape<D> shape = tensor.getShape();
+                for (uint8_t d = 0; d < D; ++d)
+                {
+                    m_size[d] = shape[d];
+                    m_stride[d] = static_cast<Stride_t>(shape.getStride(d));
+                }
+                m_summarize = options.summarize && shape.numElements() > options.threshold;
+            }
+
+            void append(std::string& out)
+            {
+                if (!m_options.single_line)
+                {
+                    measure(m_data, 0);
+                }
+                emit(out, m_data, 0);
+            }
+        };
+    } // namespace detail
+
+    // Formats tensors in the layout of numpy's str(), for example [[0 1]\n [2 3]], into a buffer that is reused
+    // between calls so formatting repeatedly does not allocate. operator<< keeps its own layout.
+    class TensorFormatter
+    {
+        FormatOptions m_options;
+        std::string m_buffer;
+
+      public:
+        explicit TensorFormatter(const FormatOptions& options = FormatOptions()) : m_options(options) {}
+
+        FormatOptions& options() { return m_options; }
+        const FormatOptions& options() const { return m_options; }
+
+        // The text stays valid until the next call
+        template <class T, uint8_t D>
+        const std::string& format(const Tensor<T, D>& tensor)
+        {
+            m_buffer.clear();
+            append(m_buffer, tensor);
+            return m_buffer;
+        }
+
+        template <class T, uint8_t D>
+        void append(std::string& out, const Tensor<T, D>& tensor) const
+        {
+            typedef typename std::remove_const<T>::type DType;
+            detail::TensorPrinter<DType, D> printer(Tensor<const DType, D>(tensor.data(), tensor.getShape()),
+                                                    m_options);
+            printer.append(out);
+        }
+
+        template <class T>
+        void append(std::string& out, const Tensor<T, 0>& tensor) const
+        {
+            char text[detail::FORMAT_CHARS];
+            out.append(text, detail::formatValue(text, *tensor.data(), m_options.precision));
+        }
+    };
+
+    template <class T, uint8_t D>
+    std::string format(const Tensor<T, D>& tensor, const FormatOptions& options = FormatOptions())
+    {
+        std::string out;
+        TensorFormatter(options).append(out, tensor);
+        return out;
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_FORMAT_HPP
@@ -0,0 +1,425 @@
+#ifndef MINITENSOR_GENERATE_HPP
+#define MINITENSOR_GENERATE_HPP
+#include "Half.hpp"
+#include "LoopNest.hpp"
+#include "Simd.hpp"
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+#include <assert.h>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+// Writing values that are a function of the element index. Each element depends on nothing but its row major
+// index in the logical shape of the destination, so the result is the same for any stride, thread count and
+// instruction set.
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    namespace detail
+    {
+        // Rows are produced this many elements at a time, strided rows through a buffer of that size
+        static constexpr const uint32_t GENERATE_CHUNK = 256;
+
+        // Calls fn(T* out, uint64_t index, int64_t index_step, uint32_t n) to write n dense values for the
+        // elements with the indices index, index + index_step, ... where the index of an element is its offset
+        // in index_shape, a shape with the sizes of dst
+        template <class T, uint8_t D, class F>
+        void generate(Tensor<T, D> dst, const Shape<D>& index_shape, const F& fn, ThreadPool* pool, uint64_t grain)
+        {
+            const Shape<D> shape = dst.getShape();
+            const LoopNest<D, 2> loop(shape, index_shape);
+            const int64_t step = loop.innerStride(0);
+            const int64_t index_step = loop.innerStride(1);
+            T* ptr = dst.data();
+            auto row = [ptr, step, index_step, &fn](const int64_t* offsets, uint32_t n) {
+                T* out = ptr + offsets[0];
+                T chunk[GENERATE_CHUNK];
+                for (uint32_t begin = 0; begin < n; begin += GENERATE_CHUNK)
+                {
+                    const uint32_t count = n - begin < GENERATE_CHUNK ? n - begin : GENERATE_CHUNK;
+                    const uint64_t index = static_cast<uint64_t>(offsets[1] + begin * index_step);
+                    if (step == 1)
+                    {
+                        fn(out + begin, index, index_step, count);
+                        continue;
+                    }
+                    fn(static_cast<T*>(chunk), index, index_step, count);
+                    copyRow<T>(chunk, 1, out + begin * step, step, count);
+                }
+            };
+            if (pool == nullptr)
+            {
+                loop.forEachRow(row);
+                return;
+            }
+            pool->parallelFor(0, loop.numElements(), grain, [&loop, &row](uint64_t begin, uint64_t end) {
+                loop.forEachRow(begin, end, row);
+            });
+        }
+
+        // Integers count in their own type and wrap like repeated addition would, floating point values are
+        // computed as start + step * index in double so every element is rounded once
+        template <class T>
+        struct IotaWork
+        {
+            typedef typename std::conditional<std::is_integral<T>::value, T, double>::type type;
+        };
+
+        // The type the arithmetic runs in. Integers use an unsigned type no narrower than unsigned int, where
+        // wrapping is defined and small types are not promoted to int, and are converted back at the end.
+        template <class T, bool = std::is_integral<T>::value>
+        struct IotaCount
+        {
+            typedef double type;
+        };
+
+        template <class T>
+        struct IotaCount<T, true>
+        {
+            typedef typename std::conditional<(sizeof(T) < sizeof(unsigned)),
+                                              unsigned,
+                                              typename std::make_unsigned<T>::type>::type type;
+        };
+
+        template <class T>
+        MT_SIMD_VECTORIZE void
+        iotaRow(T* __restrict out, typename IotaWork<T>::type start, typename IotaWork<T>::type step, uint64_t index,
+                int64_t index_step, uint32_t n)
+        {
+            typedef typename IotaCount<T>::type W;
+            const W base = static_cast<W>(static_cast<W>(start) + static_cast<W>(step) * static_cast<W>(index));
+            const W delta = static_cast<W>(static_cast<W>(step) * static_cast<W>(index_step));
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                out[i] = static_cast<T>(base + delta * static_cast<W>(i));
+            }
+        }
+    } // namespace detail
+
+    // dst[i] = start + step * i where i is the row major index of the element, like std::iota on a dense
+    // tensor. Integer values wrap around.
+    template <class T, uint8_t D>
+    void iota(Tensor<T, D> dst,
+              typename detail::IotaWork<T>::type start = 0,
+              typename detail::IotaWork<T>::type step = 1,
+              ThreadPool* pool = nullptr,
+              uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(!std::is_same<T, bool>::value, "iota needs arithmetic");
+        Shape<D> index_shape = dst.getShape();
+        index_shape.calculateStride();
+        auto row = [start, step](T* out, uint64_t index, int64_t index_step, uint32_t n) {
+            detail::iotaRow<T>(out, start, step, index, index_step, n);
+        };
+        detail::generate(dst, index_shape, row, pool, grain);
+    }
+
+    // dst[..., i, ...] = start + step * i where i is the index along dim, for example the x coordinate of
+    // every pixel with dim = 1 of a HW grid
+    template <class T, uint8_t D>
+    void iotaAlong(Tensor<T, D> dst,
+                   uint8_t dim,
+                   typename detail::IotaWork<T>::type start = 0,
+                   typename detail::IotaWork<T>::type step = 1,
+                   ThreadPool* pool = nullptr,
+                   uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(!std::is_same<T, bool>::value, "iota needs arithmetic");
+        assert(dim < D);
+        Shape<D> index_shape = dst.getShape();
+        for (uint8_t d = 0; d < D; ++d)
+        {
+            index_shape.setStride(d, d == dim ? 1 : 0);
+        }
+        auto row = [start, step](T* out, uint64_t index, int64_t index_step, uint32_t n) {
+            detail::iotaRow<T>(out, start, step, index, index_step, n);
+        };
+        detail::generate(dst, index_shape, row, pool, grain);
+    }
+
+    namespace detail
+    {
+        // Philox4x32-10 of Salmon et al., "Parallel random numbers: as easy as 1, 2, 3". A counter based generator,
+        // the 128 bits of block c are a keyed hash of c that passes BigCrush, so any block can be computed on its
+        // own. Random values take the words of the blocks in order, a word w coming from block w / 4.
+        struct Philox
+        {
+            static constexpr const uint32_t M0 = 0xD2511F53;
+            static constexpr const uint32_t M1 = 0xCD9E8D57;
+            static constexpr const uint32_t W0 = 0x9E3779B9;
+            static constexpr const uint32_t W1 = 0xBB67AE85;
+
+            static MT_XINLINE void
+            round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t& k0, uint32_t& k1)
+            {
+                const uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+                const uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+                c0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                c2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                c1 = static_cast<uint32_t>(p1);
+                c3 = static_cast<uint32_t>(p0);
+                k0 += W0;
+                k1 += W1;
+            }
+
+            // Encrypts the 128 bit counter c with the 64 bit key k in place
+            static MT_XINLINE void block(uint32_t (&c)[4], uint32_t k0, uint32_t k1)
+            {
+                for (int r = 0; r < 10; ++r)
+                {
+                    round(c[0], c[1], c[2], c[3], k0, k1);
+                }
+            }
+        };
+
+        // Writes the 4 * count words of the blocks first to first + count - 1 of the stream of seed
+        using PhiloxKernel = void (*)(uint64_t first, uint32_t count, uint64_t seed, uint32_t* out);
+
+        inline void philoxScalar(uint64_t first, uint32_t count, uint64_t seed, uint32_t* out)
+        {
+            for (uint32_t b = 0; b < count; ++b)
+            {
+                const uint64_t counter = first + b;
+                uint32_t c[4] = {static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), 0, 0};
+                Philox::block(c, static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32));
+                for (int i = 0; i < 4; ++i)
+                {
+                    out[4 * b + i] = c[i];
+                }
+            }
+        }
+
+#if MT_SIMD_X86
+        // The zero masked form, the plain intrinsic starts from an undefined vector that GCC warns about
+        MT_SIMD_TARGET_AVX512 inline __m512i mulEpu32AVX512(__m512i a, __m512i b)
+        {
+            return _mm512_maskz_mul_epu32(0xFF, a, b);
+        }
+
+// Blocks are computed BYTES / 8 at a time, one per 64 bit lane. The words of a block sit in the low halves of the
+// lanes, the widening multiplies of the rounds only read those so the high halves are left as they come.
+#define MT_PHILOX_KERNEL(NAME, TARGET, BYTES, INT, MUL)                                                               \
+    TARGET MT_SIMD_FLATTEN inline void NAME(uint64_t first, uint32_t count, uint64_t seed, uint32_t* out)              \
+    {                                                                                                                  \
+        typedef typename Vector<uint64_t, BYTES>::type V;                                                              \
+        const uint32_t lanes = BYTES / 8;                                                                              \
+        const V zero = {};                                                                                             \
+        const V m0 = zero + Philox::M0;                                                                                \
+        const V m1 = zero + Philox::M1;                                                                                \
+        V lane = zero;                                                                                                 \
+        for (uint32_t l = 0; l < lanes; ++l)                                                                           \
+        {                                                                                                              \
+            lane[l] = l;                                                                                               \
+        }                                                                                                              \
+        uint32_t b = 0;                                                                                                \
+        for (; b + lanes <= count; b += lanes)                                                                         \
+        {                                                                                                              \
+            const V counter = lane + (first + b);                                                                      \
+            V c0 = counter;                                                                                            \
+            V c1 = counter >> 32;                                                                                      \
+            V c2 = zero;                                                                                               \
+            V c3 = zero;                                                                                               \
+            uint64_t k0 = static_cast<uint32_t>(seed);                                                                 \
+            uint64_t k1 = seed >> 32;                                                                                  \
+            for (int r = 0; r < 10; ++r)                                                                               \
+            {                                                                                                          \
+                const V p0 = (V)MUL((INT)c0, (INT)m0);                                                                 \
+                const V p1 = (V)MUL((INT)c2, (INT)m1);                                                                 \
+                c0 = (p1 >> 32) ^ c1 ^ k0;                                                                             \
+                c2 = (p0 >> 32) ^ c3 ^ k1;                                                                             \
+                c1 = p1;                                                                                               \
+                c3 = p0;                                                                                               \
+                k0 = static_cast<uint32_t>(k0 + Philox::W0);                                                           \
+                k1 = static_cast<uint32_t>(k1 + Philox::W1);                                                           \
+            }                                                                                                          \
+            for (uint32_t l = 0; l < lanes; ++l)                                                                       \
+            {                                                                                                          \
+                uint32_t* words = out + 4 * (b + l);                                                                   \
+                words[0] = static_cast<uint32_t>(c0[l]);                                                               \
+                words[1] = static_cast<uint32_t>(c1[l]);                                                               \
+                words[2] = static_cast<uint32_t>(c2[l]);                                                               \
+                words[3] = static_cast<uint32_t>(c3[l]);                                                               \
+            }                                                                                                          \
+        }                                                                                                              \
+        philoxScalar(first + b, count - b, seed, out + 4 * b);                                                         \
+    }
+
+        MT_PHILOX_KERNEL(philoxSSE2, MT_SIMD_TARGET_SSE2, 16, __m128i, _mm_mul_epu32)
+        MT_PHILOX_KERNEL(philoxAVX2, MT_SIMD_TARGET_AVX2, 32, __m256i, _mm256_mul_epu32)
+        MT_PHILOX_KERNEL(philoxAVX512, MT_SIMD_TARGET_AVX512, 64, __m512i, mulEpu32AVX512)
+#undef MT_PHILOX_KERNEL
+#endif
+
+        inline PhiloxKernel selectPhilox(SimdIsa isa)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return &philoxAVX512;
+            case SimdIsa::AVX2:
+                return &philoxAVX2;
+            case SimdIsa::SSE2:
+                return &philoxSSE2;
+            default:
+                break;
+            }
+#endif
+            (void)isa;
+            return &philoxScalar;
+        }
+
+        // Floating point values are drawn in Work_t from WORDS words each, integers from one word
+        template <class T, bool = std::is_integral<T>::value>
+        struct RandomTraits
+        {
+            typedef typename std::conditional<sizeof(T) == 8, double, float>::type Work_t;
+            static constexpr const uint32_t WORDS = sizeof(Work_t) / 4;
+
+            // Uniform in [0, 1) with every bit of the mantissa random
+            static MT_XINLINE float unit(const uint32_t* words, float) { return (words[0] >> 8) * (1.0F / 16777216); }
+
+            static MT_XINLINE double unit(const uint32_t* words, double)
+            {
+                const uint64_t bits = (static_cast<uint64_t>(words[1]) << 32) | words[0];
+                return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+            }
+
+            static MT_XINLINE Work_t unit(const uint32_t* words) { return unit(words, Work_t()); }
+        };
+
+        template <class T>
+        struct RandomTraits<T, true>
+        {
+            static constexpr const uint32_t WORDS = 1;
+        };
+
+        // Words of the elements [index, index + n), the stream is aligned down to a multiple of align elements
+        template <class T>
+        const uint32_t* randomWords(PhiloxKernel philox, uint64_t seed, uint64_t index, uint32_t n, uint32_t align,
+                                    uint32_t (&words)[2 * GENERATE_CHUNK + 8])
+        {
+            const uint32_t per = RandomTraits<T>::WORDS;
+            const uint64_t first_word = (index - index % align) * per;
+            const uint64_t end_word = (index + n) * per;
+            const uint64_t first_block = first_word / 4;
+            const uint32_t blocks = static_cast<uint32_t>((end_word - first_block * 4 + 3) / 4);
+            philox(first_block, blocks, seed, words);
+            return words + (first_word - first_block * 4);
+        }
+
+        template <class T, bool = std::is_integral<T>::value>
+        struct UniformRow
+        {
+            typedef typename RandomTraits<T>::Work_t W;
+            W low;
+            W range;
+
+            UniformRow(T low_, T high_) : low(static_cast<W>(low_)), range(static_cast<W>(high_) - low) {}
+
+            void operator()(T* __restrict out, const uint32_t* __restrict words, uint32_t n) const
+            {
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    out[i] = static_cast<T>(low + range * RandomTraits<T>::unit(words + i * RandomTraits<T>::WORDS));
+                }
+            }
+        };
+
+        // Multiply shift of Lemire, "Fast random integer generation in an interval", without the rejection step.
+        // The bias is at most range / 2^32.
+        template <class T>
+        struct UniformRow<T, true>
+        {
+            T low;
+            uint64_t range;
+
+            // The difference wraps into the right unsigned value for signed types too
+            UniformRow(T low_, T high_) : low(low_), range(static_cast<uint64_t>(high_) - static_cast<uint64_t>(low_))
+            {
+                assert(high_ > low_ && range <= (uint64_t(1) << 32));
+            }
+
+            void operator()(T* __restrict out, const uint32_t* __restrict words, uint32_t n) const
+            {
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    out[i] = static_cast<T>(static_cast<uint64_t>(low) + ((words[i] * range) >> 32));
+                }
+            }
+        };
+    } // namespace detail
+
+    // Sets dst to values uniformly distributed in [low, high), drawn from the Philox stream of seed. Integer
+    // ranges are limited to 2^32 values.
+    template <class T, uint8_t D>
+    void randomUniform(Tensor<T, D> dst,
+                       const typename std::common_type<T>::type& low,
+                       const typename std::common_type<T>::type& high,
+                       uint64_t seed,
+                       ThreadPool* pool = nullptr,
+                       uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(!std::is_same<T, bool>::value, "bool has no range");
+        const detail::UniformRow<T> uniform(low, high);
+        const detail::PhiloxKernel philox = detail::selectPhilox(getSimdIsa());
+        Shape<D> index_shape = dst.getShape();
+        index_shape.calculateStride();
+        auto row = [philox, seed, &uniform](T* out, uint64_t index, int64_t, uint32_t n) {
+            uint32_t words[2 * detail::GENERATE_CHUNK + 8];
+            uniform(out, detail::randomWords<T>(philox, seed, index, n, 1, words), n);
+        };
+        detail::generate(dst, index_shape, row, pool, grain);
+    }
+
+    // Sets dst to normally distributed values with mean and stddev, drawn from the Philox stream of seed with the
+    // Box-Muller transform. Elements 2k and 2k + 1 are the cosine and sine of one pair of uniform values.
+    template <class T, uint8_t D>
+    void randomNormal(Tensor<T, D> dst,
+                      const typename std::common_type<T>::type& mean,
+                      const typename std::common_type<T>::type& stddev,
+                      uint64_t seed,
+                      ThreadPool* pool = nullptr,
+                      uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(std::is_floating_point<T>::value || IsHalf<T>::value, "Normal values need floating point");
+        typedef typename detail::RandomTraits<T>::Work_t W;
+        const W mu = static_cast<W>(mean);
+        const W sigma = static_cast<W>(stddev);
+        const detail::PhiloxKernel philox = detail::selectPhilox(getSimdIsa());
+        Shape<D> index_shape = dst.getShape();
+        index_shape.calculateStride();
+        auto row = [philox, seed, mu, sigma](T* out, uint64_t index, int64_t, uint32_t n) {
+            const uint32_t per = detail::RandomTraits<T>::WORDS;
+            uint32_t words[2 * detail::GENERATE_CHUNK + 8];
+            const uint32_t* pairs = detail::randomWords<T>(philox, seed, index, n, 2, words);
+            // Element i of the row is element i + odd of the pairs, a row may start and end with half a pair
+            const uint32_t odd = index % 2;
+            for (uint32_t pair = 0; 2 * pair < n + odd; ++pair)
+            {
+                // The first uniform is in (0, 1] so its log is finite
+                const W u = 1 - detail::RandomTraits<T>::unit(pairs + 2 * per * pair);
+                const W v = detail::RandomTraits<T>::unit(pairs + 2 * per * pair + per);
+                const W radius = sigma * std::sqrt(-2 * std::log(u));
+                const W angle = static_cast<W>(6.283185307179586476925) * v;
+                const uint32_t i = 2 * pair - odd;
+                if (pair != 0 || odd == 0)
+                {
+                    out[i] = static_cast<T>(mu + radius * std::cos(angle));
+                }
+                if (i + 1 < n)
+                {
+                    out[i + 1] = static_cast<T>(mu + radius * std::sin(angle));
+                }
+            }
+        };
+        detail::generate(dst, index_shape, row, pool, grain);
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_GENERATE_HPP
@@ -0,0 +1,324 @@
+#ifndef MINITENSOR_HALF_HPP
+#define MINITENSOR_HALF_HPP
+#include "Simd.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    namespace detail
+    {
+        inline uint32_t floatBits(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        inline float bitsFloat(uint32_t bits)
+        {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // IEEE binary16 with round to nearest even. Overflow gives infinity and NaN stays a quiet NaN.
+        inline uint16_t floatToHalfBits(float value)
+        {
+            uint32_t bits = floatBits(value);
+            const uint32_t sign = (bits >> 16) & 0x8000;
+            bits &= 0x7FFFFFFF;
+            uint32_t out;
+            if (bits >= 0x47800000)
+            {
+                // 65536 and above, infinity or NaN
+                out = bits > 0x7F800000 ? 0x7E00 : 0x7C00;
+            }
+            else if (bits < 0x38800000)
+            {
+                // Below the smallest normal half, adding 0.5 lets the fpu round the mantissa into place
+                const float denormal = bitsFloat(bits) + 0.5F;
+                out = floatBits(denormal) - 0x3F000000;
+            }
+            else
+            {
+                // Rebias the exponent and round the 13 dropped mantissa bits, a carry moves into the exponent
+                const uint32_t odd = (bits >> 13) & 1;
+                bits += 0xC8000FFF + odd;
+                out = bits >> 13;
+            }
+            return static_cast<uint16_t>(sign | out);
+        }
+
+        inline float halfBitsToFloat(uint16_t half)
+        {
+            const uint32_t exponent_mask = 0x7C00 << 13;
+            uint32_t bits = (half & 0x7FFFu) << 13;
+            const uint32_t exponent = bits & exponent_mask;
+            bits += (127 - 15) << 23;
+            float out;
+            if (exponent == exponent_mask)
+            {
+                // Infinity or NaN
+                bits += (128 - 16) << 23;
+                out = bitsFloat(bits);
+            }
+            else if (exponent == 0)
+            {
+                // Subnormal, renormalized by the fpu
+                bits += 1 << 23;
+                out = bitsFloat(bits) - bitsFloat(113 << 23);
+            }
+            else
+            {
+                out = bitsFloat(bits);
+            }
+            return bitsFloat(floatBits(out) | (static_cast<uint32_t>(half & 0x8000) << 16));
+        }
+
+        // Upper half of a float rounded to nearest even, NaN stays a quiet NaN
+        inline uint16_t floatToBFloatBits(float value)
+        {
+            const uint32_t bits = floatBits(value);
+            if ((bits & 0x7FFFFFFF) > 0x7F800000)
+            {
+                return static_cast<uint16_t>((bits >> 16) | 0x40);
+            }
+            return static_cast<uint16_t>((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+        }
+
+        inline float bfloatBitsToFloat(uint16_t bfloat) { return bitsFloat(static_cast<uint32_t>(bfloat) << 16); }
+    } // namespace detail
+
+    // 16 bit storage types for activations and embeddings. Values convert implicitly to and from float, where
+    // all arithmetic happens. Both are trivially copyable so they work as T of Tensor<T, D> and TensorBuffer.
+
+    // IEEE 754 binary16, 5 exponent and 10 mantissa bits
+    struct float16
+    {
+        uint16_t bits;
+
+        float16() = default;
+        float16(float value) : bits(detail::floatToHalfBits(value)) {}
+
+        static float16 fromBits(uint16_t bits)
+        {
+            float16 out;
+            out.bits = bits;
+            return out;
+        }
+
+        operator float() const { return detail::halfBitsToFloat(bits); }
+    };
+
+    // Upper 16 bits of a float, 8 exponent and 7 mantissa bits
+    struct bfloat16
+    {
+        uint16_t bits;
+
+        bfloat16() = default;
+        bfloat16(float value) : bits(detail::floatToBFloatBits(value)) {}
+
+        static bfloat16 fromBits(uint16_t bits)
+        {
+            bfloat16 out;
+            out.bits = bits;
+            return out;
+        }
+
+        operator float() const { return detail::bfloatBitsToFloat(bits); }
+    };
+
+    template <class T>
+    struct IsHalf : std::integral_constant<bool,
+                                           std::is_same<typename std::remove_const<T>::type, float16>::value ||
+                                               std::is_same<typename std::remove_const<T>::type, bfloat16>::value>
+    {
+    };
+
+    namespace detail
+    {
+        // Bulk conversions of n dense elements
+        template <class S, class T>
+        using BulkConvert = void (*)(const S* in, T* out, uint32_t n);
+
+        template <class S, class T>
+        void bulkConvertScalar(const S* in, T* out, uint32_t n)
+        {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                out[i] = static_cast<T>(in[i]);
+            }
+        }
+
+#if MT_SIMD_X86
+        // float16 uses the F16C conversion instructions, AVX-512F has 16 lane versions of them. The zero masked forms
+        // keep GCC from warning about the undefined upper part of the unmasked ones.
+        MT_SIMD_TARGET_AVX512 inline void halfToFloatAVX512(const float16* in, float* out, uint32_t n)
+        {
+            uint32_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m256i half = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                _mm512_storeu_ps(out + i, _mm512_maskz_cvtph_ps(0xFFFF, half));
+            }
+            bulkConvertScalar(in + i, out + i, n - i);
+        }
+
+        MT_SIMD_TARGET_AVX512 inline void floatToHalfAVX512(const float* in, float16* out, uint32_t n)
+        {
+            uint32_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m512 x = _mm512_loadu_ps(in + i);
+                const __m256i half = _mm512_maskz_cvtps_ph(0xFFFF, x, _MM_FROUND_TO_NEAREST_INT);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), half);
+            }
+            bulkConvertScalar(in + i, out + i, n - i);
+        }
+
+        MT_SIMD_TARGET_F16C inline void halfToFloatF16C(const float16* in, float* out, uint32_t n)
+        {
+            uint32_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                _mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+            }
+            bulkConvertScalar(in + i, out + i, n - i);
+        }
+
+        MT_SIMD_TARGET_F16C inline void floatToHalfF16C(const float* in, float16* out, uint32_t n)
+        {
+            uint32_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), half);
+            }
+            bulkConvertScalar(in + i, out + i, n - i);
+        }
+
+        inline bool hasF16C()
+        {
+            static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("f16c"));
+            return supported;
+        }
+
+// bfloat16 only needs integer arithmetic, the same code is compiled for every instruction set
+#define MT_BFLOAT_KERNELS(SUFFIX, TARGET, BYTES)                                                                       \
+    TARGET MT_SIMD_FLATTEN inline void bfloatToFloat##SUFFIX(const bfloat16* in, float* out, uint32_t n)              \
+    {                                                                                                                  \
+        typedef Vector<uint16_t, BYTES / 2>::type V16;                                                                 \
+        typedef Vector<uint32_t, BYTES>::type V32;                                                                     \
+        const uint32_t lanes = BYTES / 4;                                                                              \
+        uint32_t i = 0;                                                                                                \
+        for (; i + lanes <= n; i += lanes)                                                                             \
+        {                                                                                                              \
+            V16 x;                                                                                                     \
+            load(x, in + i);                                                                                           \
+            const V32 bits = __builtin_convertvector(x, V32) << 16;                                                    \
+            store(out + i, bits);                                                                                      \
+        }                                                                                                              \
+        bulkConvertScalar(in + i, out + i, n - i);                                                                     \
+    }                                                                                                                  \
+    TARGET MT_SIMD_FLATTEN inline void floatToBFloat##SUFFIX(const float* in, bfloat16* out, uint32_t n)              \
+    {                                                                                                                  \
+        typedef Vector<uint16_t, BYTES / 2>::type V16;                                                                 \
+        typedef Vector<uint32_t, BYTES>::type V32;                                                                     \
+        const uint32_t lanes = BYTES / 4;                                                                              \
+        uint32_t i = 0;                                                                                                \
+        for (; i + lanes <= n; i += lanes)                                                                             \
+        {                                                                                                              \
+            V32 bits;                                                                                                  \
+            load(bits, in + i);                                                                                        \
+            const V32 rounded = (bits + 0x7FFF + ((bits >> 16) & 1)) >> 16;                                            \
+            const V32 quiet = (bits >> 16) | 0x40;                                                                     \
+            const V32 result = (bits & 0x7FFFFFFF) > 0x7F800000 ? quiet : rounded;                                     \
+            const V16 x = __builtin_convertvector(result, V16);                                                        \
+            store(out + i, x);                                                                                         \
+        }                                                                                                              \
+        bulkConvertScalar(in + i, out + i, n - i);                                                                     \
+    }
+
+        MT_BFLOAT_KERNELS(SSE2, MT_SIMD_TARGET_SSE2, 16)
+        MT_BFLOAT_KERNELS(AVX2, MT_SIMD_TARGET_AVX2, 32)
+        MT_BFLOAT_KERNELS(AVX512, MT_SIMD_TARGET_AVX512, 64)
+#undef MT_BFLOAT_KERNELS
+#endif
+
+        inline BulkConvert<float16, float> selectBulkConvert(SimdIsa isa, const float16*, const float*)
+        {
+#if MT_SIMD_X86
+            if (isa == SimdIsa::AVX512)
+            {
+                return &halfToFloatAVX512;
+            }
+            if (isa == SimdIsa::AVX2 && hasF16C())
+            {
+                return &halfToFloatF16C;
+            }
+#endif
+            return &bulkConvertScalar<float16, float>;
+        }
+
+        inline BulkConvert<float, float16> selectBulkConvert(SimdIsa isa, const float*, const float16*)
+        {
+#if MT_SIMD_X86
+            if (isa == SimdIsa::AVX512)
+            {
+                return &floatToHalfAVX512;
+            }
+            if (isa == SimdIsa::AVX2 && hasF16C())
+            {
+                return &floatToHalfF16C;
+            }
+#endif
+            return &bulkConvertScalar<float, float16>;
+        }
+
+        inline BulkConvert<bfloat16, float> selectBulkConvert(SimdIsa isa, const bfloat16*, const float*)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return &bfloatToFloatAVX512;
+            case SimdIsa::AVX2:
+                return &bfloatToFloatAVX2;
+            case SimdIsa::SSE2:
+                return &bfloatToFloatSSE2;
+            default:
+                break;
+            }
+#endif
+            return &bulkConvertScalar<bfloat16, float>;
+        }
+
+        inline BulkConvert<float, bfloat16> selectBulkConvert(SimdIsa isa, const float*, const bfloat16*)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return &floatToBFloatAVX512;
+            case SimdIsa::AVX2:
+                return &floatToBFloatAVX2;
+            case SimdIsa::SSE2:
+                return &floatToBFloatSSE2;
+            default:
+                break;
+            }
+#endif
+            return &bulkConvertScalar<float, bfloat16>;
+        }
+    } // namespace detail
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_HALF_HPP
@@ -0,0 +1,202 @@
+#ifndef MINITENSOR_LOOP_NEST_HPP
+#define MINITENSOR_LOOP_NEST_HPP
+#include "Shape.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Describes the traversal of K strided operands that share the same logical shape.
+    // Dimensions of size 1 are dropped and adjacent dimensions are merged whenever every operand is
+    // densely packed across them, so two dense tensors collapse into a single 1-D loop. Rows are handed out
+    // at most 2^32 - 1 elements at a time so the row kernels can count with 32 bit integers.
+    template <uint8_t N, uint8_t K>
+    class LoopNest
+    {
+        Array<DimSize_t, N> m_size;
+        Array<int64_t, N> m_stride[K];
+        uint8_t m_dims;
+
+        bool canMerge(const Shape<N>* const* shapes, int16_t dim, uint8_t group) const
+        {
+            if (static_cast<uint64_t>(m_size[group]) * (*shapes[0])[dim] > std::numeric_limits<DimSize_t>::max())
+            {
+                return false;
+            }
+            for (uint8_t k = 0; k < K; ++k)
+            {
+                const int64_t stride = static_cast<Stride_t>(shapes[k]->getStride(dim));
+                if (stride != m_stride[k][group] * static_cast<int64_t>(m_size[group]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void build(const Shape<N>* const* shapes)
+        {
+            // Walk from the innermost dimension outwards, filling the nest back to front
+            uint8_t pos = N;
+            for (int16_t d = N - 1; d >= 0; --d)
+            {
+                const DimSize_t size = (*shapes[0])[d];
+                if (size == 1)
+                {
+                    continue;
+                }
+                if (pos != N && canMerge(shapes, d, pos))
+                {
+                    m_size[pos] *= size;
+                    continue;
+                }
+                --pos;
+                m_size[pos] = size;
+                for (uint8_t k = 0; k < K; ++k)
+                {
+                    m_stride[k][pos] = static_cast<Stride_t>(shapes[k]->getStride(d));
+                }
+            }
+            if (pos == N)
+            {
+                // Every dimension had size 1, a single element remains
+                --pos;
+                m_size[pos] = 1;
+                for (uint8_t k = 0; k < K; ++k)
+                {
+                    m_stride[k][pos] = 1;
+                }
+            }
+            m_dims = N - pos;
+            for (uint8_t i = 0; i < m_dims; ++i)
+            {
+                m_size[i] = m_size[i + pos];
+                for (uint8_t k = 0; k < K; ++k)
+                {
+                    m_stride[k][i] = m_stride[k][i + pos];
+                }
+            }
+        }
+
+      public:
+        template <class... SHAPES>
+        LoopNest(const Shape<N>& shape, const SHAPES&... shapes)
+        {
+            static_assert(sizeof...(SHAPES) + 1 == K, "One shape is required per operand");
+            const Shape<N>* const all[K] = {&shape, &shapes...};
+            build(all);
+        }
+
+        // shapes points to one shape per operand
+        explicit LoopNest(const Shape<N>* const* shapes) { build(shapes); }
+
+        // Number of loops left after merging, the innermost loop is dims() - 1
+        uint8_t dims() const { return m_dims; }
+
+        DimSize_t size(uint8_t dim) const { return m_size[dim]; }
+
+        int64_t stride(uint8_t operand, uint8_t dim) const { return m_stride[operand][dim]; }
+
+        DimSize_t innerSize() const { return m_size[m_dims - 1]; }
+
+        int64_t innerStride(uint8_t operand) const { return m_stride[operand][m_dims - 1]; }
+
+        size_t numElements() const
+        {
+            size_t size = 1;
+            for (uint8_t i = 0; i < m_dims; ++i)
+            {
+                size *= m_size[i];
+            }
+            return size;
+        }
+
+        // Calls fn(const int64_t* offsets, uint32_t n) once per innermost row, where offsets[k] is the element
+        // offset of the first element of the row within operand k. The outer dimensions are walked with
+        // carry propagating counters so no division is needed. Longer rows are split into several calls.
+        template <class F>
+        void forEachRow(F&& fn) const
+        {
+            forEachRow(0, numElements(), std::forward<F>(fn));
+        }
+
+        // Same as forEachRow(fn) restricted to the elements [begin, end) in row major order, the first and last
+        // rows may be partial. Disjoint ranges can be processed concurrently.
+        template <class F>
+        void forEachRow(uint64_t begin, uint64_t end, F&& fn) const
+        {
+            if (begin >= end)
+            {
+                return;
+            }
+            const int16_t inner = static_cast<int16_t>(m_dims) - 1;
+            const DimSize_t inner_size = innerSize();
+            DimSize_t counter[N] = {};
+            int64_t offset[K] = {};
+            uint64_t index = begin;
+            for (int16_t d = inner; d >= 0; --d)
+            {
+                counter[d] = static_cast<DimSize_t>(index % m_size[d]);
+                index /= m_size[d];
+                for (uint8_t k = 0; k < K; ++k)
+                {
+                    offset[k] += m_stride[k][d] * counter[d];
+                }
+            }
+            uint64_t remaining = end - begin;
+            while (true)
+            {
+                uint64_t left = inner_size - counter[inner];
+                left = left < remaining ? left : remaining;
+                const uint64_t max_row = std::numeric_limits<uint32_t>::max();
+                const uint32_t n = static_cast<uint32_t>(left < max_row ? left : max_row);
+                fn(static_cast<const int64_t*>(offset), n);
+                remaining -= n;
+                if (remaining == 0)
+                {
+                    return;
+                }
+                if (n == max_row && counter[inner] + n < inner_size)
+                {
+                    // Rest of a row longer than a 32 bit count
+                    for (uint8_t k = 0; k < K; ++k)
+                    {
+                        offset[k] += m_stride[k][inner] * n;
+                    }
+                    counter[inner] += n;
+                    continue;
+                }
+                // Rewind the row and carry into the outer dimensions
+                for (uint8_t k = 0; k < K; ++k)
+                {
+                    offset[k] -= m_stride[k][inner] * counter[inner];
+                }
+                counter[inner] = 0;
+                for (int16_t d = inner - 1; d >= 0; --d)
+                {
+                    for (uint8_t k = 0; k < K; ++k)
+                    {
+                        offset[k] += m_stride[k][d];
+                    }
+                    if (++counter[d] < m_size[d])
+                    {
+                        break;
+                    }
+                    counter[d] = 0;
+                    for (uint8_t k = 0; k < K; ++k)
+                    {
+                        offset[k] -= m_stride[k][d] * m_size[d];
+                    }
+                }
+            }
+        }
+    };
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_LOOP_NEST_HPP
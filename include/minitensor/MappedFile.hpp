@@ -0,0 +1,494 @@
+#ifndef MINITENSOR_MAPPED_FILE_HPP
+#define MINITENSOR_MAPPED_FILE_HPP
+#include "DType.hpp"
+#include "Tensor.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    enum class MapMode : uint8_t
+    {
+        // Pages are shared with the file and may not be written
+        ReadOnly,
+        // Writes go to private copies of the touched pages, the file is never modified
+        CopyOnWrite,
+        // Writes go to the file
+        ReadWrite
+    };
+
+    // Maps a whole file into memory with POSIX mmap. Pages are only read from disk when first touched and
+    // read only pages can be dropped and reread by the kernel, so large files cost little resident memory.
+    // Failures throw std::runtime_error.
+    class MappedFile
+    {
+        uint8_t* m_ptr = nullptr;
+        size_t m_size = 0;
+        MapMode m_mode = MapMode::ReadOnly;
+
+        static std::runtime_error error(const char* what, const std::string& path)
+        {
+            return std::runtime_error(std::string(what) + " '" + path + "': " + std::strerror(errno));
+        }
+
+        void map(int fd, const std::string& path)
+        {
+            if (m_size == 0)
+            {
+                ::close(fd);
+                return;
+            }
+            const int prot = m_mode == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+            const int flags = m_mode == MapMode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED;
+            void* ptr = ::mmap(nullptr, m_size, prot, flags, fd, 0);
+            // The mapping keeps its own reference to the file
+            ::close(fd);
+            if (ptr == MAP_FAILED)
+            {
+                throw error("Unable to map", path);
+            }
+            m_ptr = static_cast<uint8_t*>(ptr);
+        }
+
+      public:
+        MappedFile() = default;
+
+        MappedFile(const std::string& path, MapMode mode) : m_mode(mode)
+        {
+            const int fd = ::open(path.c_str(), mode == MapMode::ReadWrite ? O_RDWR : O_RDONLY);
+            if (fd < 0)
+            {
+                throw error("Unable to open", path);
+            }
+            struct stat info;
+            if (::fstat(fd, &info) != 0)
+            {
+                ::close(fd);
+                throw error("Unable to stat", path);
+            }
+            m_size = static_cast<size_t>(info.st_size);
+            map(fd, path);
+        }
+
+        // Creates or truncates path to bytes zero bytes and maps it for writing
+        static MappedFile create(const std::string& path, size_t bytes)
+        {
+            const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+            {
+                throw error("Unable to create", path);
+            }
+            if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+            {
+                ::close(fd);
+                throw error("Unable to resize", path);
+            }
+            MappedFile out;
+            out.m_size = bytes;
+            out.m_mode = MapMode::ReadWrite;
+            out.map(fd, path);
+            return out;
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) : m_ptr(other.m_ptr), m_size(other.m_size), m_mode(other.m_mode)
+        {
+            other.m_ptr = nullptr;
+            other.m_size = 0;
+        }
+
+        MappedFile& operator=(MappedFile&& other)
+        {
+            if (this != &other)
+            {
+                unmap();
+                m_ptr = other.m_ptr;
+                m_size = other.m_size;
+                m_mode = other.m_mode;
+                other.m_ptr = nullptr;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        ~MappedFile() { unmap(); }
+
+        void unmap()
+        {
+            if (m_ptr != nullptr)
+            {
+                ::munmap(m_ptr, m_size);
+                m_ptr = nullptr;
+                m_size = 0;
+            }
+        }
+
+        // Writes modified pages of a ReadWrite mapping back to the file before returning
+        void flush()
+        {
+            if (m_ptr != nullptr && m_mode == MapMode::ReadWrite && ::msync(m_ptr, m_size, MS_SYNC) != 0)
+            {
+                throw std::runtime_error(std::string("Unable to flush mapping: ") + std::strerror(errno));
+            }
+        }
+
+        MT_XINLINE const uint8_t* data() const { return m_ptr; }
+        MT_XINLINE uint8_t* data() { return m_ptr; }
+        MT_XINLINE size_t size() const { return m_size; }
+        MT_XINLINE MapMode mode() const { return m_mode; }
+    };
+
+    // NumPy dtype string of an element type, for example "<f4" for float
+    template <class T>
+    struct NpyDescr;
+
+#define MT_NPY_DESCR(TYPE, DESCR)                                                                                      \
+    template <>                                                                                                        \
+    struct NpyDescr<TYPE>                                                                                              \
+    {                                                                                                                  \
+        static const char* value() { return DESCR; }                                                                   \
+    };
+
+    MT_NPY_DESCR(bool, "|b1")
+    MT_NPY_DESCR(int8_t, "|i1")
+    MT_NPY_DESCR(uint8_t, "|u1")
+    MT_NPY_DESCR(int16_t, "<i2")
+    MT_NPY_DESCR(uint16_t, "<u2")
+    MT_NPY_DESCR(int32_t, "<i4")
+    MT_NPY_DESCR(uint32_t, "<u4")
+    MT_NPY_DESCR(int64_t, "<i8")
+    MT_NPY_DESCR(uint64_t, "<u8")
+    MT_NPY_DESCR(float, "<f4")
+    MT_NPY_DESCR(double, "<f8")
+    MT_NPY_DESCR(float16, "<f2")
+#undef MT_NPY_DESCR
+
+    // Contents of the header of a .npy file, see numpy.lib.format for the layout
+    struct NpyHeader
+    {
+        std::string descr;
+        bool fortran_order = false;
+        std::vector<uint64_t> shape;
+        // Position of the first element within the file
+        size_t offset = 0;
+
+        // Only little endian and byte sized types can be mapped
+        size_t elementSize() const
+        {
+            if (descr.size() < 3 || (descr[0] == '>' && descr.substr(2) != "1"))
+            {
+                throw std::runtime_error("Unsupported npy dtype '" + descr + "'");
+            }
+            const size_t size = static_cast<size_t>(std::strtoul(descr.c_str() + 2, nullptr, 10));
+            if (size == 0)
+            {
+                throw std::runtime_error("Unsupported npy dtype '" + descr + "'");
+            }
+            return size;
+        }
+
+        // Same kind and size, the byte order characters '<', '|' and '=' are interchangeable
+        bool matches(const char* other) const
+        {
+            return descr.size() >= 2 && std::strlen(other) >= 2 && descr.substr(1) == other + 1;
+        }
+
+        // Throws for shapes whose product does not fit 64 bits, which no file can hold
+        uint64_t numElements() const
+        {
+            if (std::find(shape.begin(), shape.end(), uint64_t(0)) != shape.end())
+            {
+                return 0;
+            }
+            uint64_t out = 1;
+            for (uint64_t size : shape)
+            {
+                if (out > std::numeric_limits<uint64_t>::max() / size)
+                {
+                    throw std::runtime_error("npy shape overflows 64 bits");
+                }
+                out *= size;
+            }
+            return out;
+        }
+    };
+
+    // DType of a NumPy dtype string such as NpyHeader::descr, for mapping files as DynamicTensor
+    inline DType npyDType(const std::string& descr)
+    {
+        static const char* const DESCRS[DTYPE_COUNT] = {NpyDescr<bool>::value(),
+                                                        NpyDescr<int8_t>::value(),
+                                                        NpyDescr<uint8_t>::value(),
+                                                        NpyDescr<int16_t>::value(),
+                                                        NpyDescr<uint16_t>::value(),
+                                                        NpyDescr<int32_t>::value(),
+                                                        NpyDescr<uint32_t>::value(),
+                                                        NpyDescr<int64_t>::value(),
+                                                        NpyDescr<uint64_t>::value(),
+                                                        NpyDescr<float>::value(),
+                                                        NpyDescr<double>::value(),
+                                                        NpyDescr<float16>::value(),
+                                                        nullptr};
+        NpyHeader header;
+        header.descr = descr;
+        for (uint8_t i = 0; i < DTYPE_COUNT; ++i)
+        {
+            // NumPy has no bfloat16
+            if (DESCRS[i] != nullptr && header.matches(DESCRS[i]))
+            {
+                return static_cast<DType>(i);
+            }
+        }
+        throw std::runtime_error("npy dtype '" + descr + "' has no DType");
+    }
+
+    namespace detail
+    {
+        // Position just past "'key':" and any following spaces
+        inline size_t npyField(const std::string& dict, const char* key)
+        {
+            const size_t pos = dict.find(std::string("'") + key + "'");
+            const size_t colon = pos == std::string::npos ? pos : dict.find(':', pos);
+            if (colon == std::string::npos)
+            {
+                throw std::runtime_error(std::string("npy header has no '") + key + "' entry");
+            }
+            return dict.find_first_not_of(' ', colon + 1);
+        }
+    } // namespace detail
+
+    inline NpyHeader parseNpyHeader(const uint8_t* data, size_t size)
+    {
+        if (size < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0)
+        {
+            throw std::runtime_error("Not a npy file");
+        }
+        const uint8_t major = data[6];
+        const size_t prefix = major == 1 ? 10 : 12;
+        if (major < 1 || major > 3 || size < prefix)
+        {
+            throw std::runtime_error("Corrupt npy header");
+        }
+        size_t length = static_cast<size_t>(data[8]) | static_cast<size_t>(data[9]) << 8;
+        if (major != 1)
+        {
+            length |= static_cast<size_t>(data[10]) << 16 | static_cast<size_t>(data[11]) << 24;
+        }
+        if (size - prefix < length)
+        {
+            throw std::runtime_error("Corrupt npy header");
+        }
+        const std::string dict(reinterpret_cast<const char*>(data) + prefix, length);
+        NpyHeader out;
+        out.offset = prefix + length;
+
+        const size_t descr = detail::npyField(dict, "descr") + 1;
+        out.descr = dict.substr(descr, dict.find('\'', descr) - descr);
+        out.fortran_order = dict.compare(detail::npyField(dict, "fortran_order"), 4, "True") == 0;
+
+        size_t pos = detail::npyField(dict, "shape");
+        const size_t end = dict.find(')', pos);
+        if (dict[pos] != '(' || end == std::string::npos)
+        {
+            throw std::runtime_error("Corrupt npy shape");
+        }
+        for (++pos; pos < end; ++pos)
+        {
+            if (dict[pos] >= '0' && dict[pos] <= '9')
+            {
+                char* next = nullptr;
+                out.shape.push_back(std::strtoull(dict.c_str() + pos, &next, 10));
+                pos = static_cast<size_t>(next - dict.c_str());
+            }
+        }
+        return out;
+    }
+
+    // Version 1.0 header padded so the data starts on a 64 byte boundary
+    inline std::string formatNpyHeader(const NpyHeader& header)
+    {
+        std::string dict = "{'descr': '" + header.descr + "', 'fortran_order': ";
+        dict += header.fortran_order ? "True" : "False";
+        dict += ", 'shape': (";
+        for (size_t i = 0; i < header.shape.size(); ++i)
+        {
+            dict += std::to_string(header.shape[i]);
+            dict += header.shape.size() == 1 || i + 1 < header.shape.size() ? "," : "";
+            dict += i + 1 < header.shape.size() ? " " : "";
+        }
+        dict += "), }";
+        const size_t total = (10 + dict.size() + 1 + 63) / 64 * 64;
+        dict.append(total - 10 - dict.size() - 1, ' ');
+        dict += '\n';
+        const size_t length = dict.size();
+        std::string out("\x93NUMPY\x01\x00", 8);
+        out += static_cast<char>(length & 0xFF);
+        out += static_cast<char>(length >> 8);
+        return out + dict;
+    }
+
+    // Owner of a mapped file and the tensor stored in it, views stay valid as long as this object lives.
+    // With T = void the views are type erased and address bytes, like Tensor<void, D>.
+    template <class T, uint8_t D>
+    class MappedTensor
+    {
+        MappedFile m_file;
+        T* m_ptr = nullptr;
+        Shape<D> m_shape;
+        std::string m_descr;
+
+      public:
+        MappedTensor() = default;
+        MappedTensor(MappedFile&& file, size_t offset, const Shape<D>& shape, const std::string& descr)
+            : m_file(std::move(file)), m_ptr(static_cast<T*>(static_cast<void*>(m_file.data() + offset))),
+              m_shape(shape), m_descr(descr)
+        {
+        }
+
+        Tensor<const T, D> view() const { return Tensor<const T, D>(m_ptr, m_shape); }
+
+        // Only valid for CopyOnWrite and ReadWrite mappings, writes through a ReadOnly mapping crash
+        Tensor<T, D> view()
+        {
+            assert(m_file.mode() != MapMode::ReadOnly);
+            return Tensor<T, D>(m_ptr, m_shape);
+        }
+
+        operator Tensor<const T, D>() const { return view(); }
+
+        MT_XINLINE Shape<D> getShape() const { return m_shape; }
+        MT_XINLINE const T* data() const { return m_ptr; }
+        // NumPy dtype string of the elements
+        MT_XINLINE const std::string& descr() const { return m_descr; }
+        MT_XINLINE MappedFile& file() { return m_file; }
+        MT_XINLINE const MappedFile& file() const { return m_file; }
+    };
+
+    namespace detail
+    {
+        // Element shape of an npy header, type erased shapes are scaled to bytes like Tensor<void, D>
+        template <uint8_t D>
+        Shape<D> npyShape(const NpyHeader& header, size_t scale)
+        {
+            if (header.shape.size() != D)
+            {
+                throw std::runtime_error("npy file has " + std::to_string(header.shape.size()) +
+                                         " dimensions, expected " + std::to_string(D));
+            }
+            Shape<D> out;
+            int64_t stride = 1;
+            for (uint8_t k = 0; k < D; ++k)
+            {
+                // Fortran order is column major, the first dimension is the dense one
+                const uint8_t i = header.fortran_order ? k : D - 1 - k;
+                if (header.shape[i] * scale > std::numeric_limits<DimSize_t>::max() ||
+                    static_cast<uint64_t>(stride) * scale > static_cast<uint64_t>(std::numeric_limits<Stride_t>::max()))
+                {
+                    throw std::runtime_error("npy shape does not fit in a Shape, see MT_INDEX_64");
+                }
+                out.setShape(i, static_cast<DimSize_t>(header.shape[i] * scale));
+                out.setStride(i, static_cast<Stride_t>(stride * static_cast<int64_t>(scale)));
+                stride *= static_cast<int64_t>(header.shape[i]);
+            }
+            return out;
+        }
+
+        // Checks the dtype against T, returns the factor applied to the shape
+        template <class T>
+        struct NpyElement
+        {
+            static size_t scale(const NpyHeader& header)
+            {
+                if (!header.matches(NpyDescr<typename std::remove_const<T>::type>::value()))
+                {
+                    throw std::runtime_error("npy dtype '" + header.descr + "' does not match the requested type");
+                }
+                return 1;
+            }
+        };
+
+        template <>
+        struct NpyElement<void>
+        {
+            static size_t scale(const NpyHeader& header) { return header.elementSize(); }
+        };
+
+        template <>
+        struct NpyElement<const void> : NpyElement<void>
+        {
+        };
+    } // namespace detail
+
+    // Maps a .npy file without reading it, the tensor points straight into the mapping. T may be void to
+    // inspect the dtype at runtime through descr(). Fortran ordered files are exposed as column major views.
+    template <class T, uint8_t D>
+    MappedTensor<T, D> mapFile(const std::string& path, MapMode mode = MapMode::ReadOnly)
+    {
+        MappedFile file(path, mode);
+        const NpyHeader header = parseNpyHeader(file.data(), file.size());
+        const size_t element = header.elementSize();
+        if ((file.size() - header.offset) / element < header.numElements())
+        {
+            throw std::runtime_error("npy file '" + path + "' is truncated");
+        }
+        const Shape<D> shape = detail::npyShape<D>(header, detail::NpyElement<T>::scale(header));
+        return MappedTensor<T, D>(std::move(file), header.offset, shape, header.descr);
+    }
+
+    // Maps a file holding a dense row major tensor of shape at offset bytes, without any header
+    template <class T, uint8_t D>
+    MappedTensor<T, D> mapRawFile(const std::string& path,
+                                  Shape<D> shape,
+                                  size_t offset = 0,
+                                  MapMode mode = MapMode::ReadOnly)
+    {
+        static_assert(!std::is_void<T>::value, "Raw files carry no type information");
+        MappedFile file(path, mode);
+        shape.calculateStride();
+        if (file.size() < offset || (file.size() - offset) / sizeof(T) < shape.numElements())
+        {
+            throw std::runtime_error("Raw file '" + path + "' is smaller than the tensor");
+        }
+        return MappedTensor<T, D>(std::move(file), offset, shape, NpyDescr<T>::value());
+    }
+
+    // Creates a .npy file for a dense tensor of shape and maps it for writing, the elements are zero
+    template <class T, uint8_t D>
+    MappedTensor<T, D> createFile(const std::string& path, Shape<D> shape)
+    {
+        NpyHeader header;
+        header.descr = NpyDescr<T>::value();
+        for (uint8_t i = 0; i < D; ++i)
+        {
+            header.shape.push_back(shape[i]);
+        }
+        const std::string prefix = formatNpyHeader(header);
+        shape.calculateStride();
+        MappedFile file = MappedFile::create(path, prefix.size() + shape.numElements() * sizeof(T));
+        std::memcpy(file.data(), prefix.data(), prefix.size());
+        return MappedTensor<T, D>(std::move(file), prefix.size(), shape, header.descr);
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_MAPPED_FILE_HPP
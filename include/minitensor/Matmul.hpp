@@ -0,0 +1,384 @@
+#ifndef MINITENSOR_MATMUL_HPP
+#define MINITENSOR_MATMUL_HPP
+#include "Simd.hpp"
+#include "Tensor.hpp"
+#include "TensorBuffer.hpp"
+#include "ThreadPool.hpp"
+
+#include <assert.h>
+#include <limits>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    namespace detail
+    {
+        // Computes the MR x NR product of a packed panel of A and a packed panel of B into tile, row major with
+        // NR columns. The A panel stores MR values per k and the B panel NR values per k.
+        template <class T>
+        struct GemmKernel
+        {
+            // Upper bound of mr x nr over the kernels
+            static constexpr const uint32_t MAX_TILE = 12 * 2 * 64 / sizeof(T);
+
+            void (*fn)(uint32_t kc, const T* a, const T* b, T* tile);
+            uint32_t mr;
+            uint32_t nr;
+        };
+
+        template <class T, uint32_t MR, uint32_t NR>
+        void gemmScalar(uint32_t kc, const T* a, const T* b, T* tile)
+        {
+            T acc[MR * NR] = {};
+            for (uint32_t k = 0; k < kc; ++k, a += MR, b += NR)
+            {
+                for (uint32_t r = 0; r < MR; ++r)
+                {
+                    for (uint32_t c = 0; c < NR; ++c)
+                    {
+                        acc[r * NR + c] += a[r] * b[c];
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < MR * NR; ++i)
+            {
+                tile[i] = acc[i];
+            }
+        }
+
+#if MT_SIMD_X86
+        // Adds the outer product of MR values of A and two vectors of B to the tile. The rows are unrolled at
+        // compile time, a loop over them keeps the accumulators in memory instead of registers.
+        template <uint32_t R, bool FUSED, size_t BYTES>
+        struct GemmRows
+        {
+            template <class V, class T>
+            static MT_XINLINE void update(V (*acc)[2], const T* a, const V& b0, const V& b1)
+            {
+                GemmRows<R - 1, FUSED, BYTES>::update(acc, a, b0, b1);
+                V ar;
+                for (uint32_t i = 0; i < sizeof(V) / sizeof(T); ++i)
+                {
+                    // Written lane by lane, V() + a would keep an add of zero to preserve its sign
+                    ar[i] = a[R - 1];
+                }
+                if (FUSED)
+                {
+                    FusedMultiplyAdd<T, BYTES>::apply(acc[R - 1][0], ar, b0, acc[R - 1][0]);
+                    FusedMultiplyAdd<T, BYTES>::apply(acc[R - 1][1], ar, b1, acc[R - 1][1]);
+                }
+                else
+                {
+                    acc[R - 1][0] += ar * b0;
+                    acc[R - 1][1] += ar * b1;
+                }
+            }
+        };
+
+        template <bool FUSED, size_t BYTES>
+        struct GemmRows<0, FUSED, BYTES>
+        {
+            template <class V, class T>
+            static MT_XINLINE void update(V (*)[2], const T*, const V&, const V&)
+            {
+            }
+        };
+
+// The tile is held in MR x 2 vector registers, every k loads two vectors of B and broadcasts MR values of A.
+// FUSED selects a single rounding multiply add where the instruction set has one.
+#define MT_GEMM_KERNEL(NAME, TARGET, BYTES, FUSED)                                                                     \
+    template <class T, uint32_t MR>                                                                                    \
+    TARGET MT_SIMD_FLATTEN void NAME(uint32_t kc, const T* a, const T* b, T* tile)                                     \
+    {                                                                                                                  \
+        typedef typename Vector<T, BYTES>::type V;                                                                     \
+        const uint32_t lanes = BYTES / sizeof(T);                                                                      \
+        V acc[MR][2] = {};                                                                                             \
+        for (uint32_t k = 0; k < kc; ++k, a += MR, b += 2 * lanes)                                                     \
+        {                                                                                                              \
+            V b0;                                                                                                      \
+            V b1;                                                                                                      \
+            load(b0, b);                                                                                               \
+            load(b1, b + lanes);                                                                                       \
+            GemmRows<MR, FUSED, BYTES>::update(acc, a, b0, b1);                                                        \
+        }                                                                                                              \
+        for (uint32_t r = 0; r < MR; ++r)                                                                              \
+        {                                                                                                              \
+            store(tile + r * 2 * lanes, acc[r][0]);                                                                    \
+            store(tile + r * 2 * lanes + lanes, acc[r][1]);                                                            \
+        }                                                                                                              \
+    }
+
+        MT_GEMM_KERNEL(gemmSSE2, MT_SIMD_TARGET_SSE2, 16, false)
+        MT_GEMM_KERNEL(gemmAVX2, MT_SIMD_TARGET_AVX2, 32, true)
+        MT_GEMM_KERNEL(gemmAVX512, MT_SIMD_TARGET_AVX512, 64, true)
+#undef MT_GEMM_KERNEL
+#endif
+
+        // Tile sizes leave room in the register file for the two B vectors and the broadcast A value
+        template <class T>
+        GemmKernel<T> selectGemmKernel(SimdIsa isa)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return GemmKernel<T>{&gemmAVX512<T, 12>, 12, 2 * 64 / sizeof(T)};
+            case SimdIsa::AVX2:
+                return GemmKernel<T>{&gemmAVX2<T, 6>, 6, 2 * 32 / sizeof(T)};
+            case SimdIsa::SSE2:
+                return GemmKernel<T>{&gemmSSE2<T, 6>, 6, 2 * 16 / sizeof(T)};
+            default:
+                break;
+            }
+#endif
+            return GemmKernel<T>{&gemmScalar<T, 4, 4>, 4, 4};
+        }
+
+        // Cache blocking: a KC deep panel of B stays in L1 while the kernel streams over a packed block of MC
+        // rows of A held in L2, NC columns of B are packed at once.
+        template <class T>
+        struct GemmBlock
+        {
+            static constexpr const uint32_t KC = 256;
+            static constexpr const uint32_t MC = 96;
+            static constexpr const uint32_t NC = (2 << 20) / (KC * sizeof(T));
+        };
+
+        // Copies rows x kc values of a matrix with strides (row, col) into panels of mr rows, k major within a
+        // panel. Rows past the end are zero so the kernel never needs a partial panel.
+        template <class T>
+        void packPanel(T* dst, const T* src, int64_t row, int64_t col, uint32_t rows, uint32_t kc, uint32_t mr)
+        {
+            // Read along the smaller stride in the inner loop
+            if ((col < 0 ? -col : col) <= (row < 0 ? -row : row))
+            {
+                for (uint32_t r = 0; r < mr; ++r)
+                {
+                    const T* in = src + r * row;
+                    for (uint32_t k = 0; k < kc; ++k)
+                    {
+                        dst[k * mr + r] = r < rows ? in[k * col] : T(0);
+                    }
+                }
+                return;
+            }
+            for (uint32_t k = 0; k < kc; ++k)
+            {
+                const T* in = src + k * col;
+                for (uint32_t r = 0; r < mr; ++r)
+                {
+                    dst[k * mr + r] = r < rows ? in[r * row] : T(0);
+                }
+            }
+        }
+
+        // c = a * b for an m x k matrix a and a k x n matrix b, every operand with arbitrary element strides.
+        // Panels of a and b are packed into contiguous buffers so transposed and strided views are read once
+        // per panel instead of once per multiply. With a pool the packing and the MC x NR output tiles are
+        // divided over its threads.
+        template <class T>
+        void gemm(uint32_t m,
+                  uint32_t n,
+                  uint32_t k,
+                  const T* a,
+                  int64_t a_row,
+                  int64_t a_col,
+                  const T* b,
+                  int64_t b_row,
+                  int64_t b_col,
+                  T* c,
+                  int64_t c_row,
+                  int64_t c_col,
+                  ThreadPool* pool,
+                  uint64_t grain)
+        {
+            if (m == 0 || n == 0)
+            {
+                return;
+            }
+            if (k == 0)
+            {
+                for (uint32_t i = 0; i < m; ++i)
+                {
+                    for (uint32_t j = 0; j < n; ++j)
+                    {
+                        c[i * c_row + j * c_col] = T(0);
+                    }
+                }
+                return;
+            }
+            const GemmKernel<T> kernel = selectGemmKernel<T>(getSimdIsa());
+            const uint32_t mr = kernel.mr;
+            const uint32_t nr = kernel.nr;
+            assert(mr * nr <= GemmKernel<T>::MAX_TILE);
+            const uint32_t mc = GemmBlock<T>::MC / mr * mr;
+            const uint32_t kc_max = k < GemmBlock<T>::KC ? k : GemmBlock<T>::KC;
+            const uint32_t nc_max = n < GemmBlock<T>::NC ? n : GemmBlock<T>::NC;
+            const uint32_t a_panels = (m + mr - 1) / mr;
+            TensorBuffer<T, 1> packed_a(Shape<1>(static_cast<uint32_t>(a_panels * mr * kc_max)));
+            TensorBuffer<T, 1> packed_b(Shape<1>(static_cast<uint32_t>((nc_max + nr - 1) / nr * nr * kc_max)));
+            T* pa = packed_a.data();
+            T* pb = packed_b.data();
+            for (uint32_t jc = 0; jc < n; jc += GemmBlock<T>::NC)
+            {
+                const uint32_t nc = n - jc < GemmBlock<T>::NC ? n - jc : GemmBlock<T>::NC;
+                const uint32_t b_panels = (nc + nr - 1) / nr;
+                for (uint32_t pc = 0; pc < k; pc += GemmBlock<T>::KC)
+                {
+                    const uint32_t kc = k - pc < GemmBlock<T>::KC ? k - pc : GemmBlock<T>::KC;
+                    const bool first = pc == 0;
+                    // Items below a_panels pack a panel of a, the rest a panel of b transposed
+                    auto pack = [=](uint64_t begin, uint64_t end) {
+                        for (uint64_t p = begin; p < end; ++p)
+                        {
+                            if (p < a_panels)
+                            {
+                                const uint32_t i = static_cast<uint32_t>(p) * mr;
+                                const uint32_t rows = m - i < mr ? m - i : mr;
+                                packPanel(pa + p * mr * kc, a + i * a_row + pc * a_col, a_row, a_col, rows, kc, mr);
+                                continue;
+                            }
+                            const uint32_t j = static_cast<uint32_t>(p - a_panels) * nr;
+                            const uint32_t cols = nc - j < nr ? nc - j : nr;
+                            packPanel(pb + (p - a_panels) * nr * kc,
+                                      b + (jc + j) * b_col + pc * b_row,
+                                      b_col,
+                                      b_row,
+                                      cols,
+                                      kc,
+                                      nr);
+                        }
+                    };
+                    // Item w multiplies row block w / b_panels of a with column panel w % b_panels of b
+                    auto multiply = [=](uint64_t begin, uint64_t end) {
+                        T tile[GemmKernel<T>::MAX_TILE];
+                        for (uint64_t w = begin; w < end; ++w)
+                        {
+                            const uint32_t ic = static_cast<uint32_t>(w / b_panels) * mc;
+                            const uint32_t j = static_cast<uint32_t>(w % b_panels) * nr;
+                            const uint32_t cols = nc - j < nr ? nc - j : nr;
+                            const uint32_t block = m - ic < mc ? m - ic : mc;
+                            for (uint32_t i = ic; i < ic + block; i += mr)
+                            {
+                                kernel.fn(kc, pa + i * kc, pb + j * kc, tile);
+                                const uint32_t rows = m - i < mr ? m - i : mr;
+                                for (uint32_t r = 0; r < rows; ++r)
+                                {
+                                    T* out = c + (i + r) * c_row + (jc + j) * c_col;
+                                    const T* in = tile + r * nr;
+                                    for (uint32_t col = 0; col < cols; ++col)
+                                    {
+                                        out[col * c_col] = first ? in[col] : out[col * c_col] + in[col];
+                                    }
+                                }
+                            }
+                        }
+                    };
+                    const uint64_t pack_items = a_panels + b_panels;
+                    const uint64_t items = static_cast<uint64_t>((m + mc - 1) / mc) * b_panels;
+                    if (pool == nullptr)
+                    {
+                        pack(0, pack_items);
+                        multiply(0, items);
+                        continue;
+                    }
+                    const uint64_t panel_size = static_cast<uint64_t>(mr > nr ? mr : nr) * kc;
+                    pool->parallelFor(0, pack_items, grain / panel_size, pack);
+                    // Every multiply add counts as one element of grain
+                    pool->parallelFor(0, items, grain / (static_cast<uint64_t>(mc) * nr * kc), multiply);
+                }
+            }
+        }
+
+        template <class T, class A, class B>
+        void matmul(const Tensor<A, 2>& a, const Tensor<B, 2>& b, Tensor<T, 2> c, ThreadPool* pool, uint64_t grain)
+        {
+            static_assert(std::is_same<typename std::remove_const<A>::type, T>::value &&
+                              std::is_same<typename std::remove_const<B>::type, T>::value,
+                          "Inputs and output must have the same element type");
+            static_assert(std::is_floating_point<T>::value, "matmul supports floating point types");
+            const Shape<2> a_shape = a.getShape();
+            const Shape<2> b_shape = b.getShape();
+            const Shape<2> c_shape = c.getShape();
+            assert(a_shape[1] == b_shape[0]);
+            assert(c_shape[0] == a_shape[0] && c_shape[1] == b_shape[1]);
+            // The blocking works with 32 bit sizes, only the strides of the operands can be larger
+            assert(a_shape[0] <= std::numeric_limits<uint32_t>::max() &&
+                   b_shape[1] <= std::numeric_limits<uint32_t>::max() &&
+                   a_shape[1] <= std::numeric_limits<uint32_t>::max());
+            gemm<T>(static_cast<uint32_t>(a_shape[0]),
+                    static_cast<uint32_t>(b_shape[1]),
+                    static_cast<uint32_t>(a_shape[1]),
+                    a.data(),
+                    static_cast<Stride_t>(a_shape.getStride(0)),
+                    static_cast<Stride_t>(a_shape.getStride(1)),
+                    b.data(),
+                    static_cast<Stride_t>(b_shape.getStride(0)),
+                    static_cast<Stride_t>(b_shape.getStride(1)),
+                    c.data(),
+                    static_cast<Stride_t>(c_shape.getStride(0)),
+                    static_cast<Stride_t>(c_shape.getStride(1)),
+                    pool,
+                    grain);
+        }
+    } // namespace detail
+
+    // c = a * b. Any of the operands may be a strided or transposed view, they are never copied as a whole.
+    // c must not overlap a or b. With a pool the product is computed by all of its threads, results can differ
+    // in the last bits between instruction sets since only some of them fuse the multiply and add.
+    template <class T, class A, class B>
+    void matmul(const Tensor<A, 2>& a,
+                const Tensor<B, 2>& b,
+                Tensor<T, 2> c,
+                ThreadPool* pool = nullptr,
+                uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        detail::matmul(a, b, c, pool, grain);
+    }
+
+    // Batched product over the first dimension, c[i] = a[i] * b[i]. An operand shared by every batch can be
+    // passed through broadcastTo. Batches are divided over the pool when there are enough of them, otherwise
+    // every product is parallelized on its own.
+    template <class T, class A, class B>
+    void matmul(const Tensor<A, 3>& a,
+                const Tensor<B, 3>& b,
+                Tensor<T, 3> c,
+                ThreadPool* pool = nullptr,
+                uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        const DimSize_t batches = c.getShape()[0];
+        assert(a.getShape()[0] == batches && b.getShape()[0] == batches);
+        if (pool == nullptr || batches < pool->concurrency())
+        {
+            for (DimSize_t i = 0; i < batches; ++i)
+            {
+                detail::matmul(a[i], b[i], c[i], pool, grain);
+            }
+            return;
+        }
+        pool->parallelFor(0, batches, 1, [&](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                const DimSize_t batch = static_cast<DimSize_t>(i);
+                detail::matmul(a[batch], b[batch], c[batch], nullptr, grain);
+            }
+        });
+    }
+
+    template <class A, class B, uint8_t D>
+    TensorBuffer<typename std::remove_const<A>::type, D>
+    matmul(const Tensor<A, D>& a, const Tensor<B, D>& b, ThreadPool* pool = nullptr)
+    {
+        Shape<D> shape = a.getShape();
+        shape.setShape(D - 1, b.getShape()[D - 1]);
+        TensorBuffer<typename std::remove_const<A>::type, D> out(shape);
+        matmul(a, b, out.view(), pool);
+        return out;
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_MATMUL_HPP
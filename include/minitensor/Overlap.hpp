@@ -0,0 +1,172 @@
+#ifndef MINITENSOR_OVERLAP_HPP
+#define MINITENSOR_OVERLAP_HPP
+#include "Shape.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // How the memory of two strided views relates
+    enum class Overlap : uint8_t
+    {
+        // No byte is shared
+        None,
+        // Both views address the same element at every index, like an in-place operation
+        Same,
+        // The views may share memory at different indices
+        Partial
+    };
+
+    namespace detail
+    {
+        inline uint64_t gcd(uint64_t a, uint64_t b)
+        {
+            while (b != 0)
+            {
+                const uint64_t r = a % b;
+                a = b;
+                b = r;
+            }
+            return a;
+        }
+
+        // Lowest and one past the highest element offset a view touches, both zero for an empty view
+        template <uint8_t D>
+        void elementExtent(const Shape<D>& shape, int64_t& begin, int64_t& end)
+        {
+            begin = 0;
+            end = 1;
+            for (uint8_t d = 0; d < D; ++d)
+            {
+                if (shape[d] == 0)
+                {
+                    begin = end = 0;
+                    return;
+                }
+                const int64_t stride = static_cast<Stride_t>(shape.getStride(d));
+                const int64_t span = stride * (static_cast<int64_t>(shape[d]) - 1);
+                (span < 0 ? begin : end) += span;
+            }
+        }
+    } // namespace detail
+
+    // Cheap overlap analysis from the base pointers and shapes. Views whose byte ranges are disjoint do not
+    // overlap, neither do views that interleave without meeting, like two channels of one interleaved image:
+    // every element starts on a lattice spaced by the gcd of the strides, so a base offset that keeps the
+    // elements of both views between lattice points is disjoint. Anything else is reported as Partial, which
+    // may be conservative.
+    template <uint8_t D>
+    Overlap
+    memoryOverlap(const void* a, const Shape<D>& a_shape, const void* b, const Shape<D>& b_shape, size_t element_size)
+    {
+        int64_t a_begin;
+        int64_t a_end;
+        int64_t b_begin;
+        int64_t b_end;
+        detail::elementExtent(a_shape, a_begin, a_end);
+        detail::elementExtent(b_shape, b_begin, b_end);
+        if (a_begin == a_end || b_begin == b_end)
+        {
+            return Overlap::None;
+        }
+        const int64_t size = static_cast<int64_t>(element_size);
+        const int64_t delta = static_cast<int64_t>(reinterpret_cast<uintptr_t>(b) - reinterpret_cast<uintptr_t>(a));
+        bool same = delta == 0;
+        uint64_t lattice = 0;
+        for (uint8_t d = 0; d < D; ++d)
+        {
+            const int64_t a_stride = static_cast<Stride_t>(a_shape.getStride(d));
+            const int64_t b_stride = static_cast<Stride_t>(b_shape.getStride(d));
+            same = same && a_shape[d] == b_shape[d] && (a_shape[d] == 1 || a_stride == b_stride);
+            const uint64_t a_step = static_cast<uint64_t>(a_stride < 0 ? -a_stride : a_stride);
+            const uint64_t b_step = static_cast<uint64_t>(b_stride < 0 ? -b_stride : b_stride);
+            lattice = a_shape[d] > 1 ? detail::gcd(lattice, a_step) : lattice;
+            lattice = b_shape[d] > 1 ? detail::gcd(lattice, b_step) : lattice;
+        }
+        if (same)
+        {
+            return Overlap::Same;
+        }
+        // Byte ranges relative to a
+        if (a_end * size <= delta + b_begin * size || delta + b_end * size <= a_begin * size)
+        {
+            return Overlap::None;
+        }
+        if (lattice != 0)
+        {
+            const int64_t spacing = static_cast<int64_t>(lattice) * size;
+            const int64_t phase = ((delta % spacing) + spacing) % spacing;
+            if (phase >= size && spacing - phase >= size)
+            {
+                return Overlap::None;
+            }
+        }
+        return Overlap::Partial;
+    }
+
+    namespace detail
+    {
+        // Order an operation that reads src and writes dst one element at a time in row major order has to take
+        enum class AliasOrder : uint8_t
+        {
+            // Disjoint, any order and any split across threads works
+            Any,
+            // dst is src, every element is read before it is written
+            Same,
+            // Row major order reads every element before it is overwritten, like memmove with dst before src
+            Forward,
+            // Reverse row major order does
+            Backward,
+            // No order does, src has to be copied first
+            Buffered
+        };
+
+        // Views that are translations of one layout are walked like memmove when row major order visits
+        // addresses monotonically, otherwise the source is buffered
+        template <uint8_t D>
+        AliasOrder aliasOrder(const void* dst,
+                              const Shape<D>& dst_shape,
+                              const void* src,
+                              const Shape<D>& src_shape,
+                              size_t element_size)
+        {
+            const Overlap overlap = memoryOverlap(dst, dst_shape, src, src_shape, element_size);
+            if (overlap != Overlap::Partial)
+            {
+                return overlap == Overlap::None ? AliasOrder::Any : AliasOrder::Same;
+            }
+            int64_t direction = 0;
+            int64_t inner_span = 0;
+            for (int16_t d = D - 1; d >= 0; --d)
+            {
+                if (dst_shape[d] == 1)
+                {
+                    continue;
+                }
+                const int64_t stride = static_cast<Stride_t>(dst_shape.getStride(d));
+                const int64_t step = stride < 0 ? -stride : stride;
+                const int64_t sign = stride < 0 ? -1 : 1;
+                if (dst_shape[d] != src_shape[d] || stride != static_cast<Stride_t>(src_shape.getStride(d)) ||
+                    step <= inner_span || (direction != 0 && sign != direction))
+                {
+                    return AliasOrder::Buffered;
+                }
+                direction = sign;
+                inner_span += step * (static_cast<int64_t>(dst_shape[d]) - 1);
+            }
+            if (direction == 0)
+            {
+                return AliasOrder::Buffered;
+            }
+            const bool dst_first = reinterpret_cast<uintptr_t>(dst) < reinterpret_cast<uintptr_t>(src);
+            return dst_first == (direction > 0) ? AliasOrder::Forward : AliasOrder::Backward;
+        }
+    } // namespace detail
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_OVERLAP_HPP
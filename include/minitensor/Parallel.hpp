@@ -0,0 +1,40 @@
+#ifndef MINITENSOR_PARALLEL_HPP
+#define MINITENSOR_PARALLEL_HPP
+#include "LoopNest.hpp"
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Calls fn(uint64_t begin, uint64_t end) over disjoint chunks of [begin, end) on the default pool
+    template <class F>
+    void parallelFor(uint64_t begin, uint64_t end, uint64_t grain, F&& fn)
+    {
+        ThreadPool::getDefault()->parallelFor(begin, end, grain, std::forward<F>(fn));
+    }
+
+    // Visits every element of tensor in parallel. The dimensions are coalesced like copyTo and the coalesced
+    // elements are split into chunks of about grain elements, so a dense tensor is divided evenly no matter
+    // how its outer dimensions are sized. fn(T* row, uint32_t n, int64_t step) is called once per row segment
+    // with the elements row[0], row[step], ..., row[(n - 1) * step], possibly from several threads at once.
+    template <class T, uint8_t D, class F>
+    void parallelFor(Tensor<T, D> tensor,
+                     F&& fn,
+                     uint64_t grain = ThreadPool::DEFAULT_GRAIN,
+                     ThreadPool& pool = *ThreadPool::getDefault())
+    {
+        const Shape<D> shape = tensor.getShape();
+        const LoopNest<D, 1> loop(shape);
+        const int64_t step = loop.innerStride(0);
+        T* ptr = tensor.data();
+        pool.parallelFor(0, loop.numElements(), grain, [&](uint64_t begin, uint64_t end) {
+            loop.forEachRow(begin, end, [&](const int64_t* offset, uint32_t n) { fn(ptr + offset[0], n, step); });
+        });
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_PARALLEL_HPP
@@ -0,0 +1,598 @@
+#ifndef MINITENSOR_REDUCE_HPP
+#define MINITENSOR_REDUCE_HPP
+#include "LoopNest.hpp"
+#include "Simd.hpp"
+#include "Tensor.hpp"
+#include "TensorBuffer.hpp"
+#include "ThreadPool.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // A reduction maps every element, combines the mapped values starting from identity and finalizes the
+    // result with the number of reduced elements. map and combine work on scalars and vectors alike and write
+    // through references like the ops of Simd.hpp. SUM marks reductions that combine with addition, these use
+    // pairwise or compensated accumulation for floating point types.
+    namespace ops
+    {
+        struct ReduceSum
+        {
+            static constexpr const bool SUM = true;
+
+            template <class T>
+            static MT_XINLINE T identity()
+            {
+                return T(0);
+            }
+
+            template <class V>
+            static MT_XINLINE void map(V& out, const V& x)
+            {
+                out = x;
+            }
+
+            template <class V>
+            static MT_XINLINE void combine(V& acc, const V& x)
+            {
+                acc = static_cast<V>(acc + x);
+            }
+
+            template <class T>
+            static MT_XINLINE T finalize(T acc, uint64_t)
+            {
+                return acc;
+            }
+        };
+
+        struct ReduceMean : ReduceSum
+        {
+            template <class T>
+            static MT_XINLINE T finalize(T acc, uint64_t n)
+            {
+                return static_cast<T>(acc / static_cast<T>(n));
+            }
+        };
+
+        // Euclidean norm, sqrt of the sum of squares
+        struct ReduceNorm : ReduceSum
+        {
+            template <class V>
+            static MT_XINLINE void map(V& out, const V& x)
+            {
+                out = static_cast<V>(x * x);
+            }
+
+            template <class T>
+            static MT_XINLINE T finalize(T acc, uint64_t)
+            {
+                return static_cast<T>(std::sqrt(acc));
+            }
+        };
+
+        struct ReduceMax
+        {
+            static constexpr const bool SUM = false;
+
+            template <class T>
+            static MT_XINLINE T identity()
+            {
+                return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                            : std::numeric_limits<T>::lowest();
+            }
+
+            template <class V>
+            static MT_XINLINE void map(V& out, const V& x)
+            {
+                out = x;
+            }
+
+            template <class V>
+            static MT_XINLINE void combine(V& acc, const V& x)
+            {
+                acc = acc < x ? x : acc;
+            }
+
+            template <class T>
+            static MT_XINLINE T finalize(T acc, uint64_t)
+            {
+                return acc;
+            }
+        };
+
+        struct ReduceMin : ReduceMax
+        {
+            template <class T>
+            static MT_XINLINE T identity()
+            {
+                return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                            : std::numeric_limits<T>::max();
+            }
+
+            template <class V>
+            static MT_XINLINE void combine(V& acc, const V& x)
+            {
+                acc = x < acc ? x : acc;
+            }
+        };
+    } // namespace ops
+
+    namespace detail
+    {
+        // Independent accumulators of the contiguous kernels, one 64 byte vector worth
+        template <class T>
+        struct ReduceBlock
+        {
+            static constexpr const uint32_t LANES = 64 / sizeof(T);
+            static constexpr const uint32_t SIZE = 8 * LANES;
+        };
+
+        // Reduces at most ReduceBlock<T>::SIZE contiguous elements. Lane j accumulates the elements j, j + LANES,
+        // ... and the lanes are folded in a fixed tree, so the order of operations, and the result, is the same
+        // for every instruction set. Vector kernels hold the lanes in 64 / BYTES vectors.
+        template <class OP, class T>
+        using ReduceKernel = T (*)(const T* ptr, uint32_t n);
+
+        template <class OP, class T>
+        MT_SIMD_NO_CONTRACT T foldLanes(T* lanes, const T* ptr, uint32_t n)
+        {
+            for (uint32_t j = 0; j < n; ++j)
+            {
+                T mapped;
+                OP::map(mapped, ptr[j]);
+                OP::combine(lanes[j], mapped);
+            }
+            for (uint32_t width = ReduceBlock<T>::LANES / 2; width > 0; width /= 2)
+            {
+                for (uint32_t j = 0; j < width; ++j)
+                {
+                    OP::combine(lanes[j], lanes[j + width]);
+                }
+            }
+            return lanes[0];
+        }
+
+        template <class OP, class T>
+        MT_SIMD_NO_CONTRACT T reduceScalar(const T* ptr, uint32_t n)
+        {
+            const uint32_t lanes = ReduceBlock<T>::LANES;
+            T acc[ReduceBlock<T>::LANES];
+            for (uint32_t j = 0; j < lanes; ++j)
+            {
+                acc[j] = OP::template identity<T>();
+            }
+            uint32_t i = 0;
+            for (; i + lanes <= n; i += lanes)
+            {
+                for (uint32_t j = 0; j < lanes; ++j)
+                {
+                    T mapped;
+                    OP::map(mapped, ptr[i + j]);
+                    OP::combine(acc[j], mapped);
+                }
+            }
+            return foldLanes<OP>(acc, ptr + i, n - i);
+        }
+
+#if MT_SIMD_X86
+#define MT_REDUCE_KERNEL(NAME, TARGET, BYTES)                                                                          \
+    template <class OP, class T>                                                                                       \
+    TARGET MT_SIMD_FLATTEN MT_SIMD_NO_CONTRACT T NAME(const T* ptr, uint32_t n)                                        \
+    {                                                                                                                  \
+        typedef typename Vector<T, BYTES>::type V;                                                                     \
+        const uint32_t lanes = ReduceBlock<T>::LANES;                                                                  \
+        const uint32_t width = BYTES / sizeof(T);                                                                      \
+        V acc[64 / BYTES];                                                                                             \
+        for (uint32_t v = 0; v < 64 / BYTES; ++v)                                                                      \
+        {                                                                                                              \
+            acc[v] = V() + OP::template identity<T>();                                                                 \
+        }                                                                                                              \
+        uint32_t i = 0;                                                                                                \
+        for (; i + lanes <= n; i += lanes)                                                                             \
+        {                                                                                                              \
+            for (uint32_t v = 0; v < 64 / BYTES; ++v)                                                                  \
+            {                                                                                                          \
+                V x;                                                                                                   \
+                load(x, ptr + i + v * width);                                                                          \
+                V mapped;                                                                                              \
+                OP::map(mapped, x);                                                                                    \
+                OP::combine(acc[v], mapped);                                                                           \
+            }                                                                                                          \
+        }                                                                                                              \
+        T scalars[ReduceBlock<T>::LANES];                                                                              \
+        std::memcpy(scalars, acc, sizeof(scalars));                                                                    \
+        return foldLanes<OP>(scalars, ptr + i, n - i);                                                                 \
+    }
+
+        MT_REDUCE_KERNEL(reduceSSE2, MT_SIMD_TARGET_SSE2, 16)
+        MT_REDUCE_KERNEL(reduceAVX2, MT_SIMD_TARGET_AVX2, 32)
+        MT_REDUCE_KERNEL(reduceAVX512, MT_SIMD_TARGET_AVX512, 64)
+#undef MT_REDUCE_KERNEL
+#endif
+
+        template <class OP, class T>
+        ReduceKernel<OP, T> selectReduceKernel(SimdIsa isa)
+        {
+#if MT_SIMD_X86
+            switch (isa)
+            {
+            case SimdIsa::AVX512:
+                return &reduceAVX512<OP, T>;
+            case SimdIsa::AVX2:
+                return &reduceAVX2<OP, T>;
+            case SimdIsa::SSE2:
+                return &reduceSSE2<OP, T>;
+            default:
+                break;
+            }
+#endif
+            return &reduceScalar<OP, T>;
+        }
+
+        // Pairwise reduction of a contiguous range, split on block boundaries so the tree only depends on n.
+        // The error of a float sum grows with log(n) instead of n. With a pool the two halves of ranges
+        // larger than grain are reduced concurrently, the tree and therefore the result are unchanged.
+        template <class OP, class T>
+        T reducePairwise(ReduceKernel<OP, T> kernel, const T* ptr, uint64_t n, ThreadPool* pool, uint64_t grain)
+        {
+            const uint64_t block = ReduceBlock<T>::SIZE;
+            if (n <= block)
+            {
+                return kernel(ptr, static_cast<uint32_t>(n));
+            }
+            const uint64_t half = ((n + block - 1) / block / 2) * block;
+            if (pool == nullptr || n <= grain)
+            {
+                T lhs = reducePairwise<OP, T>(kernel, ptr, half, nullptr, grain);
+                const T rhs = reducePairwise<OP, T>(kernel, ptr + half, n - half, nullptr, grain);
+                OP::combine(lhs, rhs);
+                return lhs;
+            }
+            T parts[2];
+            pool->parallelFor(0, 2, 1, [&](uint64_t begin, uint64_t end) {
+                for (uint64_t i = begin; i < end; ++i)
+                {
+                    parts[i] = i == 0 ? reducePairwise<OP, T>(kernel, ptr, half, pool, grain)
+                                      : reducePairwise<OP, T>(kernel, ptr + half, n - half, pool, grain);
+                }
+            });
+            OP::combine(parts[0], parts[1]);
+            return parts[0];
+        }
+
+        template <class OP, class T, bool = OP::SUM && std::is_floating_point<T>::value>
+        struct Accumulator
+        {
+            T value = OP::template identity<T>();
+
+            MT_XINLINE void add(T x)
+            {
+                T mapped;
+                OP::map(mapped, x);
+                OP::combine(value, mapped);
+            }
+        };
+
+        // Kahan summation, the rounding error of every addition is carried into the next one
+        template <class OP, class T>
+        struct Accumulator<OP, T, true>
+        {
+            T value = T(0);
+            T compensation = T(0);
+
+            MT_XINLINE void add(T x)
+            {
+                T y;
+                OP::map(y, x);
+                y -= compensation;
+                const T sum = value + y;
+                compensation = (sum - value) - y;
+                value = sum;
+            }
+        };
+
+        // Outputs accumulated together by the kernels of reductions over an outer axis
+        static constexpr const uint32_t ROWS_BLOCK = 256;
+
+        // Slices of an outer axis accumulated on their own before the partial results are combined in order.
+        // Only depends on the size of the axis, so the result is the same with and without a pool.
+        inline uint64_t axisChunk(uint64_t axis_size)
+        {
+            static constexpr const uint64_t MIN_CHUNK = 4096;
+            static constexpr const uint64_t MAX_CHUNKS = 64;
+            const uint64_t even = (axis_size + MAX_CHUNKS - 1) / MAX_CHUNKS;
+            return even > MIN_CHUNK ? even : MIN_CHUNK;
+        }
+
+        // Accumulates count slices of the axis into m <= ROWS_BLOCK outputs, one slice at a time so the input is
+        // read row by row instead of column by column. The values are written to partial unfinalized.
+        template <class OP, class T>
+        void accumulateRows(T* partial, const T* src, int64_t src_step, uint32_t m, int64_t axis_stride, uint64_t count)
+        {
+            Accumulator<OP, T> acc[ROWS_BLOCK];
+            const T* slice = src;
+            for (uint64_t k = 0; k < count; ++k, slice += axis_stride)
+            {
+                if (src_step == 1)
+                {
+                    for (uint32_t j = 0; j < m; ++j)
+                    {
+                        acc[j].add(slice[j]);
+                    }
+                }
+                else
+                {
+                    for (uint32_t j = 0; j < m; ++j)
+                    {
+                        acc[j].add(slice[j * src_step]);
+                    }
+                }
+            }
+            for (uint32_t j = 0; j < m; ++j)
+            {
+                partial[j] = acc[j].value;
+            }
+        }
+
+        // Reduces n outputs whose inputs are not contiguous along the axis, a block of outputs at a time. The
+        // chunks of the axis are combined in order. With a pool the chunks are accumulated concurrently, which
+        // is how a reduction with fewer outputs than threads still runs in parallel.
+        template <class OP, class T>
+        void reduceRows(T* dst,
+                        int64_t dst_step,
+                        const T* src,
+                        int64_t src_step,
+                        uint32_t n,
+                        int64_t axis_stride,
+                        DimSize_t axis_size,
+                        ThreadPool* pool,
+                        uint64_t grain)
+        {
+            const uint64_t chunk = axisChunk(axis_size);
+            const uint64_t chunks = axis_size == 0 ? 1 : (axis_size + chunk - 1) / chunk;
+            auto slices = [=](uint64_t c) { return axis_size - c * chunk < chunk ? axis_size - c * chunk : chunk; };
+            if (pool != nullptr && chunks > 1)
+            {
+                // Partial result of output j over chunk c at c * n + j. Not a std::vector, which packs bool
+                const std::unique_ptr<T[]> partials(new T[chunks * n]);
+                const uint64_t chunk_grain = grain / (chunk * n);
+                pool->parallelFor(0, chunks, chunk_grain, [&](uint64_t begin, uint64_t end) {
+                    for (uint64_t c = begin; c < end; ++c)
+                    {
+                        for (uint32_t j0 = 0; j0 < n; j0 += ROWS_BLOCK)
+                        {
+                            const uint32_t m = n - j0 < ROWS_BLOCK ? n - j0 : ROWS_BLOCK;
+                            accumulateRows<OP>(partials.get() + c * n + j0,
+                                               src + j0 * src_step + c * chunk * axis_stride,
+                                               src_step,
+                                               m,
+                                               axis_stride,
+                                               slices(c));
+                        }
+                    }
+                });
+                for (uint32_t j = 0; j < n; ++j)
+                {
+                    T total = partials[j];
+                    for (uint64_t c = 1; c < chunks; ++c)
+                    {
+                        OP::combine(total, partials[c * n + j]);
+                    }
+                    dst[j * dst_step] = OP::finalize(total, axis_size);
+                }
+                return;
+            }
+            T total[ROWS_BLOCK];
+            T partial[ROWS_BLOCK];
+            for (uint32_t j0 = 0; j0 < n; j0 += ROWS_BLOCK)
+            {
+                const uint32_t m = n - j0 < ROWS_BLOCK ? n - j0 : ROWS_BLOCK;
+                const T* block = src + j0 * src_step;
+                accumulateRows<OP>(total, block, src_step, m, axis_stride, slices(0));
+                for (uint64_t c = 1; c < chunks; ++c)
+                {
+                    accumulateRows<OP>(partial, block + c * chunk * axis_stride, src_step, m, axis_stride, slices(c));
+                    for (uint32_t j = 0; j < m; ++j)
+                    {
+                        OP::combine(total[j], partial[j]);
+                    }
+                }
+                for (uint32_t j = 0; j < m; ++j)
+                {
+                    dst[(j0 + j) * dst_step] = OP::finalize(total[j], axis_size);
+                }
+            }
+        }
+
+        // Inverse of squeezeDim, the reinserted axis has size 1
+        template <uint8_t D>
+        Shape<D> keepDim(const Shape<D - 1>& shape, uint8_t axis)
+        {
+            Shape<D> out;
+            for (uint8_t i = 0, j = 0; i < D; ++i)
+            {
+                if (i == axis)
+                {
+                    out.setShape(i, 1);
+                    out.setStride(i, 0);
+                    continue;
+                }
+                out.setShape(i, shape[j]);
+                out.setStride(i, shape.getStride(j));
+                ++j;
+            }
+            return out;
+        }
+
+        // Calls fn(const int64_t* offsets, uint32_t n, int64_t out_step, int64_t in_step, ThreadPool* pool) for
+        // rows of outputs, offsets[0] locates the first output and offsets[1] the first element reduced into it.
+        // With enough outputs they are divided over the pool, otherwise the pool is handed to fn.
+        template <uint8_t D, class F>
+        void forEachReduction(const Shape<D>& in_shape,
+                              uint8_t axis,
+                              const Shape<D - 1>& out_shape,
+                              ThreadPool* pool,
+                              uint64_t grain,
+                              F&& fn)
+        {
+            assert(axis < D);
+            assert(out_shape == squeezeDim(axis, in_shape));
+            Shape<D> in_outer = in_shape;
+            in_outer.setShape(axis, 1);
+            const LoopNest<D, 2> loop(keepDim<D>(out_shape, axis), in_outer);
+            const int64_t out_step = loop.innerStride(0);
+            const int64_t in_step = loop.innerStride(1);
+            const uint64_t outputs = loop.numElements();
+            const uint64_t axis_size = in_shape[axis];
+            if (pool == nullptr || outputs < pool->concurrency())
+            {
+                loop.forEachRow(
+                    [&](const int64_t* offsets, uint32_t n) { fn(offsets, n, out_step, in_step, pool); });
+                return;
+            }
+            const uint64_t outputs_grain = grain / (axis_size == 0 ? 1 : axis_size);
+            pool->parallelFor(0, outputs, outputs_grain, [&](uint64_t begin, uint64_t end) {
+                loop.forEachRow(begin, end, [&](const int64_t* offsets, uint32_t n) {
+                    fn(offsets, n, out_step, in_step, nullptr);
+                });
+            });
+        }
+    } // namespace detail
+
+    // Reduces axis of in with op into out, whose shape is squeezeDim(axis, in.getShape()). Reductions over a
+    // contiguous axis use the vector kernels of the active instruction set, other axes accumulate whole rows.
+    // With a pool large reductions run in parallel, results do not depend on the pool or instruction set.
+    template <class OP, class T, class A, uint8_t D>
+    void reduce(const Tensor<A, D>& in,
+                uint8_t axis,
+                OP,
+                Tensor<T, D - 1> out,
+                ThreadPool* pool = nullptr,
+                uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        static_assert(std::is_same<typename std::remove_const<A>::type, T>::value,
+                      "Input and output must have the same element type");
+        const Shape<D> in_shape = in.getShape();
+        const T* src = in.data();
+        T* dst = out.data();
+        const DimSize_t axis_size = in_shape[axis];
+        const int64_t axis_stride = static_cast<Stride_t>(in_shape.getStride(axis));
+        const detail::ReduceKernel<OP, T> kernel = detail::selectReduceKernel<OP, T>(getSimdIsa());
+        detail::forEachReduction(
+            in_shape,
+            axis,
+            out.getShape(),
+            pool,
+            grain,
+            [=](const int64_t* offsets, uint32_t n, int64_t out_step, int64_t in_step, ThreadPool* inner_pool) {
+                T* row = dst + offsets[0];
+                const T* first = src + offsets[1];
+                if (axis_stride != 1)
+                {
+                    detail::reduceRows<OP>(row, out_step, first, in_step, n, axis_stride, axis_size, inner_pool, grain);
+                    return;
+                }
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    const T* ptr = first + i * in_step;
+                    const T acc = detail::reducePairwise<OP, T>(kernel, ptr, axis_size, inner_pool, grain);
+                    row[i * out_step] = OP::finalize(acc, axis_size);
+                }
+            });
+    }
+
+    template <class OP, class A, uint8_t D>
+    TensorBuffer<typename std::remove_const<A>::type, D - 1>
+    reduce(const Tensor<A, D>& in, uint8_t axis, OP op, ThreadPool* pool = nullptr)
+    {
+        TensorBuffer<typename std::remove_const<A>::type, D - 1> out(squeezeDim(axis, in.getShape()));
+        reduce(in, axis, op, out.view(), pool);
+        return out;
+    }
+
+// sum(in, axis[, pool]) returns a new buffer, sum(in, axis, out[, pool]) writes into out
+#define MT_REDUCTION(NAME, OP)                                                                                         \
+    template <class A, uint8_t D>                                                                                      \
+    TensorBuffer<typename std::remove_const<A>::type, D - 1> NAME(                                                     \
+        const Tensor<A, D>& in, uint8_t axis, ThreadPool* pool = nullptr)                                              \
+    {                                                                                                                  \
+        return reduce(in, axis, OP(), pool);                                                                           \
+    }                                                                                                                  \
+    template <class T, class A, uint8_t D>                                                                             \
+    void NAME(const Tensor<A, D>& in, uint8_t axis, Tensor<T, D - 1> out, ThreadPool* pool = nullptr)                  \
+    {                                                                                                                  \
+        reduce(in, axis, OP(), out, pool);                                                                             \
+    }
+
+    MT_REDUCTION(sum, ops::ReduceSum)
+    MT_REDUCTION(mean, ops::ReduceMean)
+    MT_REDUCTION(norm, ops::ReduceNorm)
+    MT_REDUCTION(max, ops::ReduceMax)
+    MT_REDUCTION(min, ops::ReduceMin)
+#undef MT_REDUCTION
+
+    // Index along axis of the largest element, the first one on ties
+    template <class A, uint8_t D>
+    void argmax(const Tensor<A, D>& in, uint8_t axis, Tensor<uint32_t, D - 1> out, ThreadPool* pool = nullptr)
+    {
+        typedef typename std::remove_const<A>::type T;
+        const Shape<D> in_shape = in.getShape();
+        const T* src = in.data();
+        uint32_t* dst = out.data();
+        assert(in_shape[axis] <= std::numeric_limits<uint32_t>::max());
+        const uint32_t axis_size = static_cast<uint32_t>(in_shape[axis]);
+        const int64_t axis_stride = static_cast<Stride_t>(in_shape.getStride(axis));
+        detail::forEachReduction(
+            in_shape,
+            axis,
+            out.getShape(),
+            pool,
+            ThreadPool::DEFAULT_GRAIN,
+            [=](const int64_t* offsets, uint32_t n, int64_t out_step, int64_t in_step, ThreadPool*) {
+                static constexpr const uint32_t BLOCK = 256;
+                T best[BLOCK];
+                uint32_t index[BLOCK];
+                for (uint32_t j0 = 0; j0 < n; j0 += BLOCK)
+                {
+                    const uint32_t m = n - j0 < BLOCK ? n - j0 : BLOCK;
+                    const T* slice = src + offsets[1] + j0 * in_step;
+                    for (uint32_t j = 0; j < m; ++j)
+                    {
+                        best[j] = ops::ReduceMax::identity<T>();
+                        index[j] = 0;
+                    }
+                    for (uint32_t k = 0; k < axis_size; ++k, slice += axis_stride)
+                    {
+                        for (uint32_t j = 0; j < m; ++j)
+                        {
+                            const T value = slice[j * in_step];
+                            index[j] = best[j] < value ? k : index[j];
+                            best[j] = best[j] < value ? value : best[j];
+                        }
+                    }
+                    for (uint32_t j = 0; j < m; ++j)
+                    {
+                        dst[offsets[0] + (j0 + j) * out_step] = index[j];
+                    }
+                }
+            });
+    }
+
+    template <class A, uint8_t D>
+    TensorBuffer<uint32_t, D - 1> argmax(const Tensor<A, D>& in, uint8_t axis, ThreadPool* pool = nullptr)
+    {
+        TensorBuffer<uint32_t, D - 1> out(squeezeDim(axis, in.getShape()));
+        argmax(in, axis, out.view(), pool);
+        return out;
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_REDUCE_HPP
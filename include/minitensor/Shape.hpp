@@ -1,82 +1,146 @@
 #ifndef MINITENSOR_SHAPE_HPP
 #define MINITENSOR_SHAPE_HPP
 #include "Array.hpp"
+#include "utilities.hpp"
+
+#include <assert.h>
+#include <limits>
+#include <type_traits>
 
 namespace mt
 {
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Sizes and strides of a Shape. They are 32 bit by default which keeps shapes compact and indexing cheap,
+    // define MT_INDEX_64 (the MINITENSOR_INDEX_64 CMake option) for tensors with strides beyond 2^31 elements.
+    // Element loops stay 32 bit either way, LoopNest never hands out rows longer than 2^32 - 1. The choice is part
+    // of the inline namespace (see defines.hpp), so objects built with different index widths fail to link.
+#ifdef MT_INDEX_64
+    typedef uint64_t DimSize_t;
+    typedef int64_t Stride_t;
+#else
+    typedef uint32_t DimSize_t;
+    typedef int32_t Stride_t;
+#endif
+
+    template <uint32_t... SIZES>
+    class StaticShape;
+
+    template <class... T>
+    struct IsStaticShape : std::false_type
+    {
+    };
+
+    template <uint32_t... SIZES>
+    struct IsStaticShape<StaticShape<SIZES...>> : std::true_type
+    {
+    };
+
+    template <uint8_t N>
+    class Shape;
+
+    template <uint8_t N, class... T>
+    struct IsShape : std::false_type
+    {
+    };
+
+    template <uint8_t N>
+    struct IsShape<N, Shape<N>> : std::true_type
+    {
+    };
+
     template <uint8_t N>
     class Shape
     {
-        Array<uint32_t, N> m_size;
-        Array<int32_t, N> m_stride;
+        Array<DimSize_t, N> m_size;
+        Array<Stride_t, N> m_stride;
 
         template <uint8_t D, class T>
-        size_t indexHelper(size_t out, T&& arg) const
+        constexpr size_t indexHelper(size_t out, T&& arg) const
         {
-            out += m_stride[D] * revIndex(arg, m_size[D]);
-            return out;
+            return out + m_stride[D] * revIndex(arg, m_size[D]);
         }
 
         template <uint8_t D, class T, class... Ts>
-        size_t indexHelper(size_t out, T&& arg, Ts&&... args) const
+        constexpr size_t indexHelper(size_t out, T&& arg, Ts&&... args) const
         {
-            out += m_stride[D] * revIndex(arg, m_size[D]);
-            return indexHelper<D + 1>(out, std::forward<Ts>(args)...);
+            return indexHelper<D + 1>(out + m_stride[D] * revIndex(arg, m_size[D]), std::forward<Ts>(args)...);
         }
 
-      public:
-        Shape(const Shape& other):
-            m_size(other.m_size), m_stride(other.m_stride)
+        // Dense stride of dimension dim, the product of the sizes after it
+        static constexpr Stride_t denseStride(const Array<DimSize_t, N>& size, uint8_t dim, uint64_t stride = 1)
         {
-
+            return dim < N ? denseStride(size, dim + 1, stride * size[dim])
+                           : (assert(stride <= static_cast<uint64_t>(std::numeric_limits<Stride_t>::max())),
+                              static_cast<Stride_t>(stride));
         }
-        Shape(Shape& other):
-            m_size(other.m_size), m_stride(other.m_stride)
-        {
 
-        }
-        Shape(Shape&& other):
-            m_size(other.m_size), m_stride(other.m_stride)
+        template <size_t... I>
+        static constexpr Array<Stride_t, N> denseStrides(const Array<DimSize_t, N>& size, IndexSequence<I...>)
         {
-
+            return Array<Stride_t, N>(denseStride(size, I + 1)...);
         }
 
+      public:
+        // Trivially copyable like Array, views of a shape can be passed in registers and memcpy'd
+        Shape(const Shape& other) = default;
+        Shape(Shape&& other) = default;
+
         Shape& operator=(const Shape& other) = default;
         Shape& operator=(Shape&& other) = default;
 
-        template <class... T>
-        Shape(T&&... args) : m_size(std::forward<T>(args)...)
+        // Sizes of the leading dimensions with a dense row major stride, the remaining sizes are 0
+        template <class... T,
+                  class = typename std::enable_if<!IsStaticShape<typename std::decay<T>::type...>::value &&
+                                                  !IsShape<N, typename std::decay<T>::type...>::value>::type>
+        constexpr Shape(T&&... args)
+            : m_size(std::forward<T>(args)...), m_stride(denseStrides(m_size, makeIndexSequence<N>()))
+        {
+        }
+
+        // Runtime copy of a shape from StaticShape.hpp
+        template <uint32_t... SIZES>
+        Shape(const StaticShape<SIZES...>& shape)
         {
-            calculateStride();
+            static_assert(sizeof...(SIZES) == N, "Dimensions do not match");
+            for (uint8_t i = 0; i < N; ++i)
+            {
+                m_size[i] = shape[i];
+                m_stride[i] = static_cast<Stride_t>(shape.getStride(i));
+            }
         }
 
         template <class... T>
-        auto index(T&&... args) const -> typename std::enable_if<sizeof...(args) != 1, size_t>::type
+        constexpr auto index(T&&... args) const -> typename std::enable_if<sizeof...(args) != 1, size_t>::type
         {
-            size_t out = 0;
-            return indexHelper<0>(out, std::forward<T>(args)...);
+            return indexHelper<0>(0, std::forward<T>(args)...);
         }
 
+        // Maps a row major linear index to an offset, this costs a division per dimension so prefer
+        // ElementIterator when visiting every element
         size_t index(size_t idx) const
         {
             size_t out = 0;
-            for (uint8_t i = 0; i < N - 1; ++i)
+            for (int16_t i = N - 1; i > 0; --i)
             {
-                const size_t this_idx = idx / m_size[i + 1];
-                idx = idx % m_size[i + 1];
-                out += m_stride[i] * this_idx;
+                out += m_stride[i] * (idx % m_size[i]);
+                idx /= m_size[i];
             }
-            out += idx;
+            out += m_stride[0] * idx;
             return out;
         }
 
-        MT_XINLINE uint32_t operator[](int16_t idx) const { return m_size[idx]; }
+        MT_XINLINE constexpr DimSize_t operator[](int16_t idx) const { return m_size[idx]; }
 
-        MT_XINLINE uint32_t getStride(int16_t idx) const { return m_stride[idx]; }
+        // Unsigned like the sizes, cast to Stride_t for the sign of reversed dimensions
+        MT_XINLINE constexpr typename std::make_unsigned<Stride_t>::type getStride(int16_t idx) const
+        {
+            return static_cast<typename std::make_unsigned<Stride_t>::type>(m_stride[idx]);
+        }
 
-        void setShape(uint8_t dim, uint32_t size) { m_size[dim] = size; }
+        void setShape(uint8_t dim, DimSize_t size) { m_size[dim] = size; }
 
-        void setStride(uint8_t dim, uint32_t stride) { m_stride[dim] = stride; }
+        void setStride(uint8_t dim, Stride_t stride) { m_stride[dim] = stride; }
 
         bool operator==(const Shape& other) const
         {
@@ -90,16 +154,11 @@ namespace mt
             return true;
         }
 
+        // Resets the strides to a dense row major layout, this drops any broadcast (zero stride) dimension.
+        // The strides must fit Stride_t, past 2^31 elements that takes MT_INDEX_64.
         void calculateStride()
         {
-            // Assume last dim is densly packed
-            m_stride[N - 1] = 1;
-            for (int16_t i = N - 2; i >= 0; --i)
-            {
-                const auto prev_stride = m_stride[i + 1];
-                const auto prev_shape = m_size[i + 1];
-                m_stride[i] = prev_stride * prev_shape;
-            }
+            m_stride = denseStrides(m_size, makeIndexSequence<N>());
         }
 
         size_t numElements() const
@@ -112,24 +171,29 @@ namespace mt
             return size;
         }
 
+        // True when the elements are densely packed in row major order. Dimensions of size 1 never move
+        // the pointer so their stride is ignored, broadcast dimensions are never dense.
         bool isContinuous() const
         {
-            if (m_stride[N - 1] == 1)
+            int64_t expected = 1;
+            for (int16_t i = N - 1; i >= 0; --i)
             {
-                for (int16_t i = N - 2; i >= 0; --i)
+                if (m_size[i] == 1)
+                {
+                    continue;
+                }
+                if (m_stride[i] != expected)
                 {
-                    const auto prev_stride = m_stride[i + 1];
-                    const auto prev_shape = m_size[i + 1];
-                    if (m_stride[i] != static_cast<int32_t>(prev_stride * prev_shape))
-                    {
-                        return false;
-                    }
+                    return false;
                 }
-                return true;
+                expected *= m_size[i];
             }
-            return false;
+            return true;
         }
 
+        // A dimension whose elements all alias the same memory through a zero stride, see broadcastShape
+        bool isBroadcast(int16_t dim) const { return m_stride[dim] == 0 && m_size[dim] > 1; }
+
         uint8_t numDimensions() const { return N; }
     };
 
@@ -143,14 +207,16 @@ namespace mt
             return 0;
         }
 
-        MT_XINLINE uint32_t operator[](int16_t) const { return 0; }
-        MT_XINLINE uint32_t getStride(int16_t) const { return 1; }
+        MT_XINLINE DimSize_t operator[](int16_t) const { return 0; }
+        MT_XINLINE typename std::make_unsigned<Stride_t>::type getStride(int16_t) const { return 1; }
 
-        void setShape(uint8_t, uint32_t) {}
-        void setStride(uint8_t, uint32_t) {}
+        void setShape(uint8_t, DimSize_t) {}
+        void setStride(uint8_t, Stride_t) {}
         bool operator==(const Shape&) const { return true; }
 
+        void calculateStride() {}
         size_t numElements() const { return 1; }
+        bool isContinuous() const { return true; }
     };
 
     template <uint8_t N>
@@ -172,7 +238,8 @@ namespace mt
         for (uint8_t i = 0; i < N; ++i)
         {
             out_shape.setShape(i, (NUMERATOR * shape[i]) / DENOMINATOR);
-            out_shape.setStride(i, (NUMERATOR * shape.getStride(i)) / DENOMINATOR);
+            const Stride_t stride = static_cast<Stride_t>(shape.getStride(i));
+            out_shape.setStride(i, stride * Stride_t(NUMERATOR) / Stride_t(DENOMINATOR));
         }
         return out_shape;
     }
@@ -195,6 +262,88 @@ namespace mt
         return out_shape;
     }
 
+    // NumPy style broadcasting, the trailing dimensions of shape are aligned with target and every missing
+    // dimension or dimension of size 1 is repeated with a zero stride, no data is copied
+    template <uint8_t D, uint8_t N>
+    Shape<N> broadcastShape(const Shape<D>& shape, const Shape<N>& target)
+    {
+        static_assert(D <= N, "Cannot broadcast to fewer dimensions");
+        Shape<N> out;
+        for (uint8_t i = 0; i < N; ++i)
+        {
+            out.setShape(i, target[i]);
+            if (i < N - D)
+            {
+                out.setStride(i, 0);
+                continue;
+            }
+            const uint8_t src = i - (N - D);
+            assert(shape[src] == target[i] || shape[src] == 1);
+            out.setStride(i, shape[src] == target[i] ? shape.getStride(src) : 0);
+        }
+        return out;
+    }
+
+    // Dimension i of the result is dimension order[i] of shape, only sizes and strides move
+    template <uint8_t N>
+    Shape<N> permuteShape(const Shape<N>& shape, const uint8_t (&order)[N])
+    {
+        Shape<N> out;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < N; ++i)
+        {
+            assert(order[i] < N && (seen & (1U << order[i])) == 0);
+            seen |= 1U << order[i];
+            out.setShape(i, shape[order[i]]);
+            out.setStride(i, shape.getStride(order[i]));
+        }
+        return out;
+    }
+
+    // Selects the indices begin, begin + step, ... up to but excluding end along one dimension. Negative begin
+    // and end count from the back like revIndex, END stands for one past the last index in the direction of
+    // step, so Range(-1, Range::END, -1) reverses a dimension. Range() selects everything.
+    struct Range
+    {
+        static constexpr const int64_t END = std::numeric_limits<int64_t>::max();
+
+        Range() = default;
+        explicit Range(int64_t begin_, int64_t end_ = END, int64_t step_ = 1) : begin(begin_), end(end_), step(step_)
+        {
+        }
+
+        int64_t begin = 0;
+        int64_t end = END;
+        int64_t step = 1;
+    };
+
+    // Restricts dimension dim of shape to range, returns the offset of the first selected element
+    template <uint8_t N>
+    int64_t sliceDim(Shape<N>& shape, uint8_t dim, const Range& range)
+    {
+        assert(range.step != 0);
+        const int64_t size = shape[dim];
+        const int64_t begin = range.begin < 0 ? size + range.begin : range.begin;
+        int64_t end = range.end < 0 ? size + range.end : range.end;
+        end = range.end == Range::END ? (range.step > 0 ? size : -1) : end;
+        assert(begin >= 0 && begin <= size);
+        assert(end >= -1 && end <= size);
+        int64_t count = 0;
+        if (range.step > 0 && end > begin)
+        {
+            count = (end - begin + range.step - 1) / range.step;
+        }
+        if (range.step < 0 && begin > end)
+        {
+            count = (begin - end - range.step - 1) / -range.step;
+        }
+        assert(count == 0 || begin < size);
+        const int64_t stride = static_cast<Stride_t>(shape.getStride(dim));
+        shape.setShape(dim, static_cast<DimSize_t>(count));
+        shape.setStride(dim, static_cast<Stride_t>(stride * range.step));
+        return count == 0 ? 0 : begin * stride;
+    }
+
     template <uint8_t N>
     void unsqueeze(const Shape<N>& in, Shape<N + 1>& out, uint8_t dim)
     {
@@ -212,6 +361,8 @@ namespace mt
         }
         out.calculateStride();
     }
+
+    MT_INDEX_NAMESPACE_END
 } // namespace mt
 
 #include <ostream>
@@ -0,0 +1,490 @@
+#ifndef MINITENSOR_SIMD_HPP
+#define MINITENSOR_SIMD_HPP
+#include "defines.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Vector kernels are written with the GCC / Clang vector extensions and compiled once per instruction set
+// through target attributes, so a single binary carries every variant and picks one at runtime. Other
+// compilers and architectures only get the scalar kernels.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MT_SIMD_X86 1
+#include <immintrin.h>
+#define MT_SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define MT_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define MT_SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx2,fma")))
+// F16C is not part of any level of detectSimdIsa, kernels using it check for it on their own
+#define MT_SIMD_TARGET_F16C __attribute__((target("avx2,fma,f16c")))
+// Kernels are flattened so the operations, which are compiled without a target, inherit the kernel's target
+#define MT_SIMD_FLATTEN __attribute__((flatten))
+#else
+#define MT_SIMD_X86 0
+#endif
+
+// Kernels whose results must not depend on the instruction set keep multiplies and adds separate, GCC would
+// otherwise fuse them into fma where the target has it. Clang only contracts within a single expression.
+#if defined(__GNUC__) && !defined(__clang__)
+#define MT_SIMD_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define MT_SIMD_NO_CONTRACT
+#endif
+
+// Plain loops left to the auto vectorizer. GCC's -O2 cost model skips loops that need shuffles, such as strided
+// accesses with a constant step.
+#if defined(__GNUC__) && !defined(__clang__)
+#define MT_SIMD_VECTORIZE __attribute__((optimize("tree-vectorize,vect-cost-model=dynamic")))
+#else
+#define MT_SIMD_VECTORIZE
+#endif
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    enum class SimdIsa : uint8_t
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    inline const char* simdIsaName(SimdIsa isa)
+    {
+        switch (isa)
+        {
+        case SimdIsa::SSE2:
+            return "sse2";
+        case SimdIsa::AVX2:
+            return "avx2";
+        case SimdIsa::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+
+    // Best instruction set supported by the cpu we are running on
+    inline SimdIsa detectSimdIsa()
+    {
+#if MT_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512vl"))
+        {
+            return SimdIsa::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return SimdIsa::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return SimdIsa::SSE2;
+        }
+#endif
+        return SimdIsa::Scalar;
+    }
+
+    namespace detail
+    {
+        inline SimdIsa& simdIsa()
+        {
+            static SimdIsa isa = detectSimdIsa();
+            return isa;
+        }
+    } // namespace detail
+
+    // Instruction set used by the kernels, defaults to detectSimdIsa()
+    inline SimdIsa getSimdIsa() { return detail::simdIsa(); }
+
+    // Restricts the kernels to isa, requests above what the cpu supports are clamped
+    inline void setSimdIsa(SimdIsa isa)
+    {
+        const SimdIsa supported = detectSimdIsa();
+        detail::simdIsa() = isa < supported ? isa : supported;
+    }
+
+    namespace detail
+    {
+        template <class V, class T>
+        MT_XINLINE void load(V& out, const T* ptr)
+        {
+            std::memcpy(&out, ptr, sizeof(V));
+        }
+
+        template <class V, class T>
+        MT_XINLINE void store(T* ptr, const V& val)
+        {
+            std::memcpy(ptr, &val, sizeof(V));
+        }
+
+        // Operands flagged in the BROADCAST bit mask are constant along a row, they are loaded once per row into
+        // hoisted instead of once per element
+        template <uint8_t BROADCAST, uint8_t K, class V, class T>
+        MT_XINLINE void loadOperand(V& out, const T* const* in, const V* hoisted, uint32_t i)
+        {
+            if ((BROADCAST >> K) & 1)
+            {
+                out = hoisted[K];
+            }
+            else
+            {
+                load(out, in[K] + i);
+            }
+        }
+
+        template <uint8_t BROADCAST, uint8_t ARITY, class V, class T>
+        MT_XINLINE void hoist(V* hoisted, const T* const* in)
+        {
+            for (uint8_t k = 0; k < ARITY; ++k)
+            {
+                hoisted[k] = V();
+                if ((BROADCAST >> k) & 1)
+                {
+                    hoisted[k] += in[k][0];
+                }
+            }
+        }
+
+        // call evaluates op(out, args[0], ..., args[ARITY - 1]) on scalars, row evaluates one scalar or vector
+        // V worth of elements at offset i of a dense row. Vectors are passed by reference so that no vector
+        // ever crosses a call boundary compiled for a different instruction set.
+        template <uint8_t ARITY>
+        struct Invoke;
+
+        template <>
+        struct Invoke<1>
+        {
+            template <class OP, class T>
+            static MT_XINLINE void call(const OP& op, T& out, const T* args)
+            {
+                op(out, args[0]);
+            }
+
+            template <uint8_t BROADCAST, class V, class OP, class T>
+            static MT_XINLINE void row(const OP& op, T* out, const T* const* in, const V* hoisted, uint32_t i)
+            {
+                V a;
+                loadOperand<BROADCAST, 0>(a, in, hoisted, i);
+                V result;
+                op(result, a);
+                store(out + i, result);
+            }
+        };
+
+        template <>
+        struct Invoke<2>
+        {
+            template <class OP, class T>
+            static MT_XINLINE void call(const OP& op, T& out, const T* args)
+            {
+                op(out, args[0], args[1]);
+            }
+
+            template <uint8_t BROADCAST, class V, class OP, class T>
+            static MT_XINLINE void row(const OP& op, T* out, const T* const* in, const V* hoisted, uint32_t i)
+            {
+                V a;
+                loadOperand<BROADCAST, 0>(a, in, hoisted, i);
+                V b;
+                loadOperand<BROADCAST, 1>(b, in, hoisted, i);
+                V result;
+                op(result, a, b);
+                store(out + i, result);
+            }
+        };
+
+        template <>
+        struct Invoke<3>
+        {
+            template <class OP, class T>
+            static MT_XINLINE void call(const OP& op, T& out, const T* args)
+            {
+                op(out, args[0], args[1], args[2]);
+            }
+
+            template <uint8_t BROADCAST, class V, class OP, class T>
+            static MT_XINLINE void row(const OP& op, T* out, const T* const* in, const V* hoisted, uint32_t i)
+            {
+                V a;
+                loadOperand<BROADCAST, 0>(a, in, hoisted, i);
+                V b;
+                loadOperand<BROADCAST, 1>(b, in, hoisted, i);
+                V c;
+                loadOperand<BROADCAST, 2>(c, in, hoisted, i);
+                V result;
+                op(result, a, b, c);
+                store(out + i, result);
+            }
+        };
+
+        // Processes one row with a dense output, out[i] = op(in[0][i], ..., in[ARITY - 1][i]). Inputs are dense
+        // except the ones flagged in the kernel's broadcast mask, which are read from in[k][0] for every i.
+        template <class OP, class T, uint8_t ARITY>
+        using RowKernel = void (*)(const OP& op, T* out, const T* const* in, uint32_t n);
+
+        template <class OP, class T, uint8_t ARITY, uint8_t BROADCAST>
+        void rowScalar(const OP& op, T* out, const T* const* in, uint32_t n)
+        {
+            T hoisted[ARITY];
+            hoist<BROADCAST, ARITY>(hoisted, in);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                Invoke<ARITY>::template row<BROADCAST>(op, out, in, static_cast<const T*>(hoisted), i);
+            }
+        }
+
+#if MT_SIMD_X86
+        template <class T, size_t BYTES>
+        struct Vector
+        {
+            typedef T type __attribute__((vector_size(BYTES)));
+        };
+
+// A scalar head is peeled until the destination is aligned to the vector width, the body loads unaligned
+// vectors from the inputs and the remaining tail is finished with scalars
+#define MT_SIMD_ROW_KERNEL(NAME, TARGET, BYTES)                                                                        \
+    template <class OP, class T, uint8_t ARITY, uint8_t BROADCAST>                                                     \
+    TARGET MT_SIMD_FLATTEN void NAME(const OP& op, T* out, const T* const* in, uint32_t n)                             \
+    {                                                                                                                  \
+        typedef typename Vector<T, BYTES>::type V;                                                                     \
+        const uint32_t lanes = BYTES / sizeof(T);                                                                      \
+        T scalars[ARITY];                                                                                              \
+        hoist<BROADCAST, ARITY>(scalars, in);                                                                          \
+        const T* hoisted_scalars = scalars;                                                                            \
+        V vectors[ARITY];                                                                                              \
+        hoist<BROADCAST, ARITY>(vectors, in);                                                                          \
+        const V* hoisted_vectors = vectors;                                                                            \
+        const uintptr_t address = reinterpret_cast<uintptr_t>(out);                                                    \
+        uint32_t head = address % sizeof(T) == 0 ? ((BYTES - address % BYTES) % BYTES) / sizeof(T) : 0;                \
+        head = head < n ? head : n;                                                                                    \
+        uint32_t i = 0;                                                                                                \
+        for (; i < head; ++i)                                                                                          \
+        {                                                                                                              \
+            Invoke<ARITY>::template row<BROADCAST>(op, out, in, hoisted_scalars, i);                                   \
+        }                                                                                                              \
+        for (; i + lanes <= n; i += lanes)                                                                             \
+        {                                                                                                              \
+            Invoke<ARITY>::template row<BROADCAST>(op, out, in, hoisted_vectors, i);                                   \
+        }                                                                                                              \
+        for (; i < n; ++i)                                                                                             \
+        {                                                                                                              \
+            Invoke<ARITY>::template row<BROADCAST>(op, out, in, hoisted_scalars, i);                                   \
+        }                                                                                                              \
+    }
+
+        MT_SIMD_ROW_KERNEL(rowSSE2, MT_SIMD_TARGET_SSE2, 16)
+        MT_SIMD_ROW_KERNEL(rowAVX2, MT_SIMD_TARGET_AVX2, 32)
+        MT_SIMD_ROW_KERNEL(rowAVX512, MT_SIMD_TARGET_AVX512, 64)
+#undef MT_SIMD_ROW_KERNEL
+#endif
+
+        // Maps the runtime broadcast mask onto the kernel instantiated for it
+        template <class OP, class T, uint8_t ARITY, uint8_t BROADCAST = 0, bool END = (BROADCAST >> ARITY) != 0>
+        struct RowKernelSelector
+        {
+            static RowKernel<OP, T, ARITY> select(SimdIsa isa, uint8_t broadcast)
+            {
+                if (broadcast != BROADCAST)
+                {
+                    return RowKernelSelector<OP, T, ARITY, BROADCAST + 1>::select(isa, broadcast);
+                }
+#if MT_SIMD_X86
+                switch (isa)
+                {
+                case SimdIsa::AVX512:
+                    return &rowAVX512<OP, T, ARITY, BROADCAST>;
+                case SimdIsa::AVX2:
+                    return &rowAVX2<OP, T, ARITY, BROADCAST>;
+                case SimdIsa::SSE2:
+                    return &rowSSE2<OP, T, ARITY, BROADCAST>;
+                default:
+                    break;
+                }
+#endif
+                return &rowScalar<OP, T, ARITY, BROADCAST>;
+            }
+        };
+
+        template <class OP, class T, uint8_t ARITY, uint8_t BROADCAST>
+        struct RowKernelSelector<OP, T, ARITY, BROADCAST, true>
+        {
+            static RowKernel<OP, T, ARITY> select(SimdIsa, uint8_t) { return nullptr; }
+        };
+
+        // Chosen once per call, never per element. Bit k of broadcast marks input k as constant along the row.
+        template <class OP, class T, uint8_t ARITY>
+        RowKernel<OP, T, ARITY> selectRowKernel(SimdIsa isa, uint8_t broadcast = 0)
+        {
+            return RowKernelSelector<OP, T, ARITY>::select(isa, broadcast);
+        }
+
+        // Fused multiply add with a single rounding for floating point types, matching std::fma exactly
+        template <class T, size_t BYTES, bool = std::is_floating_point<T>::value>
+        struct FusedMultiplyAdd
+        {
+            template <class V>
+            static MT_XINLINE void apply(V& out, const V& a, const V& b, const V& c)
+            {
+                out = a * b + c;
+            }
+        };
+
+        template <class T, size_t BYTES>
+        struct FusedMultiplyAdd<T, BYTES, true>
+        {
+            template <class V>
+            static MT_XINLINE void apply(V& out, const V& a, const V& b, const V& c)
+            {
+                for (uint32_t i = 0; i < BYTES / sizeof(T); ++i)
+                {
+                    out[i] = std::fma(a[i], b[i], c[i]);
+                }
+            }
+        };
+
+        template <class T>
+        struct FusedMultiplyAdd<T, sizeof(T), true>
+        {
+            static MT_XINLINE void apply(T& out, T a, T b, T c) { out = std::fma(a, b, c); }
+        };
+
+#if MT_SIMD_X86
+        template <>
+        struct FusedMultiplyAdd<float, 32, true>
+        {
+            template <class V>
+            static MT_SIMD_TARGET_AVX2 void apply(V& out, const V& a, const V& b, const V& c)
+            {
+                out = _mm256_fmadd_ps(a, b, c);
+            }
+        };
+
+        template <>
+        struct FusedMultiplyAdd<double, 32, true>
+        {
+            template <class V>
+            static MT_SIMD_TARGET_AVX2 void apply(V& out, const V& a, const V& b, const V& c)
+            {
+                out = _mm256_fmadd_pd(a, b, c);
+            }
+        };
+
+        template <>
+        struct FusedMultiplyAdd<float, 64, true>
+        {
+            template <class V>
+            static MT_SIMD_TARGET_AVX512 void apply(V& out, const V& a, const V& b, const V& c)
+            {
+                out = _mm512_fmadd_ps(a, b, c);
+            }
+        };
+
+        template <>
+        struct FusedMultiplyAdd<double, 64, true>
+        {
+            template <class V>
+            static MT_SIMD_TARGET_AVX512 void apply(V& out, const V& a, const V& b, const V& c)
+            {
+                out = _mm512_fmadd_pd(a, b, c);
+            }
+        };
+#endif
+    } // namespace detail
+
+    // Elementwise operations usable on both scalars and vectors, op(out, args...) gives identical results for
+    // every instruction set
+    namespace ops
+    {
+        struct SimdAdd
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a, const V& b) const
+            {
+                out = a + b;
+            }
+        };
+
+        struct SimdMul
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a, const V& b) const
+            {
+                out = a * b;
+            }
+        };
+
+        struct SimdMin
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a, const V& b) const
+            {
+                out = b < a ? b : a;
+            }
+        };
+
+        struct SimdMax
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a, const V& b) const
+            {
+                out = a < b ? b : a;
+            }
+        };
+
+        template <class T>
+        struct SimdFma
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a, const V& b, const V& c) const
+            {
+                detail::FusedMultiplyAdd<T, sizeof(V)>::apply(out, a, b, c);
+            }
+        };
+
+        template <class T, bool = std::is_unsigned<T>::value>
+        struct SimdAbs
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a) const
+            {
+                out = a < 0 ? -a : a;
+            }
+        };
+
+        template <class T>
+        struct SimdAbs<T, true>
+        {
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a) const
+            {
+                out = a;
+            }
+        };
+
+        template <class T>
+        struct SimdClamp
+        {
+            T lo;
+            T hi;
+
+            template <class V>
+            MT_XINLINE void operator()(V& out, const V& a) const
+            {
+                const V vlo = V() + lo;
+                const V vhi = V() + hi;
+                const V low = a < vlo ? vlo : a;
+                out = vhi < low ? vhi : low;
+            }
+        };
+    } // namespace ops
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_SIMD_HPP
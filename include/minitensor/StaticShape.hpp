@@ -0,0 +1,264 @@
+#ifndef MINITENSOR_STATIC_SHAPE_HPP
+#define MINITENSOR_STATIC_SHAPE_HPP
+#include "Shape.hpp"
+#include "Tensor.hpp"
+
+#include <assert.h>
+#include <cstdint>
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Size of a StaticShape dimension that is only known at runtime
+    static constexpr const uint32_t DYNAMIC_SIZE = 0xFFFFFFFF;
+
+    namespace detail
+    {
+        template <uint32_t FIRST, uint32_t... REST>
+        struct SizePack
+        {
+            static constexpr uint32_t at(uint8_t dim) { return dim == 0 ? FIRST : SizePack<REST...>::at(dim - 1); }
+            static constexpr uint8_t numDynamic() { return (FIRST == DYNAMIC_SIZE) + SizePack<REST...>::numDynamic(); }
+        };
+
+        template <uint32_t LAST>
+        struct SizePack<LAST>
+        {
+            static constexpr uint32_t at(uint8_t) { return LAST; }
+            static constexpr uint8_t numDynamic() { return LAST == DYNAMIC_SIZE; }
+        };
+
+        template <class SHAPE, uint8_t D, bool LAST = D + 1 >= SHAPE::DIM>
+        struct StaticStride
+        {
+            static constexpr size_t get(const SHAPE& shape)
+            {
+                return size_t(shape.template size<D + 1>()) * StaticStride<SHAPE, D + 1>::get(shape);
+            }
+        };
+
+        template <class SHAPE, uint8_t D>
+        struct StaticStride<SHAPE, D, true>
+        {
+            static constexpr size_t get(const SHAPE&) { return 1; }
+        };
+    } // namespace detail
+
+    // Dense row major shape with the sizes as template arguments, ie StaticShape<3, 3> for a 3x3 matrix. Strides
+    // are constant expressions so index() folds to a constant offset for constant indices and loops over the
+    // sizes have constant trip counts. Sizes given as DYNAMIC_SIZE are set at runtime, strides outside of them
+    // stay constant, so StaticShape<DYNAMIC_SIZE, 4, 4> is a batch of 4x4 transforms. Converts to Shape<N>.
+    template <uint32_t... SIZES>
+    class StaticShape
+    {
+        typedef detail::SizePack<SIZES...> Pack;
+
+      public:
+        static constexpr const uint8_t DIM = sizeof...(SIZES);
+        static constexpr const uint8_t NUM_DYNAMIC = Pack::numDynamic();
+
+      private:
+        // Static sizes are kept here too so rows of the shape can be built with a loop
+        uint32_t m_size[DIM];
+
+        template <uint8_t D, class T>
+        constexpr size_t indexHelper(T arg) const
+        {
+            return stride<D>() * revIndex(arg, size<D>());
+        }
+
+        template <uint8_t D, class T, class... Ts>
+        constexpr size_t indexHelper(T arg, Ts... args) const
+        {
+            return indexHelper<D>(arg) + indexHelper<D + 1>(args...);
+        }
+
+      public:
+        constexpr StaticShape() : m_size{(SIZES == DYNAMIC_SIZE ? 0 : SIZES)...} {}
+
+        // The sizes of the DYNAMIC_SIZE dimensions in order
+        template <class... ARGS,
+                  class = typename std::enable_if<sizeof...(ARGS) == NUM_DYNAMIC && NUM_DYNAMIC != 0>::type>
+        StaticShape(ARGS... dynamic_sizes) : StaticShape()
+        {
+            const uint32_t sizes[] = {static_cast<uint32_t>(dynamic_sizes)...};
+            uint8_t next = 0;
+            for (uint8_t i = 0; i < DIM; ++i)
+            {
+                if (Pack::at(i) == DYNAMIC_SIZE)
+                {
+                    m_size[i] = sizes[next++];
+                }
+            }
+        }
+
+        // From a runtime shape, which must be dense and agree with the static sizes
+        explicit StaticShape(const Shape<DIM>& shape) : StaticShape()
+        {
+            assert(shape.isContinuous());
+            for (uint8_t i = 0; i < DIM; ++i)
+            {
+                setShape(i, shape[i]);
+            }
+        }
+
+        template <uint8_t D>
+        MT_XINLINE constexpr uint32_t size() const
+        {
+            return Pack::at(D) == DYNAMIC_SIZE ? m_size[D] : Pack::at(D);
+        }
+
+        template <uint8_t D>
+        MT_XINLINE constexpr size_t stride() const
+        {
+            return detail::StaticStride<StaticShape, D>::get(*this);
+        }
+
+        MT_XINLINE constexpr uint32_t operator[](int16_t dim) const
+        {
+            return Pack::at(revIndex(dim, DIM)) == DYNAMIC_SIZE ? m_size[revIndex(dim, DIM)]
+                                                                 : Pack::at(revIndex(dim, DIM));
+        }
+
+        MT_XINLINE constexpr uint32_t getStride(int16_t dim) const
+        {
+            return revIndex(dim, DIM) + 1 >= DIM
+                       ? 1
+                       : (*this)[revIndex(dim, DIM) + 1] * getStride(static_cast<int16_t>(revIndex(dim, DIM) + 1));
+        }
+
+        template <class... T>
+        MT_XINLINE constexpr auto index(T... args) const -> typename std::enable_if<sizeof...(args) != 1, size_t>::type
+        {
+            static_assert(sizeof...(args) == DIM, "Expected an index per dimension");
+            return indexHelper<0>(args...);
+        }
+
+        // Row major linear index, dense so it is the offset
+        MT_XINLINE constexpr size_t index(size_t idx) const { return idx; }
+
+        // Only DYNAMIC_SIZE dimensions can change
+        void setShape(uint8_t dim, uint32_t size)
+        {
+            assert(Pack::at(dim) == DYNAMIC_SIZE || Pack::at(dim) == size);
+            m_size[dim] = size;
+        }
+
+        constexpr size_t numElements() const { return size_t((*this)[0]) * getStride(0); }
+        constexpr bool isContinuous() const { return true; }
+        constexpr uint8_t numDimensions() const { return DIM; }
+
+        bool operator==(const StaticShape& other) const
+        {
+            for (uint8_t i = 0; i < DIM; ++i)
+            {
+                if ((*this)[i] != other[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    template <class T, class SHAPE>
+    class StaticTensor;
+
+    namespace detail
+    {
+        // What operator[] of a StaticTensor returns, a view of the inner dimensions or an element
+        template <class T, class SHAPE>
+        struct StaticRow;
+
+        template <class T, uint32_t FIRST, uint32_t... REST>
+        struct StaticRow<T, StaticShape<FIRST, REST...>>
+        {
+            typedef StaticTensor<T, StaticShape<REST...>> type;
+
+            static type make(T* ptr, const StaticShape<FIRST, REST...>& shape)
+            {
+                StaticShape<REST...> inner;
+                for (uint8_t d = 0; d < sizeof...(REST); ++d)
+                {
+                    inner.setShape(d, shape[d + 1]);
+                }
+                return type(ptr, inner);
+            }
+        };
+
+        template <class T, uint32_t LAST>
+        struct StaticRow<T, StaticShape<LAST>>
+        {
+            typedef T& type;
+
+            static type make(T* ptr, const StaticShape<LAST>&) { return *ptr; }
+        };
+    } // namespace detail
+
+    // View of dense elements with a StaticShape, indexing compiles down to constant offsets. Converts implicitly
+    // to Tensor<T, N> for everything that works on runtime shapes.
+    template <class T, uint32_t... SIZES>
+    class StaticTensor<T, StaticShape<SIZES...>>
+        : public TensorIndexing<StaticTensor<T, StaticShape<SIZES...>>, T, sizeof...(SIZES)>
+    {
+      public:
+        typedef StaticShape<SIZES...> Shape_t;
+        static constexpr const uint8_t DIM = sizeof...(SIZES);
+
+      private:
+        typedef typename std::remove_const<T>::type DType_t;
+        typedef detail::StaticRow<T, Shape_t> Row;
+        typedef detail::StaticRow<const DType_t, Shape_t> ConstRow;
+
+        T* m_ptr;
+        Shape_t m_shape;
+
+      public:
+        StaticTensor(T* ptr = nullptr, const Shape_t& shape = Shape_t()) : m_ptr(ptr), m_shape(shape) {}
+
+        // From a runtime view, which must be dense and agree with the static sizes
+        explicit StaticTensor(Tensor<T, DIM> tensor) : m_ptr(tensor.data()), m_shape(tensor.getShape()) {}
+
+        template <class... ARGS>
+        MT_XINLINE const T* ptr(ARGS&&... args) const
+        {
+            return m_ptr + m_shape.index(std::forward<ARGS>(args)...);
+        }
+
+        template <class... ARGS>
+        MT_XINLINE T* ptr(ARGS&&... args)
+        {
+            return m_ptr + m_shape.index(std::forward<ARGS>(args)...);
+        }
+
+        MT_XINLINE typename Row::type operator[](uint32_t i)
+        {
+            return Row::make(m_ptr + i * m_shape.template stride<0>(), m_shape);
+        }
+
+        MT_XINLINE typename ConstRow::type operator[](uint32_t i) const
+        {
+            return ConstRow::make(m_ptr + i * m_shape.template stride<0>(), m_shape);
+        }
+
+        MT_XINLINE const Shape_t& getShape() const { return m_shape; }
+        MT_XINLINE const T* data() const { return m_ptr; }
+        MT_XINLINE T* data() { return m_ptr; }
+
+        Tensor<T, DIM> view() const { return Tensor<T, DIM>(m_ptr, m_shape); }
+
+        operator Tensor<T, DIM>() const { return view(); }
+
+        template <class U = T, class = typename std::enable_if<!std::is_const<U>::value>::type>
+        operator Tensor<const U, DIM>() const
+        {
+            return Tensor<const U, DIM>(m_ptr, m_shape);
+        }
+    };
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_STATIC_SHAPE_HPP
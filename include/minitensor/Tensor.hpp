@@ -2,24 +2,322 @@
 #define MINITENSOR_TENSOR_HPP
 #include "defines.hpp"
 
+#include "LoopNest.hpp"
+#include "Overlap.hpp"
 #include "Shape.hpp"
+#include "ThreadPool.hpp"
 #include "utilities.hpp"
 
+#include <algorithm>
 #include <assert.h>
 #include <cstddef>
+#include <iterator>
+#include <memory>
 #include <typeinfo>
 #include <vector>
 
 namespace mt
 {
+    MT_INDEX_NAMESPACE_BEGIN
+
 
     static constexpr bool greater(uint8_t lhs, uint8_t rhs) { return lhs > rhs; }
     template <class T, uint8_t D>
     class TensorIterator;
 
+    template <class T, uint8_t D>
+    class ElementIterator;
+
     template <class T, uint8_t D, class ENABLE = void>
     class Tensor;
 
+    template <class DERIVED>
+    struct Expression;
+
+    template <class T, uint8_t D, class E>
+    void assign(Tensor<T, D> dst, const Expression<E>& expr);
+
+    namespace detail
+    {
+        // Tile used when the operands of a copy are contiguous along different dimensions, A elements along
+        // the dimension dst is contiguous in and B along the one src is contiguous in
+        template <class T>
+        struct CopyTile
+        {
+            static constexpr const uint32_t A = 256 / sizeof(T) < 8 ? 8 : 256 / sizeof(T);
+            static constexpr const uint32_t B = 1024 / sizeof(T) < 8 ? 8 : 1024 / sizeof(T);
+        };
+
+        // Copy where dst is contiguous along coalesced dimension a of loop and src along dimension b, like
+        // a transpose or an NCHW to NHWC conversion. Copying row by row would read or write one element per
+        // cache line, so the a x b plane is copied in tiles small enough that the cache lines of both operands
+        // stay resident while the tile is processed. Bands of tiles along b are the unit of parallel work.
+        template <class T, uint8_t D>
+        void copyTiled(const T* src,
+                       T* dst,
+                       const LoopNest<D, 2>& loop,
+                       uint8_t a,
+                       uint8_t b,
+                       ThreadPool* pool,
+                       uint64_t grain)
+        {
+            // Nest over the remaining dimensions, the coalesced dimensions are right aligned
+            Shape<D> outer_shapes[2];
+            const uint8_t skip = D - loop.dims();
+            for (uint8_t k = 0; k < 2; ++k)
+            {
+                for (uint8_t i = 0; i < D; ++i)
+                {
+                    const bool kept = i >= skip && i - skip != a && i - skip != b;
+                    outer_shapes[k].setShape(i, kept ? loop.size(i - skip) : 1);
+                    outer_shapes[k].setStride(i, kept ? static_cast<Stride_t>(loop.stride(k, i - skip)) : 0);
+                }
+            }
+            const LoopNest<D, 2> outer(outer_shapes[0], outer_shapes[1]);
+            const DimSize_t size_a = loop.size(a);
+            const DimSize_t size_b = loop.size(b);
+            // dst has unit stride along a and src along b
+            const int64_t dst_b = loop.stride(0, b);
+            const int64_t src_a = loop.stride(1, a);
+            const uint32_t tile = CopyTile<T>::B;
+            const uint64_t bands = (size_b + tile - 1) / tile;
+            auto band = [=](const int64_t* offsets, uint64_t index) {
+                T* out = dst + offsets[0];
+                const T* in = src + offsets[1];
+                const DimSize_t b0 = static_cast<DimSize_t>(index * tile);
+                const DimSize_t b1 = size_b - b0 < tile ? size_b : b0 + tile;
+                for (DimSize_t a0 = 0; a0 < size_a; a0 += CopyTile<T>::A)
+                {
+                    const DimSize_t a1 = size_a - a0 < CopyTile<T>::A ? size_a : a0 + CopyTile<T>::A;
+                    for (DimSize_t i = b0; i < b1; ++i)
+                    {
+                        T* row = out + i * dst_b;
+                        const T* col = in + i + a0 * src_a;
+                        for (DimSize_t j = a0; j < a1; ++j, col += src_a)
+                        {
+                            row[j] = *col;
+                        }
+                    }
+                }
+            };
+            // Work item w is band w % bands of outer element w / bands
+            auto run = [&outer, &band, bands](uint64_t begin, uint64_t end) {
+                uint64_t w = begin;
+                while (w < end)
+                {
+                    const uint64_t element = w / bands;
+                    const uint64_t stop = end < (element + 1) * bands ? end : (element + 1) * bands;
+                    outer.forEachRow(element, element + 1, [&](const int64_t* offsets, uint32_t) {
+                        for (; w < stop; ++w)
+                        {
+                            band(offsets, w % bands);
+                        }
+                    });
+                }
+            };
+            const uint64_t items = outer.numElements() * bands;
+            if (pool == nullptr)
+            {
+                run(0, items);
+                return;
+            }
+            const uint64_t item_size = static_cast<uint64_t>(tile) * size_a;
+            pool->parallelFor(0, items, grain / item_size, run);
+        }
+
+        // First coalesced dimension along which operand k is contiguous, dims() if there is none
+        template <uint8_t D>
+        uint8_t unitDim(const LoopNest<D, 2>& loop, uint8_t k)
+        {
+            uint8_t d = 0;
+            while (d < loop.dims() && (loop.stride(k, d) != 1 || loop.size(d) == 1))
+            {
+                ++d;
+            }
+            return d;
+        }
+
+        // Copies through copyTiled when the operands are contiguous along different dimensions and returns
+        // whether it did. That takes two dimensions, views with fewer never instantiate copyTiled.
+        template <class T, uint8_t D>
+        bool copyTransposed(
+            const T* src, T* dst, const LoopNest<D, 2>& loop, ThreadPool* pool, uint64_t grain, std::true_type)
+        {
+            const uint8_t dst_unit = unitDim(loop, 0);
+            const uint8_t src_unit = unitDim(loop, 1);
+            if (dst_unit == src_unit || dst_unit == loop.dims() || src_unit == loop.dims())
+            {
+                return false;
+            }
+            copyTiled(src, dst, loop, dst_unit, src_unit, pool, grain);
+            return true;
+        }
+
+        template <class T, uint8_t D>
+        bool copyTransposed(const T*, T*, const LoopNest<D, 2>&, ThreadPool*, uint64_t, std::false_type)
+        {
+            return false;
+        }
+
+        // Row of a copy between views that do not alias
+        template <class T>
+        void copyRow(const T* __restrict in, int64_t in_step, T* __restrict out, int64_t out_step, uint32_t n)
+        {
+            if (out_step == 1 && in_step == 1)
+            {
+                std::copy(in, in + n, out);
+            }
+            else if (out_step == 1)
+            {
+                for (uint32_t i = 0; i < n; ++i, in += in_step)
+                {
+                    out[i] = *in;
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < n; ++i, in += in_step, out += out_step)
+                {
+                    *out = *in;
+                }
+            }
+        }
+
+        // Copy between translated views of one layout where walking the elements in row major order, or in
+        // reverse, reads every element before it is overwritten. Reverse order walks views with every
+        // dimension flipped.
+        template <class T, uint8_t D>
+        void copyOrdered(const T* src, Shape<D> src_shape, T* dst, Shape<D> dst_shape, bool reverse)
+        {
+            if (reverse)
+            {
+                for (uint8_t d = 0; d < D; ++d)
+                {
+                    const Stride_t stride = static_cast<Stride_t>(src_shape.getStride(d));
+                    src += static_cast<int64_t>(stride) * (static_cast<int64_t>(src_shape[d]) - 1);
+                    dst += static_cast<int64_t>(stride) * (static_cast<int64_t>(dst_shape[d]) - 1);
+                    src_shape.setStride(d, -stride);
+                    dst_shape.setStride(d, -stride);
+                }
+            }
+            const LoopNest<D, 2> loop(dst_shape, src_shape);
+            const int64_t step = loop.innerStride(0);
+            loop.forEachRow([src, dst, step](const int64_t* offset, uint32_t n) {
+                T* out = dst + offset[0];
+                const T* in = src + offset[1];
+                if (step == 1)
+                {
+                    // Like memmove, out comes before in
+                    std::copy(in, in + n, out);
+                    return;
+                }
+                if (step == -1)
+                {
+                    // A dense row walked from its last element, out comes after in
+                    std::copy_backward(in + 1 - n, in + 1, out + 1);
+                    return;
+                }
+                for (uint32_t i = 0; i < n; ++i, in += step, out += step)
+                {
+                    *out = *in;
+                }
+            });
+        }
+    } // namespace detail
+
+    // Copies between two strided views of the same shape. Dimensions are coalesced first so dense
+    // tensors become a single bulk copy and strided views only loop over the dimensions that need it.
+    // When the operands are contiguous along different dimensions, such as a permuted view, the copy is
+    // tiled. With a pool the work is split into chunks of about grain elements copied concurrently.
+    // Views that overlap, like a window shifted within a ring of frames, are copied in the order that reads
+    // every element before it is overwritten, or through a temporary when there is no such order. See
+    // memoryOverlap.
+    template <class T, uint8_t D>
+    void copyStrided(const T* src,
+                     const Shape<D>& src_shape,
+                     T* dst,
+                     const Shape<D>& dst_shape,
+                     ThreadPool* pool = nullptr,
+                     uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        assert(src_shape == dst_shape);
+        const LoopNest<D, 2> loop(dst_shape, src_shape);
+        if (loop.numElements() == 0)
+        {
+            return;
+        }
+        const detail::AliasOrder order = detail::aliasOrder(dst, dst_shape, src, src_shape, sizeof(T));
+        if (order == detail::AliasOrder::Same)
+        {
+            return;
+        }
+        if (order == detail::AliasOrder::Forward || order == detail::AliasOrder::Backward)
+        {
+            detail::copyOrdered(src, src_shape, dst, dst_shape, order == detail::AliasOrder::Backward);
+            return;
+        }
+        if (order == detail::AliasOrder::Buffered)
+        {
+            Shape<D> dense = src_shape;
+            dense.calculateStride();
+            // Not a std::vector, which packs bool
+            const std::unique_ptr<T[]> buffer(new T[dense.numElements()]);
+            copyStrided(src, src_shape, buffer.get(), dense, pool, grain);
+            copyStrided<T, D>(buffer.get(), dense, dst, dst_shape, pool, grain);
+            return;
+        }
+        const int64_t dst_step = loop.innerStride(0);
+        const int64_t src_step = loop.innerStride(1);
+        if (detail::copyTransposed(src, dst, loop, pool, grain, std::integral_constant<bool, (D >= 2)>()))
+        {
+            return;
+        }
+        auto row = [src, dst, src_step, dst_step](const int64_t* offset, uint32_t n) {
+            detail::copyRow(src + offset[1], src_step, dst + offset[0], dst_step, n);
+        };
+        if (pool == nullptr)
+        {
+            loop.forEachRow(row);
+            return;
+        }
+        pool->parallelFor(0, loop.numElements(), grain, [&loop, &row](uint64_t begin, uint64_t end) {
+            loop.forEachRow(begin, end, row);
+        });
+    }
+
+    // Sets every element of dst to value, optionally split across pool like copyStrided
+    template <class T, uint8_t D>
+    void fill(Tensor<T, D> dst,
+              const typename std::common_type<T>::type& value,
+              ThreadPool* pool = nullptr,
+              uint64_t grain = ThreadPool::DEFAULT_GRAIN)
+    {
+        const Shape<D> shape = dst.getShape();
+        const LoopNest<D, 1> loop(shape);
+        const int64_t step = loop.innerStride(0);
+        T* ptr = dst.data();
+        auto row = [ptr, step, &value](const int64_t* offset, uint32_t n) {
+            T* out = ptr + offset[0];
+            if (step == 1)
+            {
+                std::fill(out, out + n, value);
+                return;
+            }
+            for (uint32_t i = 0; i < n; ++i, out += step)
+            {
+                *out = value;
+            }
+        };
+        if (pool == nullptr)
+        {
+            loop.forEachRow(row);
+            return;
+        }
+        pool->parallelFor(0, loop.numElements(), grain, [&loop, &row](uint64_t begin, uint64_t end) {
+            loop.forEachRow(begin, end, row);
+        });
+    }
+
     // This class handles creating the operator []
     template <class DERIVED, class DTYPE, uint8_t D>
     class ConstTensorIndexing
@@ -28,17 +326,17 @@ namespace mt
         static constexpr const uint8_t DIM = D;
         using DType = DTYPE;
 
-        Tensor<const DTYPE, D - 1> operator[](uint32_t i) const
+        Tensor<const DTYPE, D - 1> operator[](DimSize_t i) const
         {
             const Shape<D>& shape = static_cast<const DERIVED*>(this)->getShape();
             const DTYPE* ptr = static_cast<const DERIVED*>(this)->data();
-            ptr += shape.getStride(0) * i;
+            ptr += static_cast<Stride_t>(shape.getStride(0)) * static_cast<int64_t>(i);
             Shape<D - 1> out_shape = stripOuterDim(shape);
             return Tensor<const DTYPE, D - 1>(ptr, std::move(out_shape));
         }
 
         template <class... ARGS>
-        const DTYPE& operator()(ARGS&&... args) const
+        constexpr const DTYPE& operator()(ARGS&&... args) const
         {
             return *static_cast<const DERIVED*>(this)->ptr(std::forward<ARGS>(args)...);
         }
@@ -54,13 +352,15 @@ namespace mt
 
         void copyTo(Tensor<DTYPE, D> dst) const
         {
-            const Shape<D>& dst_shape = dst.getShape();
-            const Shape<D>& src_shape = static_cast<const DERIVED*>(this)->getShape();
-            assert(dst_shape[0] == src_shape[0]);
-            for (uint32_t i = 0; i < dst_shape[0]; ++i)
-            {
-                (*this)[i].copyTo(dst[i]);
-            }
+            const DERIVED& src = *static_cast<const DERIVED*>(this);
+            copyStrided<DTYPE, D>(src.data(), src.getShape(), dst.data(), dst.getShape());
+        }
+
+        // Parallel copy, chunks of grain elements are distributed over the threads of pool
+        void copyTo(Tensor<DTYPE, D> dst, ThreadPool& pool, uint64_t grain = ThreadPool::DEFAULT_GRAIN) const
+        {
+            const DERIVED& src = *static_cast<const DERIVED*>(this);
+            copyStrided<DTYPE, D>(src.data(), src.getShape(), dst.data(), dst.getShape(), &pool, grain);
         }
 
         // void const or non const based on what T is
@@ -82,21 +382,23 @@ namespace mt
       public:
         static constexpr const uint8_t DIM = 1;
         using DType = DTYPE;
-        const DTYPE& operator[](uint32_t i) const { return *static_cast<const DERIVED*>(this)->ptr(i); }
+        const DTYPE& operator[](DimSize_t i) const { return *static_cast<const DERIVED*>(this)->ptr(i); }
         template <class... ARGS>
-        const DTYPE& operator()(ARGS&&... args) const
+        constexpr const DTYPE& operator()(ARGS&&... args) const
         {
             return *static_cast<const DERIVED*>(this)->ptr(std::forward<ARGS>(args)...);
         }
         void copyTo(Tensor<DTYPE, 1> dst) const
         {
-            const Shape<1>& dst_shape = dst.getShape();
-            const Shape<1>& src_shape = static_cast<const DERIVED*>(this)->getShape();
-            assert(dst_shape[0] == src_shape[0]);
-            for (uint32_t i = 0; i < dst_shape[0]; ++i)
-            {
-                dst[i] = (*this)[i];
-            }
+            const DERIVED& src = *static_cast<const DERIVED*>(this);
+            copyStrided<DTYPE, 1>(src.data(), src.getShape(), dst.data(), dst.getShape());
+        }
+
+        // Parallel copy, chunks of grain elements are distributed over the threads of pool
+        void copyTo(Tensor<DTYPE, 1> dst, ThreadPool& pool, uint64_t grain = ThreadPool::DEFAULT_GRAIN) const
+        {
+            const DERIVED& src = *static_cast<const DERIVED*>(this);
+            copyStrided<DTYPE, 1>(src.data(), src.getShape(), dst.data(), dst.getShape(), &pool, grain);
         }
 
         template <uint8_t N>
@@ -115,11 +417,11 @@ namespace mt
     class TensorIndexing : public ConstTensorIndexing<DERIVED, DTYPE, D>
     {
       public:
-        Tensor<DTYPE, D - 1> operator[](uint32_t i)
+        Tensor<DTYPE, D - 1> operator[](DimSize_t i)
         {
             const Shape<D> shape = static_cast<DERIVED*>(this)->getShape();
             DTYPE* ptr = static_cast<DERIVED*>(this)->data();
-            ptr += shape.getStride(0) * i;
+            ptr += static_cast<Stride_t>(shape.getStride(0)) * static_cast<int64_t>(i);
             Shape<D - 1> out_shape = stripOuterDim(shape);
             return Tensor<DTYPE, D - 1>(ptr, std::move(out_shape));
         }
@@ -157,7 +459,7 @@ namespace mt
         : public ConstTensorIndexing<DERIVED, DTYPE, 1>
     {
       public:
-        DTYPE& operator[](uint32_t i) { return *static_cast<DERIVED*>(this)->ptr(i); }
+        DTYPE& operator[](DimSize_t i) { return *static_cast<DERIVED*>(this)->ptr(i); }
 
         template <class... ARGS>
         DTYPE& operator()(ARGS&&... args)
@@ -203,27 +505,35 @@ namespace mt
         Shape<D> m_shape;
 
       public:
-        Tensor(T* ptr = nullptr, Shape<D> shape = Shape<D>()) : m_ptr(ptr), m_shape(shape) {}
-        Tensor(Tensor<T, D>& other) : m_ptr(other.data()), m_shape(other.getShape()) {}
-        Tensor(const Tensor& other) : m_ptr(other.data()), m_shape(other.getShape()) {}
-        Tensor(Tensor&& other) : m_ptr(other.data()), m_shape(other.getShape()) {}
+        constexpr Tensor(T* ptr = nullptr, Shape<D> shape = Shape<D>()) : m_ptr(ptr), m_shape(shape) {}
+        // A view is a pointer and a shape, copies are trivial
+        Tensor(const Tensor& other) = default;
+        Tensor(Tensor&& other) = default;
 
         Tensor& operator=(const Tensor&) = default;
         Tensor& operator=(Tensor&&) = default;
 
-        Tensor& operator=(const std::vector<T>& data)
+        // Declared for the element type without const, std::vector<const T> cannot be instantiated
+        Tensor& operator=(const std::vector<typename std::remove_const<T>::type>& data)
         {
             assert(data.size() == m_shape.numElements());
-            const size_t size = m_shape.numElements();
-            for (size_t i = 0; i < size; ++i)
+            const ElementIterator<T, D> end(m_ptr, m_shape, true);
+            auto src = data.begin();
+            for (ElementIterator<T, D> itr(m_ptr, m_shape); itr != end; ++itr, ++src)
             {
-                // This accounts for reverse indexing, etc
-                const size_t idx = m_shape.index(i);
-                m_ptr[idx] = data[i];
+                *itr = *src;
             }
             return *this;
         }
 
+        // Evaluates a lazy expression from Expression.hpp into the elements of this view
+        template <class E>
+        Tensor& operator=(const Expression<E>& expr)
+        {
+            assign(*this, expr);
+            return *this;
+        }
+
         template <class... ARGS>
         T* ptr(ARGS&&... args)
         {
@@ -232,10 +542,9 @@ namespace mt
         }
 
         template <class... ARGS>
-        const T* ptr(ARGS&&... args) const
+        constexpr const T* ptr(ARGS&&... args) const
         {
-            const size_t index = m_shape.index(std::forward<ARGS>(args)...);
-            return &m_ptr[index];
+            return m_ptr + m_shape.index(std::forward<ARGS>(args)...);
         }
 
         template <uint8_t N>
@@ -243,8 +552,8 @@ namespace mt
         {
         }
 
-        MT_XINLINE Shape<D> getShape() const { return m_shape; }
-        MT_XINLINE const T* data() const { return m_ptr; }
+        MT_XINLINE constexpr Shape<D> getShape() const { return m_shape; }
+        MT_XINLINE constexpr const T* data() const { return m_ptr; }
         MT_XINLINE T* data() { return m_ptr; }
     };
 
@@ -257,32 +566,24 @@ namespace mt
         Shape<D> m_shape;
 
       public:
-        Tensor(T* ptr = nullptr, Shape<D> shape = Shape<D>()) : m_ptr(ptr), m_shape(shape) {}
+        constexpr Tensor(T* ptr = nullptr, Shape<D> shape = Shape<D>()) : m_ptr(ptr), m_shape(shape) {}
 
-        template <class U>
+        template <class U, class = typename std::enable_if<!std::is_same<U, T>::value>::type>
         Tensor(Tensor<U, D>& other) : m_ptr(static_cast<void*>(other.data()))
         {
             const Shape<D>& other_shape = other.getShape();
             m_shape = copyScaled<sizeof(U), 1>(other_shape);
         }
 
-        template <class U>
+        template <class U, class = typename std::enable_if<!std::is_same<U, T>::value>::type>
         Tensor(Tensor<U, D>&& other) : m_ptr(static_cast<T*>(other.data()))
         {
             const Shape<D>& other_shape = other.getShape();
             m_shape = copyScaled<sizeof(U), 1>(other_shape);
         }
 
-        Tensor(Tensor& other) : m_ptr(other.data())
-        {
-            const Shape<D>& other_shape = other.getShape();
-            m_shape = other.m_shape;
-        }
-
-        Tensor(Tensor&& other) : m_ptr(other.data())
-        {
-            m_shape = other.m_shape;
-        }
+        Tensor(const Tensor& other) = default;
+        Tensor(Tensor&& other) = default;
 
         Tensor& operator=(const Tensor&) = default;
         Tensor& operator=(Tensor&&) = default;
@@ -301,8 +602,8 @@ namespace mt
             return m_ptr + index;
         }
 
-        MT_XINLINE const Shape<D>& getShape() const { return m_shape; }
-        MT_XINLINE const T* data() const { return m_ptr; }
+        MT_XINLINE constexpr const Shape<D>& getShape() const { return m_shape; }
+        MT_XINLINE constexpr const T* data() const { return m_ptr; }
         MT_XINLINE T* data() { return m_ptr; }
 
         template <class U>
@@ -327,7 +628,7 @@ namespace mt
       public:
         static constexpr const uint8_t DIM = 0;
         using DType = T;
-        Tensor(T* ptr = nullptr, Shape<0> = Shape<0>()) : m_ptr(ptr) {}
+        constexpr Tensor(T* ptr = nullptr, Shape<0> = Shape<0>()) : m_ptr(ptr) {}
 
         template <class... ARGS>
         const T* ptr(ARGS&&... args) const
@@ -368,6 +669,57 @@ namespace mt
         }
     };
 
+    // View with the dimensions reordered, dimension i of the result is dimension order[i] of tensor.
+    // No data moves, use copyTo or contiguous to materialize the new layout.
+    template <class T, uint8_t D>
+    Tensor<T, D> permute(Tensor<T, D> tensor, const uint8_t (&order)[D])
+    {
+        return Tensor<T, D>(tensor.data(), permuteShape(tensor.getShape(), order));
+    }
+
+    // View with dimensions a and b swapped
+    template <class T, uint8_t D>
+    Tensor<T, D> transpose(Tensor<T, D> tensor, uint8_t a, uint8_t b)
+    {
+        uint8_t order[D];
+        for (uint8_t i = 0; i < D; ++i)
+        {
+            order[i] = i == a ? b : (i == b ? a : i);
+        }
+        return permute(tensor, order);
+    }
+
+    // View of the elements selected by one range per leading dimension, the remaining dimensions are kept
+    // whole. Only the pointer and shape change, the view aliases the data of tensor.
+    template <class T, uint8_t D, class... RANGES>
+    Tensor<T, D> slice(Tensor<T, D> tensor, const Range& range, const RANGES&... ranges)
+    {
+        static_assert(sizeof...(RANGES) < D, "At most one range per dimension");
+        const Range all[] = {range, ranges...};
+        Shape<D> shape = tensor.getShape();
+        int64_t offset = 0;
+        for (uint8_t i = 0; i <= sizeof...(RANGES); ++i)
+        {
+            offset += sliceDim(shape, i, all[i]);
+        }
+        return Tensor<T, D>(tensor.data() + offset, shape);
+    }
+
+    // Read only view of tensor repeated to shape without copying, see broadcastShape
+    template <class T, uint8_t D, uint8_t N>
+    Tensor<const T, N> broadcastTo(const Tensor<T, D>& tensor, const Shape<N>& shape)
+    {
+        return Tensor<const T, N>(tensor.data(), broadcastShape(tensor.getShape(), shape));
+    }
+
+    // Whether two views share memory, see memoryOverlap in Overlap.hpp
+    template <class A, class B, uint8_t D>
+    Overlap memoryOverlap(const Tensor<A, D>& a, const Tensor<B, D>& b)
+    {
+        static_assert(sizeof(A) == sizeof(B), "Views of different element sizes");
+        return memoryOverlap(a.data(), a.getShape(), b.data(), b.getShape(), sizeof(A));
+    }
+
     ///////////////////////////////////////////////////////////////////////////
     //            TensorIterator
     ///////////////////////////////////////////////////////////////////////////
@@ -395,7 +747,7 @@ namespace mt
     class TensorIterator<T, 0>
     {
         T* m_ptr;
-        size_t m_stride;
+        int64_t m_stride;
 
       public:
         TensorIterator(T* ptr, int64_t stride, Shape<0>) : m_ptr(ptr), m_stride(stride) {}
@@ -416,7 +768,7 @@ namespace mt
     {
         const auto& shape = tensor.getShape();
         Shape<D - 1> out_shape = stripOuterDim(shape);
-        const auto outer_stride = shape.getStride(0);
+        const int64_t outer_stride = static_cast<Stride_t>(shape.getStride(0));
         auto ptr = tensor.data();
         return TensorIterator<const T, D - 1>(ptr, outer_stride, out_shape);
     }
@@ -426,7 +778,7 @@ namespace mt
     {
         const auto& shape = tensor.getShape();
         Shape<D - 1> out_shape = stripOuterDim(shape);
-        const auto outer_stride = shape.getStride(0);
+        const int64_t outer_stride = static_cast<Stride_t>(shape.getStride(0));
         auto ptr = tensor.data();
         return TensorIterator<T, D - 1>(ptr, outer_stride, out_shape);
     }
@@ -436,7 +788,7 @@ namespace mt
     {
         const auto shape = tensor.getShape();
         Shape<D - 1> out_shape = stripOuterDim(shape);
-        const auto outer_stride = shape.getStride(0);
+        const int64_t outer_stride = static_cast<Stride_t>(shape.getStride(0));
         const auto step = outer_stride * shape[0];
         auto ptr = tensor.data();
         ptr += step;
@@ -448,7 +800,7 @@ namespace mt
     {
         const auto shape = tensor.getShape();
         Shape<D - 1> out_shape = stripOuterDim(shape);
-        const auto outer_stride = shape.getStride(0);
+        const int64_t outer_stride = static_cast<Stride_t>(shape.getStride(0));
         const auto step = outer_stride * shape[0];
         auto ptr = tensor.data();
         return TensorIterator<T, D - 1>(ptr + step, outer_stride, out_shape);
@@ -460,19 +812,160 @@ namespace mt
         os << value;
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    //            ElementIterator
+    ///////////////////////////////////////////////////////////////////////////
+    // Visits every element of a strided tensor in row major order. The position is tracked with one
+    // counter per dimension, when the innermost counter wraps the carry is propagated outwards and the
+    // pointer is rewound, so advancing never needs a division.
     template <class T, uint8_t D>
-    void printTensor(std::ostream& os, const mt::Tensor<T, D>& tensor, const std::string& indent = " ")
+    class ElementIterator
     {
-        size_t i = 0;
-        for (const auto& itr : tensor)
+        T* m_ptr;
+        DimSize_t m_index[D];
+        DimSize_t m_size[D];
+        int64_t m_stride[D];
+        // Pointer adjustment applied when dimension d wraps, rewinds d and steps d - 1
+        int64_t m_wrap[D];
+
+        void carry()
+        {
+            for (uint8_t d = D - 1; d > 0; --d)
+            {
+                m_index[d] = 0;
+                m_ptr += m_wrap[d];
+                if (++m_index[d - 1] < m_size[d - 1])
+                {
+                    return;
+                }
+            }
+        }
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::remove_const<T>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        // end constructs the past the end iterator, ie the outer index equals the outer size
+        ElementIterator(T* ptr, const Shape<D>& shape, bool end = false) : m_ptr(ptr)
+        {
+            bool empty = false;
+            for (uint8_t d = 0; d < D; ++d)
+            {
+                m_index[d] = 0;
+                m_size[d] = shape[d];
+                m_stride[d] = static_cast<Stride_t>(shape.getStride(d));
+                m_wrap[d] = d == 0 ? 0 : static_cast<Stride_t>(shape.getStride(d - 1)) - m_stride[d] * m_size[d];
+                empty = empty || m_size[d] == 0;
+            }
+            if (end || empty)
+            {
+                m_index[0] = m_size[0];
+                m_ptr += m_stride[0] * m_size[0];
+            }
+        }
+
+        T& operator*() const { return *m_ptr; }
+        T* operator->() const { return m_ptr; }
+
+        ElementIterator& operator++()
         {
-            os << indent;
-            printTensor(os, itr, indent + " ");
-            ++i;
+            m_ptr += m_stride[D - 1];
+            if (++m_index[D - 1] == m_size[D - 1])
+            {
+                carry();
+            }
+            return *this;
+        }
+
+        ElementIterator operator++(int)
+        {
+            ElementIterator out = *this;
+            ++(*this);
+            return out;
         }
-        if (D >= 1)
+
+        bool operator==(const ElementIterator& other) const
+        {
+            return m_ptr == other.m_ptr && m_index[0] == other.m_index[0];
+        }
+        bool operator!=(const ElementIterator& other) const { return !(*this == other); }
+
+        // Position of the current element along dim
+        DimSize_t index(uint8_t dim) const { return m_index[dim]; }
+
+        // Number of innermost dimensions that wrapped back to zero on the last increment
+        uint8_t carried() const
+        {
+            if (m_index[0] == m_size[0])
+            {
+                return D;
+            }
+            uint8_t out = 0;
+            while (out < D && m_index[D - 1 - out] == 0)
+            {
+                ++out;
+            }
+            return out;
+        }
+    };
+
+    template <class T, uint8_t D>
+    class ElementRange
+    {
+        T* m_ptr;
+        Shape<D> m_shape;
+
+      public:
+        ElementRange(T* ptr, const Shape<D>& shape) : m_ptr(ptr), m_shape(shape) {}
+
+        ElementIterator<T, D> begin() const { return ElementIterator<T, D>(m_ptr, m_shape); }
+        ElementIterator<T, D> end() const { return ElementIterator<T, D>(m_ptr, m_shape, true); }
+    };
+
+    // Flat iteration over every element, ie for(float& v : elements(tensor))
+    template <class T, uint8_t D>
+    ElementRange<const T, D> elements(const Tensor<T, D>& tensor)
+    {
+        return ElementRange<const T, D>(tensor.data(), tensor.getShape());
+    }
+
+    template <class T, uint8_t D>
+    ElementRange<T, D> elements(Tensor<T, D>& tensor)
+    {
+        return ElementRange<T, D>(tensor.data(), tensor.getShape());
+    }
+
+    // Each nesting level is prefixed with indent plus one space per level and closed with a new line
+    template <class T, uint8_t D>
+    void printTensor(std::ostream& os, const mt::Tensor<T, D>& tensor, const std::string& indent = " ")
+    {
+        const ElementRange<const T, D> range = elements(tensor);
+        if (range.begin() == range.end())
         {
             os << "\n";
+            return;
+        }
+        uint8_t opened = D;
+        for (ElementIterator<const T, D> itr = range.begin(); itr != range.end();)
+        {
+            for (uint8_t level = D - opened; level < D; ++level)
+            {
+                os << indent;
+                for (uint8_t i = 0; i < level; ++i)
+                {
+                    os << ' ';
+                }
+            }
+            printTensor(os, *itr, indent);
+            ++itr;
+            for (uint8_t i = 0; i < itr.carried(); ++i)
+            {
+                os << '\n';
+            }
+            opened = itr.carried() < D ? itr.carried() + 1 : D;
         }
     }
 
@@ -518,6 +1011,7 @@ namespace mt
         return TensorWrap<T>::wrap(data);
     }
 
+    MT_INDEX_NAMESPACE_END
 } // namespace mt
 
 namespace std
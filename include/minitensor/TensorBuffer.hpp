@@ -0,0 +1,101 @@
+#ifndef MINITENSOR_TENSOR_BUFFER_HPP
+#define MINITENSOR_TENSOR_BUFFER_HPP
+#include "Allocator.hpp"
+#include "Tensor.hpp"
+
+#include <type_traits>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Owning companion of Tensor. Storage is obtained from an Allocator, aligned to Allocator::ALIGNMENT
+    // and densely packed. The contents are uninitialized after construction or resize.
+    template <class T, uint8_t D>
+    class TensorBuffer
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "TensorBuffer does not run element destructors");
+
+        T* m_ptr = nullptr;
+        Shape<D> m_shape;
+        Allocator* m_allocator;
+
+        void release()
+        {
+            if (m_ptr != nullptr)
+            {
+                m_allocator->deallocate(m_ptr, m_shape.numElements() * sizeof(T));
+                m_ptr = nullptr;
+            }
+        }
+
+      public:
+        TensorBuffer(Shape<D> shape = Shape<D>(), Allocator* allocator = Allocator::getDefault())
+            : m_allocator(allocator)
+        {
+            resize(shape);
+        }
+
+        TensorBuffer(const TensorBuffer&) = delete;
+        TensorBuffer& operator=(const TensorBuffer&) = delete;
+
+        TensorBuffer(TensorBuffer&& other) : m_ptr(other.m_ptr), m_shape(other.m_shape), m_allocator(other.m_allocator)
+        {
+            other.m_ptr = nullptr;
+        }
+
+        TensorBuffer& operator=(TensorBuffer&& other)
+        {
+            if (this != &other)
+            {
+                release();
+                m_ptr = other.m_ptr;
+                m_shape = other.m_shape;
+                m_allocator = other.m_allocator;
+                other.m_ptr = nullptr;
+            }
+            return *this;
+        }
+
+        ~TensorBuffer() { release(); }
+
+        // Storage is only reallocated when the number of elements changes
+        void resize(Shape<D> shape)
+        {
+            shape.calculateStride();
+            if (m_ptr == nullptr || shape.numElements() != m_shape.numElements())
+            {
+                release();
+                const size_t bytes = shape.numElements() * sizeof(T);
+                m_ptr = bytes == 0 ? nullptr : static_cast<T*>(m_allocator->allocate(bytes));
+            }
+            m_shape = shape;
+        }
+
+        Tensor<T, D> view() { return Tensor<T, D>(m_ptr, m_shape); }
+        Tensor<const T, D> view() const { return Tensor<const T, D>(m_ptr, m_shape); }
+
+        operator Tensor<T, D>() { return view(); }
+        operator Tensor<const T, D>() const { return view(); }
+
+        MT_XINLINE Shape<D> getShape() const { return m_shape; }
+        MT_XINLINE const T* data() const { return m_ptr; }
+        MT_XINLINE T* data() { return m_ptr; }
+        MT_XINLINE Allocator* getAllocator() const { return m_allocator; }
+    };
+
+    // Dense row major copy of a view, for example to materialize a permute
+    template <class T, uint8_t D>
+    TensorBuffer<typename std::remove_const<T>::type, D> contiguous(const Tensor<T, D>& tensor,
+                                                                    ThreadPool* pool = nullptr)
+    {
+        typedef typename std::remove_const<T>::type DType;
+        TensorBuffer<DType, D> out(tensor.getShape());
+        copyStrided<DType, D>(tensor.data(), tensor.getShape(), out.data(), out.getShape(), pool);
+        return out;
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_TENSOR_BUFFER_HPP
@@ -0,0 +1,417 @@
+#ifndef MINITENSOR_TENSOR_STREAM_HPP
+#define MINITENSOR_TENSOR_STREAM_HPP
+#include "MappedFile.hpp"
+#include "Tensor.hpp"
+#include "TensorBuffer.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Stream files hold tensors of a fixed row shape appended along the outer dimension. A file header
+    // describing the element type and row shape is followed by chunks, each a chunk header with the number of
+    // rows and the dense row major elements. Everything is stored in host byte order. A chunk cut short, for
+    // example by a crash while writing, throws when it is reached, the chunks before it read normally.
+    namespace detail
+    {
+        struct StreamHeader
+        {
+            char magic[8];
+            // NumPy dtype string of the elements, zero padded
+            char descr[8];
+            uint32_t dims;
+        };
+
+        struct StreamChunkHeader
+        {
+            char magic[4];
+            uint32_t rows;
+        };
+
+        static constexpr const char STREAM_MAGIC[8] = {'M', 'T', 'S', 'T', 'R', 'E', 'A', 'M'};
+        static constexpr const char STREAM_CHUNK_MAGIC[4] = {'M', 'T', 'C', 'K'};
+
+        inline std::runtime_error streamError(const char* what, const std::string& path)
+        {
+            return std::runtime_error(std::string(what) + " '" + path + "'");
+        }
+    } // namespace detail
+
+    // Appends tensors of shape Shape<D - 1> to a stream file. Rows are gathered in a buffer of chunk_rows and
+    // written with one sequential write per chunk, call flush to force out a partial chunk. Failures throw
+    // std::runtime_error.
+    template <class T, uint8_t D>
+    class TensorWriter
+    {
+        static_assert(D > 1, "Rows need at least one dimension");
+
+        std::string m_path;
+        std::FILE* m_file = nullptr;
+        TensorBuffer<T, D> m_buffer;
+        uint32_t m_rows = 0;
+
+        void writeBytes(const void* data, size_t bytes)
+        {
+            if (std::fwrite(data, 1, bytes, m_file) != bytes)
+            {
+                throw detail::streamError("Unable to write", m_path);
+            }
+        }
+
+      public:
+        // Rows of the default chunk add up to about this many bytes
+        static constexpr const size_t DEFAULT_CHUNK_BYTES = 4 << 20;
+
+        TensorWriter(const std::string& path, Shape<D - 1> row_shape, uint32_t chunk_rows = 0) : m_path(path)
+        {
+            row_shape.calculateStride();
+            const size_t row_bytes = row_shape.numElements() * sizeof(T);
+            if (chunk_rows == 0)
+            {
+                chunk_rows = row_bytes >= DEFAULT_CHUNK_BYTES ? 1 : DEFAULT_CHUNK_BYTES / (row_bytes | 1);
+            }
+            Shape<D> shape;
+            shape.setShape(0, chunk_rows);
+            for (uint8_t i = 1; i < D; ++i)
+            {
+                shape.setShape(i, row_shape[i - 1]);
+            }
+            uint32_t sizes[D - 1];
+            for (uint8_t i = 0; i < D - 1; ++i)
+            {
+                // The file format stores 32 bit row sizes
+                if (row_shape[i] > std::numeric_limits<uint32_t>::max())
+                {
+                    throw detail::streamError("Row shape too large for", path);
+                }
+                sizes[i] = static_cast<uint32_t>(row_shape[i]);
+            }
+            m_buffer.resize(shape);
+
+            m_file = std::fopen(path.c_str(), "wb");
+            if (m_file == nullptr)
+            {
+                throw detail::streamError("Unable to create", path);
+            }
+            // Chunks are already large, the FILE buffer would only add a copy
+            std::setvbuf(m_file, nullptr, _IONBF, 0);
+            detail::StreamHeader header = {};
+            std::memcpy(header.magic, detail::STREAM_MAGIC, sizeof(header.magic));
+            std::strncpy(header.descr, NpyDescr<T>::value(), sizeof(header.descr));
+            header.dims = D - 1;
+            try
+            {
+                writeBytes(&header, sizeof(header));
+                writeBytes(sizes, sizeof(sizes));
+            }
+            catch (...)
+            {
+                // The destructor does not run for a constructor that throws
+                std::fclose(m_file);
+                m_file = nullptr;
+                throw;
+            }
+        }
+
+        TensorWriter(const TensorWriter&) = delete;
+        TensorWriter& operator=(const TensorWriter&) = delete;
+
+        ~TensorWriter()
+        {
+            if (m_file != nullptr)
+            {
+                try
+                {
+                    flush();
+                }
+                catch (...)
+                {
+                }
+                std::fclose(m_file);
+            }
+        }
+
+        // Appends one row, it may be any strided view of the row shape
+        template <class A>
+        void write(const Tensor<A, D - 1>& row)
+        {
+            const Tensor<const T, D - 1> src(row.data(), row.getShape());
+            src.copyTo(m_buffer.view()[m_rows]);
+            if (++m_rows == m_buffer.getShape()[0])
+            {
+                flush();
+            }
+        }
+
+        // Appends every row of rows in order
+        template <class A>
+        void write(const Tensor<A, D>& rows)
+        {
+            const Tensor<const T, D> src(rows.data(), rows.getShape());
+            for (TensorIterator<const T, D - 1> itr = begin(src); itr != end(src); ++itr)
+            {
+                write(*itr);
+            }
+        }
+
+        void flush()
+        {
+            if (m_rows != 0)
+            {
+                detail::StreamChunkHeader header;
+                std::memcpy(header.magic, detail::STREAM_CHUNK_MAGIC, sizeof(header.magic));
+                header.rows = m_rows;
+                writeBytes(&header, sizeof(header));
+                writeBytes(m_buffer.data(), m_rows * rowShape().numElements() * sizeof(T));
+                m_rows = 0;
+            }
+            if (std::fflush(m_file) != 0)
+            {
+                throw detail::streamError("Unable to flush", m_path);
+            }
+        }
+
+        Shape<D - 1> rowShape() const { return stripOuterDim(m_buffer.getShape()); }
+    };
+
+    // Reads a stream file one chunk at a time. With prefetch a background thread reads the next chunk while
+    // the current one is processed, so reading overlaps with computation. Only two chunks are held in memory
+    // regardless of the file size.
+    template <class T, uint8_t D>
+    class TensorReader
+    {
+        static_assert(D > 1, "Rows need at least one dimension");
+
+        struct Chunk
+        {
+            TensorBuffer<T, 1> data;
+            uint32_t rows = 0;
+        };
+
+        std::string m_path;
+        std::FILE* m_file = nullptr;
+        // Bytes of the file past the position of the reader
+        uint64_t m_left = 0;
+        Shape<D - 1> m_row_shape;
+        Chunk m_chunks[2];
+        int m_current = -1;
+
+        bool m_prefetch;
+        std::thread m_thread;
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        std::deque<int> m_free;
+        std::deque<int> m_ready;
+        bool m_done = false;
+        bool m_stop = false;
+        std::exception_ptr m_error;
+
+        // Reads the next chunk into chunk, false at the end of the stream
+        bool readChunk(Chunk& chunk)
+        {
+            if (m_left == 0)
+            {
+                return false;
+            }
+            detail::StreamChunkHeader header;
+            if (m_left < sizeof(header) || std::fread(&header, sizeof(header), 1, m_file) != 1)
+            {
+                throw detail::streamError("Truncated chunk in", m_path);
+            }
+            m_left -= sizeof(header);
+            if (std::memcmp(header.magic, detail::STREAM_CHUNK_MAGIC, sizeof(header.magic)) != 0)
+            {
+                throw detail::streamError("Corrupt chunk in", m_path);
+            }
+            // The row count comes from the file, it is trusted only as far as the bytes left to back it
+            const uint64_t row_elements = m_row_shape.numElements();
+            const uint64_t row_bytes = row_elements * sizeof(T);
+            if (row_bytes != 0 && header.rows > m_left / row_bytes)
+            {
+                throw detail::streamError("Truncated chunk in", m_path);
+            }
+            const uint64_t elements = header.rows * row_elements;
+            if (elements > std::numeric_limits<DimSize_t>::max())
+            {
+                throw detail::streamError("Chunk too large in", m_path);
+            }
+            if (chunk.data.getShape()[0] < elements)
+            {
+                chunk.data.resize(Shape<1>(static_cast<DimSize_t>(elements)));
+            }
+            if (std::fread(chunk.data.data(), sizeof(T), static_cast<size_t>(elements), m_file) != elements)
+            {
+                throw detail::streamError("Truncated chunk in", m_path);
+            }
+            m_left -= elements * sizeof(T);
+            chunk.rows = header.rows;
+            return true;
+        }
+
+        void prefetchLoop()
+        {
+            while (true)
+            {
+                int index;
+                {
+                    std::unique_lock<std::mutex> lock(m_mtx);
+                    m_cv.wait(lock, [this] { return m_stop || !m_free.empty(); });
+                    if (m_stop)
+                    {
+                        return;
+                    }
+                    index = m_free.front();
+                    m_free.pop_front();
+                }
+                bool read = false;
+                std::exception_ptr error;
+                try
+                {
+                    read = readChunk(m_chunks[index]);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    if (read)
+                    {
+                        m_ready.push_back(index);
+                    }
+                    else
+                    {
+                        m_done = true;
+                        m_error = error;
+                    }
+                }
+                m_cv.notify_all();
+                if (!read)
+                {
+                    return;
+                }
+            }
+        }
+
+      public:
+        explicit TensorReader(const std::string& path, bool prefetch = true) : m_path(path), m_prefetch(prefetch)
+        {
+            m_file = std::fopen(path.c_str(), "rb");
+            if (m_file == nullptr)
+            {
+                throw detail::streamError("Unable to open", path);
+            }
+            detail::StreamHeader header;
+            uint32_t sizes[D - 1];
+            const bool valid = std::fread(&header, sizeof(header), 1, m_file) == 1 &&
+                               std::memcmp(header.magic, detail::STREAM_MAGIC, sizeof(header.magic)) == 0 &&
+                               header.dims == D - 1 && std::fread(sizes, sizeof(sizes), 1, m_file) == 1;
+            if (!valid || std::strncmp(header.descr, NpyDescr<T>::value(), sizeof(header.descr)) != 0)
+            {
+                std::fclose(m_file);
+                throw detail::streamError(valid ? "Element type does not match" : "Not a stream file of this rank",
+                                          path);
+            }
+            for (uint8_t i = 0; i < D - 1; ++i)
+            {
+                m_row_shape.setShape(i, sizes[i]);
+            }
+            m_row_shape.calculateStride();
+            // Chunk headers are checked against the size of the file
+            const long start = std::ftell(m_file);
+            const long end = start >= 0 && std::fseek(m_file, 0, SEEK_END) == 0 ? std::ftell(m_file) : -1;
+            if (end < start || std::fseek(m_file, start, SEEK_SET) != 0)
+            {
+                std::fclose(m_file);
+                throw detail::streamError("Unable to seek", path);
+            }
+            m_left = static_cast<uint64_t>(end - start);
+            if (m_prefetch)
+            {
+                m_free.push_back(0);
+                m_free.push_back(1);
+                m_thread = std::thread(&TensorReader::prefetchLoop, this);
+            }
+        }
+
+        TensorReader(const TensorReader&) = delete;
+        TensorReader& operator=(const TensorReader&) = delete;
+
+        ~TensorReader()
+        {
+            if (m_thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    m_stop = true;
+                }
+                m_cv.notify_all();
+                m_thread.join();
+            }
+            std::fclose(m_file);
+        }
+
+        // Points chunk at the rows of the next chunk and returns true, or returns false at the end of the stream.
+        // The view stays valid until the next call.
+        bool next(Tensor<const T, D>& chunk)
+        {
+            int index = 0;
+            if (!m_prefetch)
+            {
+                if (!readChunk(m_chunks[0]))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                if (m_current >= 0)
+                {
+                    // Done with the previous chunk, hand its buffer back to the prefetch thread
+                    m_free.push_back(m_current);
+                    m_current = -1;
+                    m_cv.notify_all();
+                }
+                m_cv.wait(lock, [this] { return m_done || !m_ready.empty(); });
+                if (m_ready.empty())
+                {
+                    if (m_error)
+                    {
+                        std::rethrow_exception(m_error);
+                    }
+                    return false;
+                }
+                index = m_ready.front();
+                m_ready.pop_front();
+                m_current = index;
+            }
+            Shape<D> shape;
+            shape.setShape(0, m_chunks[index].rows);
+            for (uint8_t i = 1; i < D; ++i)
+            {
+                shape.setShape(i, m_row_shape[i - 1]);
+            }
+            shape.calculateStride();
+            chunk = Tensor<const T, D>(m_chunks[index].data.data(), shape);
+            return true;
+        }
+
+        Shape<D - 1> rowShape() const { return m_row_shape; }
+    };
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_TENSOR_STREAM_HPP
@@ -0,0 +1,282 @@
+#ifndef MINITENSOR_THREAD_POOL_HPP
+#define MINITENSOR_THREAD_POOL_HPP
+#include "defines.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mt
+{
+    MT_INDEX_NAMESPACE_BEGIN
+
+    // Fork join pool for data parallel loops. Every worker owns a deque of index ranges. A worker splits
+    // the range it runs in half until it is no larger than the grain, keeps the lower half and pushes the
+    // upper half onto its deque where idle workers steal it from the front. The thread calling parallelFor
+    // takes part in the work, so parallel loops nested inside a parallel loop cannot deadlock.
+    class ThreadPool
+    {
+      public:
+        // Elements per task when the caller has no better estimate, large enough to hide the scheduling cost
+        static constexpr const uint64_t DEFAULT_GRAIN = 1 << 16;
+
+        // threads counts the calling thread, a pool of 1 runs everything inline
+        explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
+        {
+            const size_t workers = threads > 1 ? threads - 1 : 0;
+            // One queue per worker plus one shared by threads outside the pool
+            m_queues.reset(new Queue[workers + 1]);
+            m_num_queues = workers + 1;
+            m_workers.reserve(workers);
+            for (size_t i = 0; i < workers; ++i)
+            {
+                m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            for (std::thread& worker : m_workers)
+            {
+                worker.join();
+            }
+        }
+
+        // Number of threads that execute a parallelFor, including the caller
+        size_t concurrency() const { return m_workers.size() + 1; }
+
+        // Calls fn(uint64_t begin, uint64_t end) on disjoint sub ranges covering [begin, end) and returns once
+        // every call finished. Sub ranges hold at most grain indices. The first exception thrown by fn is
+        // rethrown here after the remaining ranges completed.
+        template <class F>
+        void parallelFor(uint64_t begin, uint64_t end, uint64_t grain, F&& fn)
+        {
+            if (end <= begin)
+            {
+                return;
+            }
+            grain = grain == 0 ? 1 : grain;
+            if (m_workers.empty() || end - begin <= grain)
+            {
+                fn(begin, end);
+                return;
+            }
+            typedef typename std::remove_reference<F>::type Fn;
+            void* erased = const_cast<void*>(static_cast<const void*>(&fn));
+            Job job(&Job::template invoke<Fn>, erased, grain, end - begin);
+            const size_t queue = currentQueue();
+            execute(queue, Task{&job, begin, end});
+            while (job.remaining.load(std::memory_order_acquire) != 0)
+            {
+                Task task;
+                if (take(queue, task))
+                {
+                    execute(queue, task);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            if (job.error)
+            {
+                std::rethrow_exception(job.error);
+            }
+        }
+
+        static ThreadPool* getDefault();
+        static void setDefault(ThreadPool* pool);
+
+      private:
+        struct Job
+        {
+            template <class Fn>
+            static void invoke(void* fn, uint64_t begin, uint64_t end)
+            {
+                (*static_cast<Fn*>(fn))(begin, end);
+            }
+
+            Job(void (*call_)(void*, uint64_t, uint64_t), void* fn_, uint64_t grain_, uint64_t size)
+                : call(call_), fn(fn_), grain(grain_), remaining(size)
+            {
+            }
+
+            void (*call)(void*, uint64_t, uint64_t);
+            void* fn;
+            uint64_t grain;
+            // Indices not yet processed, the job is done and may be destroyed once this reaches 0
+            std::atomic<uint64_t> remaining;
+            std::mutex mtx;
+            std::exception_ptr error;
+        };
+
+        struct Task
+        {
+            Job* job;
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        struct Queue
+        {
+            std::mutex mtx;
+            std::deque<Task> tasks;
+        };
+
+        struct WorkerSlot
+        {
+            const ThreadPool* pool;
+            size_t queue;
+        };
+
+        static WorkerSlot& currentWorker()
+        {
+            static thread_local WorkerSlot slot = {nullptr, 0};
+            return slot;
+        }
+
+        size_t currentQueue() const
+        {
+            const WorkerSlot& slot = currentWorker();
+            return slot.pool == this ? slot.queue : m_num_queues - 1;
+        }
+
+        void push(size_t queue, const Task& task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_queues[queue].mtx);
+                m_queues[queue].tasks.push_back(task);
+                m_queued.fetch_add(1, std::memory_order_release);
+            }
+            {
+                // Pairs with the predicate check in workerLoop so the notification cannot be lost
+                std::lock_guard<std::mutex> lock(m_mtx);
+            }
+            m_cv.notify_one();
+        }
+
+        // Newest task of our own queue first, it is the smallest and its data is most likely still cached,
+        // otherwise the oldest, largest, task of another queue
+        bool take(size_t queue, Task& task)
+        {
+            for (size_t i = 0; i < m_num_queues; ++i)
+            {
+                Queue& q = m_queues[(queue + i) % m_num_queues];
+                std::lock_guard<std::mutex> lock(q.mtx);
+                if (q.tasks.empty())
+                {
+                    continue;
+                }
+                if (i == 0)
+                {
+                    task = q.tasks.back();
+                    q.tasks.pop_back();
+                }
+                else
+                {
+                    task = q.tasks.front();
+                    q.tasks.pop_front();
+                }
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        void execute(size_t queue, Task task)
+        {
+            Job* job = task.job;
+            while (task.end - task.begin > job->grain)
+            {
+                const uint64_t mid = task.begin + (task.end - task.begin) / 2;
+                push(queue, Task{job, mid, task.end});
+                task.end = mid;
+            }
+            try
+            {
+                job->call(job->fn, task.begin, task.end);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(job->mtx);
+                if (!job->error)
+                {
+                    job->error = std::current_exception();
+                }
+            }
+            // Last access to job, the caller may return as soon as remaining reaches 0
+            job->remaining.fetch_sub(task.end - task.begin, std::memory_order_acq_rel);
+        }
+
+        void workerLoop(size_t queue)
+        {
+            currentWorker() = WorkerSlot{this, queue};
+            while (true)
+            {
+                Task task;
+                if (take(queue, task))
+                {
+                    execute(queue, task);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(m_mtx);
+                m_cv.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_acquire) != 0; });
+                if (m_stop)
+                {
+                    return;
+                }
+            }
+        }
+
+        std::unique_ptr<Queue[]> m_queues;
+        size_t m_num_queues = 0;
+        std::vector<std::thread> m_workers;
+        std::atomic<size_t> m_queued{0};
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+        bool m_stop = false;
+    };
+
+    namespace detail
+    {
+        inline ThreadPool& defaultThreadPool()
+        {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        inline ThreadPool*& defaultThreadPoolPtr()
+        {
+            static ThreadPool* pool = &defaultThreadPool();
+            return pool;
+        }
+    } // namespace detail
+
+    // The default pool is created on first use with one thread per hardware thread
+    inline ThreadPool* ThreadPool::getDefault() { return detail::defaultThreadPoolPtr(); }
+
+    // Passing nullptr restores the built in pool
+    inline void ThreadPool::setDefault(ThreadPool* pool)
+    {
+        detail::defaultThreadPoolPtr() = pool != nullptr ? pool : &detail::defaultThreadPool();
+    }
+
+    MT_INDEX_NAMESPACE_END
+} // namespace mt
+
+#endif // MINITENSOR_THREAD_POOL_HPP
@@ -3,4 +3,13 @@
 
 #define MT_XINLINE inline
 
+// Everything lives in an inline namespace named after the index width, so code built with and without MT_INDEX_64
+// links against different symbols instead of silently mixing Shape layouts
+#ifdef MT_INDEX_64
+#define MT_INDEX_NAMESPACE_BEGIN inline namespace index64 {
+#else
+#define MT_INDEX_NAMESPACE_BEGIN inline namespace index32 {
+#endif
+#define MT_INDEX_NAMESPACE_END }
+
 #endif // MINITENSOR_DEFINITIONS_HPP
\ No newline at end of file
@@ -1,9 +1,14 @@
 #ifndef MINITENSOR_UTILITIES_HPP
 #define MINITENSOR_UTILITIES_HPP
+#include "defines.hpp"
+
+#include <cstddef>
 #include <utility>
 
 namespace mt
 {
+    MT_INDEX_NAMESPACE_BEGIN
+
     template <size_t... I>
     struct IndexSequence
     {
@@ -37,6 +42,8 @@ namespace mt
     {
         return Construct(src[Indecies]...);
     }
+
+    MT_INDEX_NAMESPACE_END
 } // namespace mt
 
 #endif // MINITENSOR_UTILITIES_HPP
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Blocked.hpp>
+
+#include <vector>
+
+TEST(blocked, channel_layout)
+{
+    // 20 channels in blocks of 8, the last block is half padding
+    const mt::BlockedShape<4, 1> layout = mt::channelBlocked(mt::Shape<4>(2, 20, 3, 5), 8);
+    ASSERT_TRUE(layout.isBlocked(1));
+    ASSERT_FALSE(layout.isBlocked(2));
+    ASSERT_EQ(layout.blockSize(1), 8);
+    ASSERT_EQ(layout.blockSize(0), 1);
+    ASSERT_EQ(layout.blockedDim(0), 1);
+    ASSERT_EQ(layout.physicalShape(), mt::Shape<5>(2, 3, 3, 5, 8));
+    ASSERT_EQ(layout.numElements(), 2 * 20 * 3 * 5);
+    ASSERT_EQ(layout.numPhysicalElements(), 2 * 24 * 3 * 5);
+    for (uint32_t n = 0; n < 2; ++n)
+    {
+        for (uint32_t c = 0; c < 20; ++c)
+        {
+            for (uint32_t h = 0; h < 3; ++h)
+            {
+                for (uint32_t w = 0; w < 5; ++w)
+                {
+                    const size_t expected = (((n * 3 + c / 8) * 3 + h) * 5 + w) * 8 + c % 8;
+                    ASSERT_EQ(layout.index(n, c, h, w), expected);
+                }
+            }
+        }
+    }
+    ASSERT_EQ(layout.index(-1, -1, 0, 0), layout.index(1, 19, 0, 0));
+}
+
+TEST(blocked, channel_round_trip)
+{
+    const uint32_t n = 2;
+    const uint32_t c = 20;
+    const uint32_t h = 7;
+    const uint32_t w = 9;
+    std::vector<float> plain(n * c * h * w);
+    for (size_t i = 0; i < plain.size(); ++i)
+    {
+        plain[i] = static_cast<float>(i);
+    }
+    const mt::Tensor<const float, 4> nchw(plain.data(), {n, c, h, w});
+    const mt::BlockedShape<4, 1> layout = mt::channelBlocked(nchw.getShape(), 16);
+    std::vector<float> storage(layout.numPhysicalElements(), -1);
+    const mt::BlockedTensor<float, 4, 1> blocked(storage.data(), layout);
+    mt::toBlocked(nchw, blocked);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (uint32_t j = 0; j < c; ++j)
+        {
+            for (uint32_t y = 0; y < h; ++y)
+            {
+                for (uint32_t x = 0; x < w; ++x)
+                {
+                    ASSERT_EQ(blocked(i, j, y, x), nchw(i, j, y, x));
+                }
+            }
+        }
+    }
+    // Channels 20 to 31 of the last block are zero padding
+    mt::Tensor<float, 5> physical = blocked.physical();
+    for (uint32_t j = c % 16; j < 16; ++j)
+    {
+        ASSERT_EQ(physical(1, 1, 6, 8, j), 0);
+    }
+
+    // Back into an interleaved NHWC view, in parallel
+    std::vector<float> interleaved(plain.size());
+    const uint8_t order[] = {0, 3, 1, 2};
+    mt::Tensor<float, 4> nhwc(interleaved.data(), {n, h, w, c});
+    mt::ThreadPool pool(3);
+    mt::fromBlocked(mt::BlockedTensor<const float, 4, 1>(blocked), mt::permute(nhwc, order), &pool, 64);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (uint32_t j = 0; j < c; ++j)
+        {
+            for (uint32_t y = 0; y < h; ++y)
+            {
+                for (uint32_t x = 0; x < w; ++x)
+                {
+                    ASSERT_EQ(nhwc(i, y, x, j), nchw(i, j, y, x));
+                }
+            }
+        }
+    }
+}
+
+TEST(blocked, tiled)
+{
+    const uint32_t rows = 13;
+    const uint32_t cols = 10;
+    std::vector<int> plain(rows * cols);
+    for (size_t i = 0; i < plain.size(); ++i)
+    {
+        plain[i] = static_cast<int>(i);
+    }
+    mt::Tensor<int, 2> matrix(plain.data(), {rows, cols});
+    const mt::BlockedShape<2, 2> layout = mt::tiled(matrix.getShape(), 4, 8);
+    ASSERT_EQ(layout.physicalShape(), mt::Shape<4>(4, 2, 4, 8));
+    std::vector<int> storage(layout.numPhysicalElements(), -1);
+    const mt::BlockedTensor<int, 2, 2> tiles(storage.data(), layout);
+    mt::toBlocked(matrix, tiles);
+    mt::Tensor<int, 4> physical = tiles.physical();
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        for (uint32_t j = 0; j < 16; ++j)
+        {
+            const int expected = i < rows && j < cols ? matrix(i, j) : 0;
+            ASSERT_EQ(physical(i / 4, j / 8, i % 4, j % 8), expected) << i << " " << j;
+            if (i < rows && j < cols)
+            {
+                ASSERT_EQ(tiles(i, j), expected);
+            }
+        }
+    }
+
+    // Into the transpose
+    std::vector<int> transposed(plain.size());
+    mt::Tensor<int, 2> out(transposed.data(), {cols, rows});
+    mt::fromBlocked(tiles, mt::transpose(out, 0, 1));
+    for (uint32_t i = 0; i < rows; ++i)
+    {
+        for (uint32_t j = 0; j < cols; ++j)
+        {
+            ASSERT_EQ(out(j, i), matrix(i, j));
+        }
+    }
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include "test_utils.hpp"
+
+#include <minitensor/Conv.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    using mt_test::randomData;
+
+    // Input position of tap k of output o along one axis, or -1 in the padding
+    int64_t inputIndex(const mt::Window2d& window, uint8_t axis, uint32_t o, uint32_t k, uint32_t size)
+    {
+        const int64_t i = static_cast<int64_t>(o) * window.stride[axis] - window.padding[axis] +
+                          static_cast<int64_t>(k) * window.dilation[axis];
+        return i < 0 || i >= size ? -1 : i;
+    }
+
+    template <class T, class A, class B>
+    void checkConv(mt::Tensor<A, 4> in,
+                   mt::Tensor<B, 4> weights,
+                   mt::Tensor<T, 4> out,
+                   const mt::Window2d& window,
+                   double eps)
+    {
+        const mt::Shape<4> shape = in.getShape();
+        const mt::Shape<4> kernel = weights.getShape();
+        const mt::Shape<4> out_shape = out.getShape();
+        for (uint32_t n = 0; n < out_shape[0]; ++n)
+        {
+            for (uint32_t o = 0; o < out_shape[1]; ++o)
+            {
+                for (uint32_t y = 0; y < out_shape[2]; ++y)
+                {
+                    for (uint32_t x = 0; x < out_shape[3]; ++x)
+                    {
+                        double expected = 0;
+                        for (uint32_t c = 0; c < shape[1]; ++c)
+                        {
+                            for (uint32_t ky = 0; ky < kernel[2]; ++ky)
+                            {
+                                for (uint32_t kx = 0; kx < kernel[3]; ++kx)
+                                {
+                                    const int64_t iy = inputIndex(window, 0, y, ky, shape[2]);
+                                    const int64_t ix = inputIndex(window, 1, x, kx, shape[3]);
+                                    if (iy >= 0 && ix >= 0)
+                                    {
+                                        expected += static_cast<double>(weights(o, c, ky, kx)) * in(n, c, iy, ix);
+                                    }
+                                }
+                            }
+                        }
+                        ASSERT_NEAR(out(n, o, y, x), expected, eps) << n << ", " << o << ", " << y << ", " << x;
+                    }
+                }
+            }
+        }
+    }
+
+    template <class T>
+    void checkSizes(double eps)
+    {
+        mt::ThreadPool pool(3);
+        // Batch, channels, height, width, outputs, kernel height, kernel width, stride, padding, dilation
+        const uint32_t sizes[][10] = {{1, 1, 1, 1, 1, 1, 1, 1, 0, 1},
+                                      {2, 3, 9, 11, 5, 3, 3, 1, 1, 1},
+                                      {1, 4, 17, 40, 13, 3, 5, 2, 2, 1},
+                                      {2, 2, 12, 70, 25, 3, 3, 3, 0, 2},
+                                      {1, 5, 8, 9, 7, 1, 1, 1, 0, 1},
+                                      {1, 2, 6, 6, 3, 7, 7, 2, 3, 1}};
+        mt_test::forEachIsa([&](mt::SimdIsa) {
+            for (const auto& size : sizes)
+            {
+                const mt::Window2d window(size[7], size[8], size[9]);
+                const uint32_t out_h = window.outputSize(0, size[2], size[5]);
+                const uint32_t out_w = window.outputSize(1, size[3], size[6]);
+                std::vector<T> in_data = randomData<T>(size[0] * size[1] * size[2] * size[3], size[2]);
+                std::vector<T> w_data = randomData<T>(size[4] * size[1] * size[5] * size[6], size[4]);
+                std::vector<T> out_data(size[0] * size[4] * out_h * out_w);
+                mt::Tensor<const T, 4> in(in_data.data(), {size[0], size[1], size[2], size[3]});
+                mt::Tensor<const T, 4> weights(w_data.data(), {size[4], size[1], size[5], size[6]});
+                mt::Tensor<T, 4> out(out_data.data(), {size[0], size[4], out_h, out_w});
+                mt::conv2d(in, weights, out, window);
+                checkConv(in, weights, out, window, eps * size[1] * size[5] * size[6]);
+                std::fill(out_data.begin(), out_data.end(), T(0));
+                mt::conv2d(in, weights, out, window, &pool, 1);
+                checkConv(in, weights, out, window, eps * size[1] * size[5] * size[6]);
+            }
+        });
+    }
+} // namespace
+
+TEST(conv, output_size)
+{
+    const mt::Window2d window(2, 1, 3);
+    ASSERT_EQ(window.outputSize(0, 10, 3), 3);
+    ASSERT_EQ(window.outputSize(1, 3, 3), 0);
+    ASSERT_EQ(mt::Window2d().outputSize(0, 5, 5), 1);
+    mt::Window2d rows;
+    rows.stride[1] = 4;
+    ASSERT_EQ(rows.outputSize(0, 9, 1), 9);
+    ASSERT_EQ(rows.outputSize(1, 9, 1), 3);
+}
+
+TEST(conv, sizes_float)
+{
+    checkSizes<float>(1e-6);
+}
+
+TEST(conv, sizes_double)
+{
+    checkSizes<double>(1e-14);
+}
+
+TEST(conv, strided_views)
+{
+    // A 3x20x30 crop of an interleaved 28x40 image with 4 channels, the outputs written into every other column
+    // of a CHW image
+    std::vector<float> image = randomData<float>(28 * 40 * 4, 1);
+    mt::Tensor<float, 3> hwc(image.data(), {28, 40, 4});
+    mt::Tensor<float, 3> chw = mt::transpose(mt::transpose(hwc, 0, 2), 1, 2);
+    mt::Tensor<float, 3> crop = mt::slice(chw, mt::Range(1, 4), mt::Range(5, 25), mt::Range(7, 37));
+    std::vector<float> w_data = randomData<float>(6 * 3 * 3 * 3, 2);
+    mt::Tensor<const float, 4> weights(w_data.data(), {6, 3, 3, 3});
+    std::vector<float> out_data(6 * 20 * 60);
+    mt::Tensor<float, 3> wide(out_data.data(), {6, 20, 60});
+    mt::Tensor<float, 3> out = mt::slice(wide, mt::Range(), mt::Range(), mt::Range(0, 60, 2));
+    mt::conv2d(crop, weights, out, mt::Window2d(1, 1));
+    checkConv(mt::detail::asBatch(crop), weights, mt::detail::asBatch(out), mt::Window2d(1, 1), 1e-5);
+    for (size_t i = 1; i < out_data.size(); i += 2)
+    {
+        ASSERT_EQ(out_data[i], 0);
+    }
+}
+
+TEST(conv, depthwise)
+{
+    const uint32_t channels = 3;
+    const mt::Window2d windows[] = {mt::Window2d(), mt::Window2d(1, 2), mt::Window2d(2, 1, 2), mt::Window2d(3, 0)};
+    std::vector<double> in_data = randomData<double>(2 * channels * 19 * 45, 3);
+    std::vector<double> w_data = randomData<double>(channels * 3 * 5, 4);
+    mt::Tensor<const double, 4> in(in_data.data(), {2, channels, 19, 45});
+    mt::Tensor<const double, 3> weights(w_data.data(), {channels, 3, 5});
+    mt::ThreadPool pool(2);
+    mt_test::forEachIsa([&](mt::SimdIsa) {
+        for (const mt::Window2d& window : windows)
+        {
+            const uint32_t out_h = window.outputSize(0, 19, 3);
+            const uint32_t out_w = window.outputSize(1, 45, 5);
+            std::vector<double> out_data(2 * channels * out_h * out_w);
+            mt::Tensor<double, 4> out(out_data.data(), {2, channels, out_h, out_w});
+            mt::depthwiseConv2d(in, weights, out, window, &pool, 1);
+            // The same as a dense convolution with zero weights across channels
+            std::vector<double> dense_data(channels * channels * 3 * 5);
+            mt::Tensor<double, 4> dense(dense_data.data(), {channels, channels, 3, 5});
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                weights[c].copyTo(dense[c][c]);
+            }
+            checkConv(in, dense, out, window, 1e-13);
+        }
+    });
+}
+
+TEST(conv, pooling)
+{
+    const uint32_t channels = 5;
+    const uint32_t height = 14;
+    const uint32_t width = 37;
+    std::vector<float> in_data = randomData<float>(channels * height * width, 5);
+    mt::Tensor<const float, 3> in(in_data.data(), {channels, height, width});
+    // Kernel height, kernel width, stride, padding, dilation
+    const uint32_t configs[][5] = {{2, 2, 2, 0, 1}, {3, 3, 2, 1, 1}, {3, 5, 1, 2, 1}, {2, 3, 3, 1, 2}};
+    mt_test::forEachIsa([&](mt::SimdIsa) {
+        for (const auto& config : configs)
+        {
+            const mt::Window2d window(config[2], config[3], config[4]);
+            const uint32_t out_h = window.outputSize(0, height, config[0]);
+            const uint32_t out_w = window.outputSize(1, width, config[1]);
+            std::vector<float> max_data(channels * out_h * out_w);
+            std::vector<float> avg_data(channels * out_h * out_w);
+            mt::Tensor<float, 3> max_out(max_data.data(), {channels, out_h, out_w});
+            mt::Tensor<float, 3> avg_out(avg_data.data(), {channels, out_h, out_w});
+            mt::maxPool2d(in, config[0], config[1], max_out, window);
+            mt::avgPool2d(in, config[0], config[1], avg_out, window);
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                for (uint32_t y = 0; y < out_h; ++y)
+                {
+                    for (uint32_t x = 0; x < out_w; ++x)
+                    {
+                        float max = -std::numeric_limits<float>::infinity();
+                        double sum = 0;
+                        uint32_t count = 0;
+                        for (uint32_t ky = 0; ky < config[0]; ++ky)
+                        {
+                            for (uint32_t kx = 0; kx < config[1]; ++kx)
+                            {
+                                const int64_t iy = inputIndex(window, 0, y, ky, height);
+                                const int64_t ix = inputIndex(window, 1, x, kx, width);
+                                if (iy >= 0 && ix >= 0)
+                                {
+                                    max = std::max(max, in_data[(c * height + iy) * width + ix]);
+                                    sum += in_data[(c * height + iy) * width + ix];
+                                    ++count;
+                                }
+                            }
+                        }
+                        ASSERT_EQ(max_out(c, y, x), max) << c << ", " << y << ", " << x;
+                        ASSERT_NEAR(avg_out(c, y, x), sum / count, 1e-6) << c << ", " << y << ", " << x;
+                    }
+                }
+            }
+        }
+    });
+}
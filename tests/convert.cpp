@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include "test_utils.hpp"
+
+#include <minitensor/Convert.hpp>
+#include <minitensor/Dispatch.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // Saturating conversion computed in double, the reference for every kernel
+    template <class T>
+    T reference(double x)
+    {
+        if (std::is_integral<T>::value)
+        {
+            if (std::isnan(x))
+            {
+                return 0;
+            }
+            x = std::max(x, static_cast<double>(std::numeric_limits<T>::lowest()));
+            x = std::min(x, static_cast<double>(std::numeric_limits<T>::max()));
+        }
+        return static_cast<T>(x);
+    }
+
+    // Values around the edges of every destination range, converted with every instruction set
+    template <class S, class T>
+    void checkSaturation(double scale, double offset)
+    {
+        std::vector<S> in;
+        const double values[] = {-1e10, -70000, -40000, -129, -128.5, -1.75, -0.5, 0, 0.5, 1.25, 126.9, 127.5, 255.5,
+                                 256, 32767.5, 65535, 70000, 3e9, 1e10, NAN, INFINITY};
+        for (int repeat = 0; repeat < 5; ++repeat)
+        {
+            for (double value : values)
+            {
+                in.push_back(reference<S>(value + repeat));
+            }
+        }
+        const uint32_t n = static_cast<uint32_t>(in.size());
+        mt_test::forEachIsa([&](mt::SimdIsa isa) {
+            std::vector<T> out(n);
+            mt::convert(mt::Tensor<const S, 1>(in.data(), n), mt::Tensor<T, 1>(out.data(), n), scale, offset);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                typedef typename mt::detail::ConvertTraits<S, T>::Work_t W;
+                const W work = static_cast<W>(static_cast<W>(in[i]) * static_cast<W>(scale) + static_cast<W>(offset));
+                const T expected = reference<T>(work);
+                ASSERT_TRUE(out[i] == expected || (out[i] != out[i] && expected != expected))
+                    << mt::simdIsaName(isa) << " " << typeid(S).name() << " -> "
+                    << typeid(T).name() << " " << +in[i] << " gave " << +out[i] << " expected " << +expected;
+            }
+        });
+    }
+
+    template <class S>
+    void checkFrom()
+    {
+        checkSaturation<S, uint8_t>(1, 0);
+        checkSaturation<S, int8_t>(0.5, 3);
+        checkSaturation<S, int16_t>(-2, 0);
+        checkSaturation<S, int32_t>(1, 0);
+        checkSaturation<S, float>(1.0 / 255, -0.5);
+        checkSaturation<S, double>(3, 1);
+    }
+} // namespace
+
+TEST(convert, saturation)
+{
+    checkFrom<uint8_t>();
+    checkFrom<int8_t>();
+    checkFrom<int16_t>();
+    checkFrom<int32_t>();
+    checkFrom<float>();
+    checkFrom<double>();
+}
+
+TEST(convert, plain)
+{
+    std::vector<int64_t> big({-(int64_t(1) << 60), 3, int64_t(1) << 53});
+    std::vector<double> out(3);
+    mt::convert(mt::Tensor<const int64_t, 1>(big.data(), 3), mt::Tensor<double, 1>(out.data(), 3));
+    ASSERT_EQ(out, std::vector<double>({-std::ldexp(1.0, 60), 3, std::ldexp(1.0, 53)}));
+
+    std::vector<float> values({-0.0f, 1.5f, -300.f});
+    std::vector<double> doubles(3);
+    std::vector<uint8_t> bytes(3);
+    mt::convert(mt::Tensor<const float, 1>(values.data(), 3), mt::Tensor<double, 1>(doubles.data(), 3));
+    ASSERT_TRUE(std::signbit(doubles[0]));
+    mt::convert(mt::Tensor<const float, 1>(values.data(), 3), mt::Tensor<uint8_t, 1>(bytes.data(), 3));
+    ASSERT_EQ(bytes, std::vector<uint8_t>({0, 1, 0}));
+}
+
+TEST(convert, hwc_to_chw)
+{
+    const uint32_t height = 5;
+    const uint32_t width = 37;
+    std::vector<uint8_t> image(height * width * 3);
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        image[i] = static_cast<uint8_t>(i * 7);
+    }
+    const float mean[] = {123.5f, 116.25f, 103.5f};
+    const float inv_std[] = {1 / 58.5f, 1 / 57.25f, 1 / 57.5f};
+    std::vector<float> scale(3);
+    std::vector<float> offset(3);
+    for (int c = 0; c < 3; ++c)
+    {
+        scale[c] = inv_std[c];
+        offset[c] = -mean[c] * inv_std[c];
+    }
+
+    // Read through a type erased view, as an image coming out of a decoder would be
+    mt::Tensor<uint8_t, 3> typed(image.data(), {height, width, 3});
+    mt::Tensor<void, 3> erased = typed;
+    mt::Tensor<const uint8_t, 3> hwc = erased;
+    std::vector<float> planar(3 * height * width);
+    mt::Tensor<float, 3> chw(planar.data(), {3, height, width});
+    const uint8_t order[] = {2, 0, 1};
+    mt::convert(mt::permute(hwc, order),
+                chw,
+                mt::Tensor<const float, 1>(scale.data(), 3),
+                mt::Tensor<const float, 1>(offset.data(), 3),
+                0);
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const float expected = static_cast<float>(hwc(y, x, c)) * scale[c] + offset[c];
+                ASSERT_FLOAT_EQ(chw(c, y, x), expected);
+            }
+        }
+    }
+
+    // And back into an interleaved uint8 image
+    std::vector<uint8_t> restored(image.size());
+    std::vector<float> inv_scale(3);
+    for (int c = 0; c < 3; ++c)
+    {
+        inv_scale[c] = 1 / scale[c];
+    }
+    mt::Tensor<uint8_t, 3> out_hwc(restored.data(), {height, width, 3});
+    mt::convert(mt::Tensor<const float, 3>(planar.data(), chw.getShape()),
+                mt::permute(out_hwc, order),
+                mt::Tensor<const float, 1>(inv_scale.data(), 3),
+                mt::Tensor<const float, 1>(mean, 3),
+                0);
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        ASSERT_NEAR(restored[i], image[i], 1);
+    }
+}
+
+TEST(convert, dynamic)
+{
+    std::vector<int16_t> values({-5, 100, 300});
+    std::vector<uint8_t> out(3);
+    mt::DynamicTensor<const void, 1> src = mt::Tensor<int16_t, 1>(values.data(), 3);
+    mt::DynamicTensor<void, 1> dst = mt::Tensor<uint8_t, 1>(out.data(), 3);
+    mt::convert(src, dst, 0.5, 10);
+    ASSERT_EQ(out, std::vector<uint8_t>({7, 60, 160}));
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Dispatch.hpp>
+#include <minitensor/MappedFile.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    template <class T>
+    struct CountKernel
+    {
+        static void apply(mt::DType& seen) { seen = mt::DTypeOf<T>::value; }
+    };
+} // namespace
+
+TEST(dispatch, dtype)
+{
+    static_assert(mt::DTypeOf<const float>::value == mt::DType::Float32, "");
+    ASSERT_EQ(mt::dtypeSize(mt::DType::UInt16), 2);
+    ASSERT_EQ(mt::dtypeSize(mt::DType::Float64), 8);
+    ASSERT_STREQ(mt::dtypeName(mt::DType::Int8), "int8");
+    ASSERT_EQ(mt::npyDType("<f4"), mt::DType::Float32);
+    ASSERT_EQ(mt::npyDType("|u1"), mt::DType::UInt8);
+    ASSERT_THROW(mt::npyDType("<c8"), std::runtime_error);
+
+    mt::KernelRegistry<void (*)(mt::DType&)> registry =
+        mt::kernelRegistry<CountKernel, void (*)(mt::DType&), mt::detail::TypeList<int16_t, double>>();
+    ASSERT_TRUE(registry.supports(mt::DType::Int16));
+    ASSERT_FALSE(registry.supports(mt::DType::Float32));
+    mt::DType seen = mt::DType::Bool;
+    registry(mt::DType::Float64, seen);
+    ASSERT_EQ(seen, mt::DType::Float64);
+}
+
+TEST(dispatch, views)
+{
+    std::vector<int16_t> data({0, 1, 2, 3, 4, 5});
+    mt::Tensor<int16_t, 2> typed(data.data(), {2, 3});
+    mt::DynamicTensor<void, 2> tensor = typed;
+    ASSERT_EQ(tensor.dtype(), mt::DType::Int16);
+    ASSERT_EQ(tensor.getShape(), typed.getShape());
+
+    // Through the byte view of Tensor<void, D> and back
+    mt::Tensor<void, 2> bytes = tensor.bytes();
+    ASSERT_EQ(bytes.getShape()[1], 6);
+    mt::DynamicTensor<const void, 2> restored(mt::Tensor<const void, 2>(bytes.data(), bytes.getShape()),
+                                              mt::DType::Int16);
+    ASSERT_EQ(restored.getShape(), typed.getShape());
+    ASSERT_EQ(restored.as<const int16_t>()(1, 2), 5);
+
+    // Transposed copy
+    std::vector<int16_t> out(6);
+    restored = mt::DynamicTensor<const void, 2>(mt::transpose(typed, 0, 1));
+    restored.copyTo(mt::Tensor<int16_t, 2>(out.data(), {3, 2}));
+    ASSERT_EQ(out, std::vector<int16_t>({0, 3, 1, 4, 2, 5}));
+}
+
+TEST(dispatch, fill_and_convert)
+{
+    std::vector<uint8_t> bytes(6);
+    mt::DynamicTensor<void, 2> u8 = mt::Tensor<uint8_t, 2>(bytes.data(), {2, 3});
+    mt::fill(u8, 7);
+    ASSERT_EQ(bytes, std::vector<uint8_t>(6, 7));
+    bytes[4] = 200;
+
+    std::vector<double> doubles(6);
+    mt::DynamicTensor<void, 2> f64 = mt::Tensor<double, 2>(doubles.data(), {2, 3});
+    mt::convert(u8, f64);
+    ASSERT_EQ(doubles, std::vector<double>({7, 7, 7, 7, 200, 7}));
+
+    std::vector<int32_t> ints(6);
+    mt::DynamicTensor<void, 2> i32 = mt::Tensor<int32_t, 2>(ints.data(), {2, 3});
+    mt::convert(mt::DynamicTensor<const void, 2>(f64), i32);
+    ASSERT_EQ(ints, std::vector<int32_t>({7, 7, 7, 7, 200, 7}));
+}
+
+TEST(dispatch, arithmetic)
+{
+    std::vector<float> a({1, 2, 3, 4, 5, 6});
+    std::vector<float> b({10, 20, 30});
+    std::vector<float> out(6);
+    mt::DynamicTensor<void, 2> a_tensor = mt::Tensor<float, 2>(a.data(), {2, 3});
+    mt::DynamicTensor<void, 1> b_tensor = mt::Tensor<float, 1>(b.data(), 3);
+    mt::DynamicTensor<void, 2> out_tensor = mt::Tensor<float, 2>(out.data(), {2, 3});
+    mt::add(a_tensor, b_tensor, out_tensor);
+    ASSERT_EQ(out, std::vector<float>({11, 22, 33, 14, 25, 36}));
+    mt::max(a_tensor, b_tensor, out_tensor);
+    ASSERT_EQ(out, std::vector<float>({10, 20, 30, 10, 20, 30}));
+
+    std::vector<int64_t> values({3, -4, 1, 2, 0, 5});
+    std::vector<int64_t> sums(2);
+    mt::DynamicTensor<const void, 2> in = mt::Tensor<int64_t, 2>(values.data(), {2, 3});
+    mt::sum(in, 1, mt::DynamicTensor<void, 1>(mt::Tensor<int64_t, 1>(sums.data(), 2)));
+    ASSERT_EQ(sums, std::vector<int64_t>({0, 7}));
+    std::vector<int64_t> mins(3);
+    mt::min(in, 0, mt::DynamicTensor<void, 1>(mt::Tensor<int64_t, 1>(mins.data(), 3)));
+    ASSERT_EQ(mins, std::vector<int64_t>({2, -4, 1}));
+}
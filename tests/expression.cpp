@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Expression.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    std::vector<float> iota(size_t size, float start = 0)
+    {
+        std::vector<float> out(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            out[i] = start + i;
+        }
+        return out;
+    }
+} // namespace
+
+TEST(expression, arithmetic)
+{
+    std::vector<float> a_data = iota(12);
+    std::vector<float> b_data = iota(12, 1);
+    std::vector<float> c_data(12, 0.5F);
+    std::vector<float> out_data(12);
+    mt::Tensor<float, 2> a(a_data.data(), {3, 4});
+    mt::Tensor<const float, 2> b(b_data.data(), {3, 4});
+    mt::Tensor<float, 2> c(c_data.data(), {3, 4});
+    mt::Tensor<float, 2> out(out_data.data(), {3, 4});
+
+    out = a * b + c;
+    for (size_t i = 0; i < 12; ++i)
+    {
+        ASSERT_EQ(out_data[i], a_data[i] * b_data[i] + 0.5F);
+    }
+
+    out = (a - 2) / 2.0 - -c;
+    for (size_t i = 0; i < 12; ++i)
+    {
+        ASSERT_EQ(out_data[i], (a_data[i] - 2) / 2 + 0.5F);
+    }
+
+    out = mt::exp(a / 10) - b;
+    for (size_t i = 0; i < 12; ++i)
+    {
+        ASSERT_FLOAT_EQ(out_data[i], std::exp(a_data[i] / 10) - b_data[i]);
+    }
+}
+
+TEST(expression, compare_and_where)
+{
+    std::vector<float> a_data = iota(8);
+    std::vector<float> out_data(8);
+    std::vector<uint8_t> mask_data(8);
+    mt::Tensor<float, 1> a(a_data.data(), 8);
+    mt::Tensor<float, 1> out(out_data.data(), 8);
+    mt::Tensor<uint8_t, 1> mask(mask_data.data(), 8);
+
+    mask = a > 3;
+    ASSERT_EQ(mask_data, std::vector<uint8_t>({0, 0, 0, 0, 1, 1, 1, 1}));
+
+    out = mt::where(a < 5, a * 2, 0);
+    ASSERT_EQ(out_data, std::vector<float>({0, 2, 4, 6, 8, 0, 0, 0}));
+
+    out = mt::maximum(mt::minimum(a, 5), 2);
+    ASSERT_EQ(out_data, std::vector<float>({2, 2, 2, 3, 4, 5, 5, 5}));
+}
+
+TEST(expression, scalar_promotion)
+{
+    // Scalars that do not fit the element type of an integer tensor are not converted to it
+    std::vector<int32_t> ints({1, 2, 3, 4, 5});
+    std::vector<double> halves(5);
+    mt::Tensor<int32_t, 1> a(ints.data(), 5);
+    mt::Tensor<double, 1>(halves.data(), 5) = a * 0.5;
+    ASSERT_EQ(halves, std::vector<double>({0.5, 1, 1.5, 2, 2.5}));
+    a = a * 0.5;
+    ASSERT_EQ(ints, std::vector<int32_t>({0, 1, 1, 2, 2}));
+
+    std::vector<uint8_t> bytes({0, 44, 200, 255});
+    std::vector<uint8_t> mask(4);
+    mt::Tensor<uint8_t, 1>(mask.data(), 4) = mt::Tensor<uint8_t, 1>(bytes.data(), 4) < 300;
+    ASSERT_EQ(mask, std::vector<uint8_t>({1, 1, 1, 1}));
+    mt::Tensor<uint8_t, 1>(mask.data(), 4) = mt::Tensor<uint8_t, 1>(bytes.data(), 4) == -212;
+    ASSERT_EQ(mask, std::vector<uint8_t>({0, 0, 0, 0}));
+
+    // Floating point tensors keep their precision
+    std::vector<float> floats({1.0F});
+    static_assert(std::is_same<decltype(mt::Tensor<float, 1>(floats.data(), 1) * 0.1)::value_type, float>::value,
+                  "A double scalar must not widen a float expression");
+}
+
+TEST(expression, strided_operands)
+{
+    std::vector<float> a_data = iota(24);
+    std::vector<float> out_data(24, -1);
+    // Every other column of a 4x6 matrix
+    mt::Shape<2> view_shape(4, 3);
+    view_shape.setStride(0, 6);
+    view_shape.setStride(1, 2);
+    mt::Tensor<float, 2> a(a_data.data(), view_shape);
+    mt::Tensor<float, 2> dense(a_data.data(), {4, 3});
+    mt::Tensor<float, 2> out(out_data.data() + 1, view_shape);
+
+    out = a + dense;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            ASSERT_EQ(out_data[i * 6 + j * 2], -1);
+            ASSERT_EQ(out_data[i * 6 + j * 2 + 1], a_data[i * 6 + j * 2] + a_data[i * 3 + j]);
+        }
+    }
+}
+
+TEST(expression, broadcasting)
+{
+    std::vector<float> a_data = iota(24);
+    std::vector<float> bias_data = iota(4, 100);
+    std::vector<float> scale_data = iota(3, 1);
+    std::vector<float> out_data(24);
+    mt::Tensor<float, 3> a(a_data.data(), {2, 3, 4});
+    mt::Tensor<float, 1> bias(bias_data.data(), 4);
+    // One value per channel, repeated along the innermost dimension
+    mt::Tensor<float, 3> scale(scale_data.data(), {1, 3, 1});
+    mt::Tensor<float, 3> out(out_data.data(), {2, 3, 4});
+
+    out = a * scale + bias;
+    for (uint32_t n = 0; n < 2; ++n)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                const uint32_t i = n * 12 + c * 4 + x;
+                ASSERT_EQ(out_data[i], a_data[i] * scale_data[c] + bias_data[x]);
+            }
+        }
+    }
+
+    out = mt::where(a > 10, scale, -bias);
+    for (uint32_t i = 0; i < 24; ++i)
+    {
+        ASSERT_EQ(out_data[i], a_data[i] > 10 ? scale_data[(i / 4) % 3] : -bias_data[i % 4]);
+    }
+}
+
+TEST(expression, sliced_operands)
+{
+    std::vector<float> a_data = iota(8 * 10);
+    std::vector<float> out_data(3 * 4, -1);
+    mt::Tensor<float, 2> a(a_data.data(), {8, 10});
+    mt::Tensor<float, 2> out(out_data.data(), {3, 4});
+    // A crop and a crop of every other row with its columns reversed
+    mt::Tensor<float, 2> crop = mt::slice(a, mt::Range(2, 5), mt::Range(3, 7));
+    mt::Tensor<float, 2> flipped = mt::slice(a, mt::Range(1, 7, 2), mt::Range(-1, -5, -1));
+
+    out = crop * 2.0F + flipped;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            ASSERT_EQ(out(i, j), a(i + 2, j + 3) * 2 + a(1 + 2 * i, 9 - j));
+        }
+    }
+}
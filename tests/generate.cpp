@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Generate.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+TEST(generate, iota)
+{
+    std::vector<float> data(6 * 7 * 5);
+    mt::Tensor<float, 3> dense(data.data(), {6, 7, 5});
+    mt::iota(dense, 2.0, 0.5);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        ASSERT_EQ(data[i], 2 + 0.5F * i);
+    }
+
+    // Indices follow the logical order of a transposed view, in parallel
+    std::vector<int32_t> values(600 * 70);
+    mt::Tensor<int32_t, 2> matrix(values.data(), {600, 70});
+    mt::ThreadPool pool(3);
+    mt::iota(mt::transpose(matrix, 0, 1), -5, 3, &pool, 1000);
+    for (int32_t i = 0; i < 600; ++i)
+    {
+        for (int32_t j = 0; j < 70; ++j)
+        {
+            ASSERT_EQ(matrix(i, j), -5 + 3 * (j * 600 + i));
+        }
+    }
+
+    // Integers wrap like counting would
+    std::vector<uint8_t> bytes(300);
+    mt::iota(mt::Tensor<uint8_t, 1>(bytes.data(), 300));
+    ASSERT_EQ(bytes[299], 299 % 256);
+    std::vector<int32_t> large(4);
+    mt::iota(mt::Tensor<int32_t, 1>(large.data(), 4), 2147483000, 1000);
+    ASSERT_EQ(large[0], 2147483000);
+    ASSERT_EQ(large[1], static_cast<int32_t>(2147484000U));
+    ASSERT_EQ(large[3], static_cast<int32_t>(2147486000U));
+    std::vector<int16_t> shorts(3);
+    mt::iota(mt::Tensor<int16_t, 1>(shorts.data(), 3), 32767, 32767);
+    ASSERT_EQ(shorts[2], static_cast<int16_t>(32767 * 3 - 65536));
+}
+
+TEST(generate, iota_along)
+{
+    std::vector<double> grid(4 * 9 * 3);
+    mt::Tensor<double, 3> xyz(grid.data(), {4, 9, 3});
+    mt::iotaAlong(xyz, 1, 1.0, 0.25);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        for (uint32_t j = 0; j < 9; ++j)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                ASSERT_EQ(xyz(i, j, k), 1 + 0.25 * j);
+            }
+        }
+    }
+    mt::iotaAlong(xyz, 2);
+    ASSERT_EQ(xyz(3, 8, 0), 0);
+    ASSERT_EQ(xyz(3, 8, 2), 2);
+}
+
+TEST(generate, philox)
+{
+    // Known answers of the reference implementation
+    uint32_t zero[4] = {0, 0, 0, 0};
+    mt::detail::Philox::block(zero, 0, 0);
+    ASSERT_EQ(zero[0], 0x6627e8d5U);
+    ASSERT_EQ(zero[1], 0xe169c58dU);
+    ASSERT_EQ(zero[2], 0xbc57ac4cU);
+    ASSERT_EQ(zero[3], 0x9b00dbd8U);
+    uint32_t pi[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    mt::detail::Philox::block(pi, 0xa4093822, 0x299f31d0);
+    ASSERT_EQ(pi[0], 0xd16cfe09U);
+    ASSERT_EQ(pi[1], 0x94fdccebU);
+    ASSERT_EQ(pi[2], 0x5001e420U);
+    ASSERT_EQ(pi[3], 0x24126ea1U);
+
+    // Every instruction set produces the same stream
+    const uint64_t first = (uint64_t(1) << 32) - 50;
+    std::vector<uint32_t> expected(4 * 101);
+    mt::detail::philoxScalar(first, 101, 0x1234567890ULL, expected.data());
+    for (uint8_t isa = 0; isa <= static_cast<uint8_t>(mt::detectSimdIsa()); ++isa)
+    {
+        std::vector<uint32_t> words(4 * 101);
+        mt::detail::selectPhilox(static_cast<mt::SimdIsa>(isa))(first, 101, 0x1234567890ULL, words.data());
+        ASSERT_EQ(words, expected) << mt::simdIsaName(static_cast<mt::SimdIsa>(isa));
+    }
+}
+
+TEST(generate, uniform)
+{
+    const uint32_t n = 1000;
+    std::vector<float> reference(n * 3);
+    mt::Tensor<float, 2> dense(reference.data(), {n, 3});
+    mt::randomUniform(dense, -2.0F, 3.0F, 42);
+    double sum = 0;
+    for (float value : reference)
+    {
+        ASSERT_GE(value, -2);
+        ASSERT_LT(value, 3);
+        sum += value;
+    }
+    ASSERT_NEAR(sum / reference.size(), 0.5, 0.1);
+
+    // The same values in a strided view filled in parallel, the columns of a transposed layout
+    std::vector<float> storage(n * 3);
+    mt::Tensor<float, 2> columns(storage.data(), {3, n});
+    mt::ThreadPool pool(4);
+    mt::randomUniform(mt::transpose(columns, 0, 1), -2.0F, 3.0F, 42, &pool, 100);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            ASSERT_EQ(columns(j, i), dense(i, j));
+        }
+    }
+
+    // A different seed is a different stream
+    std::vector<float> other(n * 3);
+    mt::randomUniform(mt::Tensor<float, 2>(other.data(), {n, 3}), -2.0F, 3.0F, 43);
+    ASSERT_NE(std::memcmp(other.data(), reference.data(), n * 3 * sizeof(float)), 0);
+
+    // Integers cover the whole range
+    std::vector<int8_t> dice(n);
+    mt::randomUniform(mt::Tensor<int8_t, 1>(dice.data(), n), 1, 7, 7);
+    int counts[6] = {};
+    for (int8_t value : dice)
+    {
+        ASSERT_GE(value, 1);
+        ASSERT_LT(value, 7);
+        ++counts[value - 1];
+    }
+    for (int count : counts)
+    {
+        ASSERT_GT(count, n / 6 / 2);
+    }
+    std::vector<int32_t> words(n);
+    mt::randomUniform(mt::Tensor<int32_t, 1>(words.data(), n), INT32_MIN, INT32_MAX, 1);
+    ASSERT_NE(words[0], words[1]);
+}
+
+TEST(generate, normal)
+{
+    const uint32_t n = 20001;
+    std::vector<double> values(n);
+    mt::randomNormal(mt::Tensor<double, 1>(values.data(), n), 1.5, 2.0, 5);
+    double sum = 0;
+    double squares = 0;
+    for (double value : values)
+    {
+        ASSERT_TRUE(std::isfinite(value));
+        sum += value;
+        squares += value * value;
+    }
+    const double mean = sum / n;
+    ASSERT_NEAR(mean, 1.5, 0.05);
+    ASSERT_NEAR(std::sqrt(squares / n - mean * mean), 2.0, 0.05);
+
+    // Rows starting on odd indices take the second value of their pair
+    std::vector<double> shifted(n);
+    mt::Tensor<double, 2> strided(shifted.data(), {n, 1});
+    mt::ThreadPool pool(3);
+    mt::randomNormal(strided, 1.5, 2.0, 5, &pool, 77);
+    ASSERT_EQ(shifted, values);
+
+    std::vector<mt::float16> halves(64);
+    mt::randomNormal(mt::Tensor<mt::float16, 1>(halves.data(), 64), 0.0F, 1.0F, 5);
+    ASSERT_LT(std::abs(static_cast<float>(halves[3])), 10);
+}
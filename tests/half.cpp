@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "test_utils.hpp"
+
+#include <minitensor/Convert.hpp>
+#include <minitensor/Dispatch.hpp>
+#include <minitensor/Format.hpp>
+#include <minitensor/MappedFile.hpp>
+#include <minitensor/TensorBuffer.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Bulk conversions of every instruction set against the scalar conversion of each element
+    template <class H>
+    void checkBulk(const std::vector<float>& values)
+    {
+        const uint32_t n = static_cast<uint32_t>(values.size());
+        std::vector<H> expected(n);
+        std::vector<float> widened(n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            expected[i] = H(values[i]);
+            widened[i] = expected[i];
+        }
+        mt_test::forEachIsa([&](mt::SimdIsa isa) {
+            std::vector<H> narrow(n);
+            mt::convert(mt::Tensor<const float, 1>(values.data(), n), mt::Tensor<H, 1>(narrow.data(), n));
+            EXPECT_EQ(std::memcmp(narrow.data(), expected.data(), n * sizeof(H)), 0) << mt::simdIsaName(isa);
+            std::vector<float> wide(n);
+            mt::convert(mt::Tensor<const H, 1>(narrow.data(), n), mt::Tensor<float, 1>(wide.data(), n));
+            EXPECT_EQ(std::memcmp(wide.data(), widened.data(), n * sizeof(float)), 0) << mt::simdIsaName(isa);
+        });
+    }
+
+    std::vector<float> testValues()
+    {
+        std::vector<float> out({0.F, -0.F, 1.F, 65504.F, 65519.F, 65520.F, 1e-8F, 5.96e-8F, 6.1e-5F, INFINITY,
+                                -INFINITY, NAN, 1.0F + std::ldexp(1.0F, -11), 1.0F + 3 * std::ldexp(1.0F, -11)});
+        std::mt19937 rng(4);
+        std::uniform_real_distribution<float> dist(-10, 10);
+        for (int i = 0; i < 1000; ++i)
+        {
+            out.push_back(std::ldexp(dist(rng), static_cast<int>(rng() % 40) - 30));
+        }
+        return out;
+    }
+} // namespace
+
+TEST(half, float16_values)
+{
+    ASSERT_EQ(mt::float16(1.F).bits, 0x3C00);
+    ASSERT_EQ(mt::float16(-2.F).bits, 0xC000);
+    ASSERT_EQ(mt::float16(65504.F).bits, 0x7BFF);
+    ASSERT_EQ(mt::float16(65520.F).bits, 0x7C00);
+    ASSERT_EQ(mt::float16(std::ldexp(1.F, -24)).bits, 0x0001);
+    // Ties round to even
+    ASSERT_EQ(mt::float16(1.F + std::ldexp(1.F, -11)).bits, 0x3C00);
+    ASSERT_EQ(mt::float16(1.F + 3 * std::ldexp(1.F, -11)).bits, 0x3C02);
+    ASSERT_TRUE(std::isnan(static_cast<float>(mt::float16(NAN))));
+
+    // Every half survives the trip through float
+    for (uint32_t bits = 0; bits < 0x10000; ++bits)
+    {
+        const mt::float16 half = mt::float16::fromBits(static_cast<uint16_t>(bits));
+        const float value = half;
+        if (std::isnan(value))
+        {
+            ASSERT_EQ(bits & 0x7C00, 0x7C00u);
+            continue;
+        }
+        ASSERT_EQ(mt::float16(value).bits, bits) << value;
+    }
+}
+
+TEST(half, bfloat16_values)
+{
+    ASSERT_EQ(mt::bfloat16(1.F).bits, 0x3F80);
+    ASSERT_EQ(static_cast<float>(mt::bfloat16(-3.5F)), -3.5F);
+    // 1 + 2^-8 is a tie between 1 and 1 + 2^-7
+    ASSERT_EQ(mt::bfloat16(1.F + std::ldexp(1.F, -8)).bits, 0x3F80);
+    ASSERT_EQ(mt::bfloat16(1.F + 3 * std::ldexp(1.F, -8)).bits, 0x3F82);
+    ASSERT_TRUE(std::isnan(static_cast<float>(mt::bfloat16(NAN))));
+}
+
+TEST(half, bulk_conversion)
+{
+    const std::vector<float> values = testValues();
+    checkBulk<mt::float16>(values);
+    checkBulk<mt::bfloat16>(values);
+}
+
+TEST(half, tensor)
+{
+    static_assert(std::is_trivially_copyable<mt::float16>::value, "");
+    static_assert(sizeof(mt::bfloat16) == 2, "");
+    mt::TensorBuffer<mt::float16, 2> buffer(mt::Shape<2>(2, 3));
+    mt::Tensor<mt::float16, 2> tensor = buffer.view();
+    mt::fill(tensor, mt::float16(0.5F));
+    tensor(1, 2) = 2.25F;
+    ASSERT_EQ(static_cast<float>(tensor(1, 2)), 2.25F);
+    ASSERT_EQ(static_cast<float>(tensor[0](1)), 0.5F);
+
+    std::vector<mt::float16> column(2);
+    mt::transpose(tensor, 0, 1)[2].copyTo(mt::Tensor<mt::float16, 1>(column.data(), 2));
+    ASSERT_EQ(static_cast<float>(column[1]), 2.25F);
+
+    ASSERT_EQ(mt::format(tensor), "[[ 0.5  0.5  0.5]\n [ 0.5  0.5 2.25]]");
+    std::stringstream ss;
+    ss << mt::Tensor<mt::float16, 1>(column.data(), 2);
+    ASSERT_NE(ss.str().find("2.25"), std::string::npos);
+
+    // Through the dtype registry
+    std::vector<mt::bfloat16> bf(6);
+    mt::DynamicTensor<void, 2> dynamic = mt::Tensor<mt::bfloat16, 2>(bf.data(), {2, 3});
+    ASSERT_EQ(dynamic.dtype(), mt::DType::BFloat16);
+    ASSERT_EQ(mt::npyDType("<f2"), mt::DType::Float16);
+    mt::convert(mt::DynamicTensor<const void, 2>(tensor), dynamic);
+    ASSERT_EQ(static_cast<float>(bf[5]), 2.25F);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/LoopNest.hpp>
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+TEST(loop_nest, dense_coalesces)
+{
+    mt::Shape<4> shape(8, 3, 4, 5);
+    mt::LoopNest<4, 2> loop(shape, shape);
+    ASSERT_EQ(loop.dims(), 1);
+    ASSERT_EQ(loop.innerSize(), 8 * 3 * 4 * 5);
+    ASSERT_EQ(loop.innerStride(0), 1);
+    ASSERT_EQ(loop.innerStride(1), 1);
+}
+
+TEST(loop_nest, drops_unit_dims)
+{
+    mt::Shape<4> shape(1, 3, 1, 5);
+    mt::LoopNest<4, 1> loop(shape);
+    ASSERT_EQ(loop.dims(), 1);
+    ASSERT_EQ(loop.innerSize(), 15);
+
+    mt::Shape<3> scalar(1, 1, 1);
+    mt::LoopNest<3, 1> scalar_loop(scalar);
+    ASSERT_EQ(scalar_loop.dims(), 1);
+    ASSERT_EQ(scalar_loop.innerSize(), 1);
+}
+
+TEST(loop_nest, partial_coalesce)
+{
+    // A crop of the inner dimension keeps the outer two dims dense with respect to each other
+    mt::Shape<3> dst(4, 3, 2);
+    mt::Shape<3> src(4, 3, 2);
+    src.setStride(2, 1);
+    src.setStride(1, 5);
+    src.setStride(0, 15);
+    mt::LoopNest<3, 2> loop(dst, src);
+    ASSERT_EQ(loop.dims(), 2);
+    ASSERT_EQ(loop.size(0), 12);
+    ASSERT_EQ(loop.size(1), 2);
+    ASSERT_EQ(loop.stride(0, 0), 2);
+    ASSERT_EQ(loop.stride(1, 0), 5);
+}
+
+TEST(loop_nest, row_offsets)
+{
+    mt::Shape<3> shape(2, 3, 4);
+    shape.setStride(2, 2);
+    shape.setStride(1, 10);
+    shape.setStride(0, 30);
+    mt::LoopNest<3, 1> loop(shape);
+    ASSERT_EQ(loop.dims(), 2);
+    std::vector<int64_t> offsets;
+    loop.forEachRow([&offsets](const int64_t* offset, uint32_t n) {
+        ASSERT_EQ(n, 4);
+        offsets.push_back(offset[0]);
+    });
+    ASSERT_EQ(offsets, std::vector<int64_t>({0, 10, 20, 30, 40, 50}));
+}
+
+TEST(loop_nest, row_range)
+{
+    // Every element range visits exactly the offsets of the full traversal in the same order
+    mt::Shape<3> shape(3, 4, 5);
+    shape.setStride(2, 2);
+    shape.setStride(1, 10);
+    shape.setStride(0, 40);
+    mt::LoopNest<3, 1> loop(shape);
+    std::vector<int64_t> all;
+    loop.forEachRow([&all](const int64_t* offsets, uint32_t n) {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            all.push_back(offsets[0] + i * 2);
+        }
+    });
+    ASSERT_EQ(all.size(), 60);
+    for (uint64_t begin = 0; begin < 60; begin += 7)
+    {
+        const uint64_t end = begin + 13 < 60 ? begin + 13 : 60;
+        std::vector<int64_t> part;
+        loop.forEachRow(begin, end, [&part](const int64_t* offsets, uint32_t n) {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                part.push_back(offsets[0] + i * 2);
+            }
+        });
+        ASSERT_EQ(part, std::vector<int64_t>(all.begin() + begin, all.begin() + end));
+    }
+}
+
+#ifdef MT_INDEX_64
+TEST(loop_nest, rows_beyond_32_bit)
+{
+    // Rows longer than a 32 bit count are handed out in pieces, no memory is touched
+    const uint64_t size = (uint64_t(1) << 32) + 1;
+    const int64_t max_row = std::numeric_limits<uint32_t>::max();
+    mt::Shape<2> shape(2, size);
+    shape.setStride(0, int64_t(1) << 33);
+    mt::LoopNest<2, 1> loop(shape);
+    ASSERT_EQ(loop.dims(), 2);
+    std::vector<std::pair<int64_t, uint32_t>> rows;
+    loop.forEachRow([&rows](const int64_t* offset, uint32_t n) { rows.push_back(std::make_pair(offset[0], n)); });
+    const int64_t second = int64_t(1) << 33;
+    ASSERT_EQ(rows,
+              (std::vector<std::pair<int64_t, uint32_t>>(
+                  {{0, max_row}, {max_row, 2}, {second, max_row}, {second + max_row, 2}})));
+
+    // A range starting inside the second piece of the first row
+    rows.clear();
+    loop.forEachRow(max_row + 1, size + 3, [&rows](const int64_t* offset, uint32_t n) {
+        rows.push_back(std::make_pair(offset[0], n));
+    });
+    ASSERT_EQ(rows, (std::vector<std::pair<int64_t, uint32_t>>({{max_row + 1, 1}, {second, 3}})));
+}
+#endif
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/MappedFile.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    std::string tempPath(const char* name) { return ::testing::TempDir() + name; }
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void writeFile(const std::string& path, const std::string& contents)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    // Header numpy writes for np.save(path, np.zeros((2, 3), np.float32))
+    std::string numpyHeader(const char* dict)
+    {
+        std::string out("\x93NUMPY\x01\x00\x76\x00", 10);
+        out += dict;
+        out.append(127 - out.size(), ' ');
+        return out + '\n';
+    }
+} // namespace
+
+TEST(mapped_file, npy_header)
+{
+    const std::string expected = numpyHeader("{'descr': '<f4', 'fortran_order': False, 'shape': (2, 3), }");
+    mt::NpyHeader header;
+    header.descr = "<f4";
+    header.shape = {2, 3};
+    ASSERT_EQ(mt::formatNpyHeader(header), expected);
+
+    mt::NpyHeader parsed = mt::parseNpyHeader(reinterpret_cast<const uint8_t*>(expected.data()), expected.size());
+    ASSERT_EQ(parsed.descr, "<f4");
+    ASSERT_FALSE(parsed.fortran_order);
+    ASSERT_EQ(parsed.shape, std::vector<uint64_t>({2, 3}));
+    ASSERT_EQ(parsed.offset, 128);
+    ASSERT_TRUE(parsed.matches(mt::NpyDescr<float>::value()));
+    ASSERT_FALSE(parsed.matches(mt::NpyDescr<int32_t>::value()));
+
+    header.shape = {7};
+    const std::string vector_header = mt::formatNpyHeader(header);
+    ASSERT_EQ(vector_header.size() % 64, 0);
+    parsed = mt::parseNpyHeader(reinterpret_cast<const uint8_t*>(vector_header.data()), vector_header.size());
+    ASSERT_EQ(parsed.shape, std::vector<uint64_t>({7}));
+
+    // A version 2 prefix cut before its 4 byte length
+    const std::string cut("\x93NUMPY\x02\x00\x10\x00\x00", 11);
+    ASSERT_THROW(mt::parseNpyHeader(reinterpret_cast<const uint8_t*>(cut.data()), cut.size()), std::runtime_error);
+
+    // A shape whose product wraps around to a small number
+    const std::string wrapping =
+        numpyHeader("{'descr': '<f4', 'fortran_order': False, 'shape': (4294967296, 4294967297), }");
+    parsed = mt::parseNpyHeader(reinterpret_cast<const uint8_t*>(wrapping.data()), wrapping.size());
+    ASSERT_THROW(parsed.numElements(), std::runtime_error);
+    parsed.shape = {0, 4294967296, 4294967297};
+    ASSERT_EQ(parsed.numElements(), 0);
+}
+
+TEST(mapped_file, create_and_map)
+{
+    const std::string path = tempPath("mt_create_and_map.npy");
+    {
+        mt::MappedTensor<float, 2> out = mt::createFile<float>(path, mt::Shape<2>(3, 4));
+        mt::Tensor<float, 2> view = out.view();
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            for (uint32_t j = 0; j < 4; ++j)
+            {
+                view(i, j) = static_cast<float>(i * 10 + j);
+            }
+        }
+        out.file().flush();
+    }
+
+    const mt::MappedTensor<float, 2> in = mt::mapFile<float, 2>(path);
+    mt::Tensor<const float, 2> view = in;
+    ASSERT_EQ(view.getShape(), mt::Shape<2>(3, 4));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(view.data()) % 64, 0);
+    ASSERT_EQ(view(2, 3), 23.0F);
+    ASSERT_EQ(view(1, 0), 10.0F);
+
+    // Type erased, the shape is in bytes like any Tensor<void, D>
+    const mt::MappedTensor<void, 2> erased = mt::mapFile<void, 2>(path);
+    ASSERT_EQ(erased.descr(), "<f4");
+    mt::Tensor<const void, 2> bytes = erased.view();
+    ASSERT_EQ(bytes.getShape()[1], 16);
+    mt::Tensor<const float, 2> typed = bytes;
+    ASSERT_EQ(typed.getShape(), mt::Shape<2>(3, 4));
+    ASSERT_EQ(typed(2, 1), 21.0F);
+
+    ASSERT_THROW((mt::mapFile<int32_t, 2>(path)), std::runtime_error);
+    ASSERT_THROW((mt::mapFile<float, 3>(path)), std::runtime_error);
+    ASSERT_THROW((mt::mapFile<float, 2>(tempPath("mt_missing.npy"))), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(mapped_file, modes)
+{
+    const std::string path = tempPath("mt_modes.npy");
+    mt::createFile<int32_t>(path, mt::Shape<1>(4));
+    const std::string original = readFile(path);
+    {
+        // Private pages, the file is untouched
+        mt::MappedTensor<int32_t, 1> copy = mt::mapFile<int32_t, 1>(path, mt::MapMode::CopyOnWrite);
+        copy.view()(0) = 5;
+        ASSERT_EQ(copy.data()[0], 5);
+    }
+    ASSERT_EQ(readFile(path), original);
+    {
+        mt::MappedTensor<int32_t, 1> shared = mt::mapFile<int32_t, 1>(path, mt::MapMode::ReadWrite);
+        shared.view()(3) = 7;
+    }
+    const mt::MappedTensor<int32_t, 1> reopened = mt::mapFile<int32_t, 1>(path);
+    ASSERT_EQ(reopened.view()(3), 7);
+    std::remove(path.c_str());
+}
+
+TEST(mapped_file, fortran_order_and_raw)
+{
+    // Column major 2x3 matrix holding 0 1 2 / 3 4 5
+    const std::string path = tempPath("mt_fortran.npy");
+    std::string contents = numpyHeader("{'descr': '<i4', 'fortran_order': True, 'shape': (2, 3), }");
+    const int32_t columns[] = {0, 3, 1, 4, 2, 5};
+    contents.append(reinterpret_cast<const char*>(columns), sizeof(columns));
+    writeFile(path, contents);
+
+    const mt::MappedTensor<int32_t, 2> mat = mt::mapFile<int32_t, 2>(path);
+    ASSERT_EQ(mat.getShape(), mt::Shape<2>(2, 3));
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        for (int32_t j = 0; j < 3; ++j)
+        {
+            ASSERT_EQ(mat.view()(i, j), i * 3 + j);
+        }
+    }
+
+    // The same elements without interpreting the header
+    const mt::MappedTensor<int32_t, 2> raw = mt::mapRawFile<int32_t>(path, mt::Shape<2>(3, 2), 128);
+    ASSERT_EQ(raw.view()(2, 0), 2);
+    ASSERT_THROW((mt::mapRawFile<int32_t>(path, mt::Shape<2>(4, 2), 128)), std::runtime_error);
+
+    contents.resize(contents.size() - 4);
+    writeFile(path, contents);
+    ASSERT_THROW((mt::mapFile<int32_t, 2>(path)), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "test_utils.hpp"
+
+#include <minitensor/Matmul.hpp>
+
+#include <vector>
+
+namespace
+{
+    using mt_test::randomData;
+
+    template <class T, class A, class B>
+    void checkProduct(const mt::Tensor<A, 2>& a, const mt::Tensor<B, 2>& b, mt::Tensor<T, 2> c, double eps)
+    {
+        const uint32_t m = a.getShape()[0];
+        const uint32_t k = a.getShape()[1];
+        const uint32_t n = b.getShape()[1];
+        for (uint32_t i = 0; i < m; ++i)
+        {
+            for (uint32_t j = 0; j < n; ++j)
+            {
+                double expected = 0;
+                for (uint32_t p = 0; p < k; ++p)
+                {
+                    expected += static_cast<double>(a(i, p)) * b(p, j);
+                }
+                ASSERT_NEAR(c(i, j), expected, eps) << i << ", " << j;
+            }
+        }
+    }
+
+    template <class T>
+    void checkSizes(double eps)
+    {
+        mt::ThreadPool pool(3);
+        const uint32_t sizes[][3] = {{1, 1, 1}, {7, 13, 5}, {6, 32, 16}, {65, 129, 300}, {100, 3, 517}};
+        mt_test::forEachIsa([&](mt::SimdIsa) {
+            for (const auto& size : sizes)
+            {
+                const uint32_t m = size[0];
+                const uint32_t n = size[1];
+                const uint32_t k = size[2];
+                std::vector<T> a_data = randomData<T>(m * k, m);
+                std::vector<T> b_data = randomData<T>(k * n, n);
+                std::vector<T> c_data(m * n);
+                mt::Tensor<const T, 2> a(a_data.data(), {m, k});
+                mt::Tensor<const T, 2> b(b_data.data(), {k, n});
+                mt::Tensor<T, 2> c(c_data.data(), {m, n});
+                mt::matmul(a, b, c);
+                checkProduct(a, b, c, eps * k);
+                std::fill(c_data.begin(), c_data.end(), T(0));
+                mt::matmul(a, b, c, &pool, 1);
+                checkProduct(a, b, c, eps * k);
+            }
+        });
+    }
+} // namespace
+
+TEST(matmul, sizes_float)
+{
+    checkSizes<float>(1e-6);
+}
+
+TEST(matmul, sizes_double)
+{
+    checkSizes<double>(1e-14);
+}
+
+TEST(matmul, strided_views)
+{
+    const uint32_t m = 37;
+    const uint32_t n = 41;
+    const uint32_t k = 29;
+    // Operands stored transposed and the output written into every other column of a wider matrix
+    std::vector<float> a_data = randomData<float>(k * m, 1);
+    std::vector<float> b_data = randomData<float>(n * k, 2);
+    std::vector<float> c_data(m * 2 * n, -1.0F);
+    mt::Tensor<const float, 2> a = mt::transpose(mt::Tensor<const float, 2>(a_data.data(), {k, m}), 0, 1);
+    mt::Tensor<const float, 2> b = mt::transpose(mt::Tensor<const float, 2>(b_data.data(), {n, k}), 0, 1);
+    mt::Shape<2> c_shape(m, n);
+    c_shape.setStride(0, 2 * n);
+    c_shape.setStride(1, 2);
+    mt::Tensor<float, 2> c(c_data.data(), c_shape);
+    mt::matmul(a, b, c);
+    checkProduct(a, b, c, 1e-5);
+    for (uint32_t i = 0; i < m * 2 * n; i += 2)
+    {
+        ASSERT_EQ(c_data[i + 1], -1.0F);
+    }
+}
+
+TEST(matmul, empty_inner_dim)
+{
+    std::vector<float> c_data(12, 1.0F);
+    mt::Tensor<const float, 2> a(nullptr, {3, 0});
+    mt::Tensor<const float, 2> b(nullptr, {0, 4});
+    mt::matmul(a, b, mt::Tensor<float, 2>(c_data.data(), {3, 4}));
+    for (float value : c_data)
+    {
+        ASSERT_EQ(value, 0.0F);
+    }
+}
+
+TEST(matmul, batched)
+{
+    mt::ThreadPool pool(3);
+    const uint32_t batches = 5;
+    std::vector<double> a_data = randomData<double>(batches * 9 * 20, 3);
+    std::vector<double> b_data = randomData<double>(20 * 11, 4);
+    mt::Tensor<const double, 3> a(a_data.data(), {batches, 9, 20});
+    // The same b for every batch
+    mt::Tensor<const double, 3> b =
+        mt::broadcastTo(mt::Tensor<const double, 2>(b_data.data(), {20, 11}), mt::Shape<3>(batches, 20, 11));
+    mt::TensorBuffer<double, 3> c = mt::matmul(a, b);
+    ASSERT_EQ(c.getShape(), mt::Shape<3>(batches, 9, 11));
+    std::vector<double> parallel_data(batches * 9 * 11);
+    mt::Tensor<double, 3> parallel(parallel_data.data(), {batches, 9, 11});
+    mt::matmul(a, b, parallel, &pool);
+    for (uint32_t i = 0; i < batches; ++i)
+    {
+        checkProduct(a[i], b[i], c.view()[i], 1e-12);
+        checkProduct(a[i], b[i], parallel[i], 1e-12);
+    }
+}
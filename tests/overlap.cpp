@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Elementwise.hpp>
+#include <minitensor/Expression.hpp>
+#include <minitensor/Parallel.hpp>
+#include <minitensor/Tensor.hpp>
+
+#include <numeric>
+#include <vector>
+
+TEST(overlap, analysis)
+{
+    std::vector<float> data(120);
+    const mt::Tensor<float, 1> all(data.data(), 120);
+    const mt::Tensor<float, 1> front(data.data(), 60);
+    const mt::Tensor<float, 1> back(data.data() + 60, 60);
+    const mt::Tensor<float, 1> middle(data.data() + 30, 60);
+    ASSERT_EQ(mt::memoryOverlap(front, back), mt::Overlap::None);
+    ASSERT_EQ(mt::memoryOverlap(front, middle), mt::Overlap::Partial);
+    ASSERT_EQ(mt::memoryOverlap(all, all), mt::Overlap::Same);
+    ASSERT_EQ(mt::memoryOverlap(front, mt::Tensor<float, 1>(data.data(), 0)), mt::Overlap::None);
+
+    // Red and green of a 4x10 interleaved rgb image never meet, red and a shifted red do
+    const mt::Tensor<float, 3> rgb(data.data(), {4, 10, 3});
+    const mt::Tensor<float, 2> red = mt::transpose(rgb, 0, 2)[0];
+    const mt::Tensor<float, 2> green = mt::transpose(rgb, 0, 2)[1];
+    ASSERT_EQ(mt::memoryOverlap(red, green), mt::Overlap::None);
+    const mt::Tensor<const float, 2> shifted(red.data() + 3, red.getShape());
+    ASSERT_EQ(mt::memoryOverlap(red, shifted), mt::Overlap::Partial);
+
+    // A matrix and its transpose
+    const mt::Tensor<float, 2> matrix(data.data(), {10, 10});
+    ASSERT_EQ(mt::memoryOverlap(matrix, mt::transpose(matrix, 0, 1)), mt::Overlap::Partial);
+}
+
+TEST(overlap, shift_ring)
+{
+    // 8 frames of 4x5 elements, frames move one slot towards the front and then back
+    const uint32_t frames = 8;
+    std::vector<int> ring(frames * 20);
+    std::iota(ring.begin(), ring.end(), 0);
+    const std::vector<int> original = ring;
+    mt::Tensor<int, 3> all(ring.data(), {frames, 4, 5});
+    const mt::Tensor<int, 3> head = mt::slice(all, mt::Range(0, frames - 1));
+    const mt::Tensor<int, 3> tail = mt::slice(all, mt::Range(1));
+    tail.copyTo(head);
+    for (size_t i = 0; i < ring.size() - 20; ++i)
+    {
+        ASSERT_EQ(ring[i], original[i + 20]);
+    }
+    ring = original;
+    head.copyTo(tail);
+    for (size_t i = 20; i < ring.size(); ++i)
+    {
+        ASSERT_EQ(ring[i], original[i - 20]);
+    }
+
+    // The same shifts by a single element within strided columns
+    ring = original;
+    mt::Tensor<int, 2> rows(ring.data(), {32, 5});
+    const mt::Tensor<int, 2> columns = mt::slice(rows, mt::Range(), mt::Range(0, 3));
+    const mt::Tensor<int, 2> later(ring.data() + 1, columns.getShape());
+    later.copyTo(columns);
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            ASSERT_EQ(ring[i * 5 + j], original[i * 5 + j + 1]);
+        }
+    }
+    ring = original;
+    columns.copyTo(later);
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            ASSERT_EQ(ring[i * 5 + j + 1], original[i * 5 + j]);
+        }
+    }
+}
+
+TEST(overlap, transpose_in_place)
+{
+    const uint32_t size = 67;
+    std::vector<double> data(size * size);
+    std::iota(data.begin(), data.end(), 0);
+    const std::vector<double> original = data;
+    mt::Tensor<double, 2> matrix(data.data(), {size, size});
+    mt::ThreadPool pool(3);
+    mt::transpose(matrix, 0, 1).copyTo(matrix, pool, 256);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        for (uint32_t j = 0; j < size; ++j)
+        {
+            ASSERT_EQ(matrix(i, j), original[j * size + i]);
+        }
+    }
+}
+
+TEST(overlap, elementwise)
+{
+    const uint32_t n = 100;
+    std::vector<float> x(n + 1);
+    std::vector<float> y(n, 0.5f);
+    std::iota(x.begin(), x.end(), 0.f);
+    const mt::Tensor<const float, 1> offsets(y.data(), n);
+
+    // x[i] = x[i + 1] + 0.5 runs forward without a copy
+    mt::add(mt::Tensor<const float, 1>(x.data() + 1, n), offsets, mt::Tensor<float, 1>(x.data(), n));
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(x[i], i + 1.5f);
+    }
+    // x[i + 1] = x[i] + 0.5 needs the inputs before they are overwritten
+    std::iota(x.begin(), x.end(), 0.f);
+    mt::add(mt::Tensor<const float, 1>(x.data(), n), offsets, mt::Tensor<float, 1>(x.data() + 1, n));
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(x[i + 1], i + 0.5f);
+    }
+    // In place
+    std::iota(x.begin(), x.end(), 0.f);
+    mt::Tensor<float, 1> view(x.data(), n);
+    mt::mul(view, offsets, view);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(x[i], i * 0.5f);
+    }
+
+    // m = m + transpose(m)
+    std::vector<int> values(16);
+    std::iota(values.begin(), values.end(), 0);
+    mt::Tensor<int, 2> m(values.data(), {4, 4});
+    mt::add(m, mt::transpose(m, 0, 1), m);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            ASSERT_EQ(m(i, j), static_cast<int>(i * 4 + j + j * 4 + i));
+        }
+    }
+}
+
+TEST(overlap, expression)
+{
+    std::vector<float> x(8);
+    std::iota(x.begin(), x.end(), 0.f);
+    mt::Tensor<float, 1> a(x.data(), 7);
+    mt::Tensor<float, 1> b(x.data() + 1, 7);
+
+    // b is a shifted one to the back, row major order would read a[i] after b[i - 1] overwrote it
+    b = a + 0.0f;
+    for (uint32_t i = 0; i < 7; ++i)
+    {
+        ASSERT_EQ(x[i + 1], static_cast<float>(i));
+    }
+    // The other way around runs in place
+    std::iota(x.begin(), x.end(), 0.f);
+    a = b * 2.0f;
+    for (uint32_t i = 0; i < 7; ++i)
+    {
+        ASSERT_EQ(x[i], 2.0f * (i + 1));
+    }
+    // Leaves that need opposite orders, and a reversed view of the destination
+    std::iota(x.begin(), x.end(), 0.f);
+    mt::Tensor<float, 1> middle(x.data() + 1, 6);
+    middle = mt::Tensor<float, 1>(x.data(), 6) + mt::Tensor<float, 1>(x.data() + 2, 6);
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        ASSERT_EQ(x[i + 1], 2.0f * (i + 1));
+    }
+    std::iota(x.begin(), x.end(), 0.f);
+    mt::Tensor<float, 1> all(x.data(), 8);
+    all = mt::slice(all, mt::Range(-1, mt::Range::END, -1)) - 1.0f;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        ASSERT_EQ(x[i], 6.0f - i);
+    }
+    // A leaf of a different element size, the bytes written from the second int on clobber ints still to be read
+    std::vector<int32_t> ints(8);
+    std::iota(ints.begin(), ints.end(), 0);
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(ints.data());
+    mt::Tensor<uint8_t, 1>(bytes + sizeof(int32_t), 8) = mt::Tensor<int32_t, 1>(ints.data(), 8) + 1;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        ASSERT_EQ(bytes[sizeof(int32_t) + i], i + 1);
+    }
+}
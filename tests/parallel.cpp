@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Parallel.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(parallel, covers_range_once)
+{
+    mt::ThreadPool pool(4);
+    ASSERT_EQ(pool.concurrency(), 4);
+    std::vector<std::atomic<int>> visits(10007);
+    for (std::atomic<int>& v : visits)
+    {
+        v = 0;
+    }
+    pool.parallelFor(0, visits.size(), 100, [&visits](uint64_t begin, uint64_t end) {
+        ASSERT_LE(end - begin, 100);
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            ++visits[i];
+        }
+    });
+    for (const std::atomic<int>& v : visits)
+    {
+        ASSERT_EQ(v, 1);
+    }
+}
+
+TEST(parallel, nested)
+{
+    mt::ThreadPool pool(3);
+    std::atomic<uint64_t> sum(0);
+    pool.parallelFor(0, 16, 1, [&](uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            pool.parallelFor(0, 100, 10, [&](uint64_t b, uint64_t e) { sum += e - b; });
+        }
+    });
+    ASSERT_EQ(sum, 1600);
+}
+
+TEST(parallel, exception)
+{
+    mt::ThreadPool pool(4);
+    std::atomic<uint64_t> count(0);
+    ASSERT_THROW(pool.parallelFor(0, 1000, 10,
+                                  [&count](uint64_t begin, uint64_t end) {
+                                      count += end - begin;
+                                      if (begin == 500)
+                                      {
+                                          throw std::runtime_error("failed");
+                                      }
+                                  }),
+                 std::runtime_error);
+    // The other chunks still ran before the exception was rethrown
+    ASSERT_EQ(count, 1000);
+}
+
+TEST(parallel, tensor)
+{
+    mt::ThreadPool pool(4);
+    std::vector<int> data(6 * 50, 0);
+    // Every other column of a 6x50 matrix
+    mt::Shape<2> shape(6, 25);
+    shape.setStride(0, 50);
+    shape.setStride(1, 2);
+    mt::Tensor<int, 2> view(data.data(), shape);
+    mt::parallelFor(
+        view,
+        [](int* row, uint32_t n, int64_t step) {
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                row[i * step] += 1;
+            }
+        },
+        7,
+        pool);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        ASSERT_EQ(data[i], i % 2 == 0 ? 1 : 0);
+    }
+}
+
+TEST(parallel, copy_and_fill)
+{
+    mt::ThreadPool pool(4);
+    std::vector<float> src_data(64 * 33);
+    for (size_t i = 0; i < src_data.size(); ++i)
+    {
+        src_data[i] = static_cast<float>(i);
+    }
+    mt::Tensor<float, 2> src(src_data.data(), {64, 33});
+    std::vector<float> dst_data(64 * 33);
+    mt::Tensor<float, 2> dst(dst_data.data(), {64, 33});
+    src.copyTo(dst, pool, 100);
+    ASSERT_EQ(dst_data, src_data);
+
+    // Crop of the inner dimension
+    mt::Shape<2> crop(64, 30);
+    crop.setStride(0, 33);
+    mt::fill(mt::Tensor<float, 2>(dst_data.data() + 1, crop), -1, &pool, 50);
+    for (size_t i = 0; i < dst_data.size(); ++i)
+    {
+        const size_t col = i % 33;
+        ASSERT_EQ(dst_data[i], col >= 1 && col <= 30 ? -1 : src_data[i]);
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/Format.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+TEST(print, layout)
+{
+    std::vector<int> data(12);
+    std::iota(data.begin(), data.end(), 0);
+    ASSERT_EQ(mt::format(mt::Tensor<int, 1>(data.data(), 4)), "[0 1 2 3]");
+    // Columns are right aligned to the widest element
+    ASSERT_EQ(mt::format(mt::Tensor<int, 2>(data.data(), {3, 4})), "[[ 0  1  2  3]\n [ 4  5  6  7]\n [ 8  9 10 11]]");
+    ASSERT_EQ(mt::format(mt::Tensor<int, 3>(data.data(), {2, 2, 3})),
+              "[[[ 0  1  2]\n  [ 3  4  5]]\n\n [[ 6  7  8]\n  [ 9 10 11]]]");
+
+    mt::FormatOptions options;
+    options.single_line = true;
+    ASSERT_EQ(mt::format(mt::Tensor<int, 3>(data.data(), {2, 2, 3}), options),
+              "[[[0 1 2] [3 4 5]] [[6 7 8] [9 10 11]]]");
+
+    // Strided views print their logical elements
+    mt::Tensor<int, 2> column = mt::slice(mt::Tensor<int, 2>(data.data(), {3, 4}), mt::Range(-1, mt::Range::END, -1),
+                                          mt::Range(1, 2));
+    ASSERT_EQ(mt::format(column), "[[9]\n [5]\n [1]]");
+    ASSERT_EQ(mt::format(mt::Tensor<int, 2>(data.data(), {0, 4})), "[]");
+}
+
+TEST(print, values)
+{
+    std::vector<float> floats({0.5F, -2.0F, 1.0F / 3.0F, 1e20F});
+    mt::Tensor<float, 1> tensor(floats.data(), 4);
+    ASSERT_EQ(mt::format(tensor), "[     0.5       -2 0.333333    1e+20]");
+    mt::FormatOptions options;
+    options.precision = 3;
+    options.single_line = true;
+    ASSERT_EQ(mt::format(tensor, options), "[0.5 -2 0.333 1e+20]");
+
+    std::vector<int64_t> ints({std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()});
+    ASSERT_EQ(mt::format(mt::Tensor<int64_t, 1>(ints.data(), 2), options),
+              "[-9223372036854775808 9223372036854775807]");
+    std::vector<uint8_t> bytes({0, 255});
+    ASSERT_EQ(mt::format(mt::Tensor<uint8_t, 1>(bytes.data(), 2), options), "[0 255]");
+
+    bool flags[] = {true, false, true, true};
+    ASSERT_EQ(mt::format(mt::Tensor<bool, 2>(flags, {2, 2})), "[[ true false]\n [ true  true]]");
+
+    // Precision beyond what round trips a double prints 17 digits
+    std::vector<double> doubles({-1.0 / 3.0, -1e-300 / 3.0});
+    char expected[64];
+    std::snprintf(expected, sizeof(expected), "[%.17g %.17g]", doubles[0], doubles[1]);
+    options.precision = 40;
+    ASSERT_EQ(mt::format(mt::Tensor<double, 1>(doubles.data(), 2), options), expected);
+}
+
+TEST(print, summarize)
+{
+    std::vector<int> data(100 * 100);
+    std::iota(data.begin(), data.end(), 0);
+    mt::FormatOptions options;
+    options.summarize = true;
+    options.edge_items = 2;
+    options.single_line = true;
+    ASSERT_EQ(mt::format(mt::Tensor<int, 1>(data.data(), 10000), options), "[0 1 ... 9998 9999]");
+    // Below the threshold everything is printed
+    ASSERT_EQ(mt::format(mt::Tensor<int, 1>(data.data(), 6), options), "[0 1 2 3 4 5]");
+
+    options.single_line = false;
+    mt::TensorFormatter formatter(options);
+    ASSERT_EQ(formatter.format(mt::Tensor<int, 2>(data.data(), {100, 100})),
+              "[[   0    1 ...   98   99]\n [ 100  101 ...  198  199]\n ...\n [9800 9801 ... 9898 9899]\n [9900 "
+              "9901 ... 9998 9999]]");
+    // The buffer is reused
+    const std::string* text = &formatter.format(mt::Tensor<int, 1>(data.data(), 3));
+    ASSERT_EQ(*text, "[0 1 2]");
+    ASSERT_EQ(text, &formatter.format(mt::Tensor<int, 1>(data.data(), 3)));
+
+    // Without edge items only the gap is left
+    options.edge_items = 0;
+    std::vector<float> values(2000, 1.5f);
+    ASSERT_EQ(mt::format(mt::Tensor<float, 1>(values.data(), 2000), options), "[...]");
+    ASSERT_EQ(mt::format(mt::Tensor<float, 2>(values.data(), {40, 50}), options), "[...]");
+}
+
+TEST(print, matches_printf)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> mantissa(-10, 10);
+    std::uniform_int_distribution<int> exponent(-7, 12);
+    const double specials[] = {0.5, 0.125, 2.5, 9.9999995, 999999.5, 0.00099999995, 1e-5, 123456789.0, -0.0};
+    for (int precision = 1; precision <= 17; ++precision)
+    {
+        for (int i = 0; i < 2000; ++i)
+        {
+            const double value = i < 9 ? specials[i] : mantissa(rng) * std::pow(10.0, exponent(rng));
+            char expected[64];
+            std::snprintf(expected, sizeof(expected), "%.*g", precision, value);
+            char text[mt::detail::FORMAT_CHARS];
+            ASSERT_EQ(std::string(text, mt::detail::formatValue(text, value, precision)), expected);
+            const float single = static_cast<float>(value);
+            std::snprintf(expected, sizeof(expected), "%.*g", precision, static_cast<double>(single));
+            ASSERT_EQ(std::string(text, mt::detail::formatValue(text, single, precision)), expected);
+        }
+    }
+}
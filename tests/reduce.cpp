@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "test_utils.hpp"
+
+#include <minitensor/Reduce.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+TEST(reduce, every_axis)
+{
+    std::vector<float> data = mt_test::randomData<float>(4 * 5 * 6, 1, -10, 10);
+    mt::Tensor<const float, 3> in(data.data(), {4, 5, 6});
+    for (uint8_t axis = 0; axis < 3; ++axis)
+    {
+        mt::TensorBuffer<float, 2> sum = mt::sum(in, axis);
+        mt::TensorBuffer<float, 2> max = mt::max(in, axis);
+        mt::TensorBuffer<uint32_t, 2> argmax = mt::argmax(in, axis);
+        mt::Shape<2> shape = sum.getShape();
+        ASSERT_EQ(shape, mt::squeezeDim(axis, in.getShape()));
+        for (uint32_t i = 0; i < shape[0]; ++i)
+        {
+            for (uint32_t j = 0; j < shape[1]; ++j)
+            {
+                double expected_sum = 0;
+                float expected_max = -INFINITY;
+                uint32_t expected_argmax = 0;
+                for (uint32_t k = 0; k < in.getShape()[axis]; ++k)
+                {
+                    const float value = axis == 0 ? in(k, i, j) : axis == 1 ? in(i, k, j) : in(i, j, k);
+                    expected_sum += value;
+                    if (value > expected_max)
+                    {
+                        expected_max = value;
+                        expected_argmax = k;
+                    }
+                }
+                ASSERT_NEAR(sum.view()(i, j), expected_sum, 1e-4);
+                ASSERT_EQ(max.view()(i, j), expected_max);
+                ASSERT_EQ(argmax.view()(i, j), expected_argmax);
+            }
+        }
+    }
+}
+
+TEST(reduce, mean_min_norm)
+{
+    std::vector<int> data({3, -4, 1, 2, 0, 5});
+    mt::Tensor<int, 2> in(data.data(), {2, 3});
+    std::vector<int> out_data(3);
+    mt::Tensor<int, 1> out(out_data.data(), 3);
+
+    mt::min(in, 0, out);
+    ASSERT_EQ(out_data, std::vector<int>({2, -4, 1}));
+    mt::mean(in, 0, out);
+    ASSERT_EQ(out_data, std::vector<int>({2, -2, 3}));
+
+    std::vector<float> vec({3, 4});
+    mt::TensorBuffer<float, 0> norm = mt::norm(mt::Tensor<float, 1>(vec.data(), 2), 0);
+    ASSERT_EQ(*norm.data(), 5);
+}
+
+TEST(reduce, strided_view)
+{
+    // Every other column of a 3x8 matrix, reduced along both axes
+    std::vector<float> data = mt_test::randomData<float>(24, 2, -10, 10);
+    mt::Shape<2> shape(3, 4);
+    shape.setStride(0, 8);
+    shape.setStride(1, 2);
+    mt::Tensor<float, 2> in(data.data(), shape);
+    mt::TensorBuffer<float, 1> rows = mt::sum(in, 1);
+    mt::TensorBuffer<float, 1> cols = mt::sum(in, 0);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        ASSERT_FLOAT_EQ(rows.view()[i], ((data[i * 8] + data[i * 8 + 2]) + data[i * 8 + 4]) + data[i * 8 + 6]);
+    }
+    for (uint32_t j = 0; j < 4; ++j)
+    {
+        ASSERT_FLOAT_EQ(cols.view()[j], (data[j * 2] + data[8 + j * 2]) + data[16 + j * 2]);
+    }
+}
+
+TEST(reduce, accuracy)
+{
+    // A naive float accumulation of ten million 0.1 is off by several percent
+    const uint32_t size = 10000000;
+    std::vector<float> data(size, 0.1F);
+    mt::Tensor<float, 1> row(data.data(), size);
+    ASSERT_NEAR(*mt::sum(row, 0).data(), 1e6, 1);
+
+    mt::Tensor<float, 2> column(data.data(), {size, 1});
+    ASSERT_NEAR(*mt::sum(column, 0).data(), 1e6, 1);
+}
+
+TEST(reduce, deterministic)
+{
+    // Identical bits for every instruction set and with or without a pool, for many and for few outputs
+    std::vector<float> data = mt_test::randomData<float>(64 * 4099, 3, -10, 10);
+    mt::ThreadPool pool(4);
+    mt::Tensor<float, 2> in(data.data(), {64, 4099});
+    mt::Tensor<float, 1> flat(data.data(), 64 * 4099);
+    const mt::SimdIsa supported = mt::detectSimdIsa();
+    mt::setSimdIsa(mt::SimdIsa::Scalar);
+    mt::TensorBuffer<float, 1> rows = mt::sum(in, 1);
+    mt::TensorBuffer<float, 1> cols = mt::sum(in, 0);
+    mt::TensorBuffer<float, 1> norms = mt::norm(in, 1);
+    const float total = *mt::sum(flat, 0).data();
+    for (uint8_t isa = 0; isa <= static_cast<uint8_t>(supported); ++isa)
+    {
+        mt::setSimdIsa(static_cast<mt::SimdIsa>(isa));
+        for (mt::ThreadPool* p : {static_cast<mt::ThreadPool*>(nullptr), &pool})
+        {
+            mt::TensorBuffer<float, 1> rows_again = mt::sum(in, 1, p);
+            mt::TensorBuffer<float, 1> cols_again = mt::sum(in, 0, p);
+            mt::TensorBuffer<float, 1> norms_again = mt::norm(in, 1, p);
+            std::vector<float> small(1);
+            mt::reduce(flat, 0, mt::ops::ReduceSum(), mt::Tensor<float, 0>(small.data()), p, 1000);
+            ASSERT_EQ(std::memcmp(rows.data(), rows_again.data(), 64 * sizeof(float)), 0);
+            ASSERT_EQ(std::memcmp(cols.data(), cols_again.data(), 4099 * sizeof(float)), 0);
+            ASSERT_EQ(std::memcmp(norms.data(), norms_again.data(), 64 * sizeof(float)), 0);
+            ASSERT_EQ(std::memcmp(&total, small.data(), sizeof(float)), 0);
+        }
+    }
+    mt::setSimdIsa(supported);
+}
+
+TEST(reduce, outer_axis_few_outputs)
+{
+    // Fewer outputs than threads, the pool splits the axis instead and the result keeps its bits
+    const uint32_t size = 1000003;
+    std::vector<float> data = mt_test::randomData<float>(size * 2, 4, -10, 10);
+    mt::Tensor<float, 2> in(data.data(), {size, 2});
+    mt::ThreadPool pool(4);
+    const mt::TensorBuffer<float, 1> sums = mt::sum(in, 0);
+    const mt::TensorBuffer<float, 1> pooled_sums = mt::sum(in, 0, &pool);
+    const mt::TensorBuffer<float, 1> norms = mt::norm(in, 0);
+    const mt::TensorBuffer<float, 1> pooled_norms = mt::norm(in, 0, &pool);
+    const mt::TensorBuffer<float, 1> maxima = mt::max(in, 0);
+    const mt::TensorBuffer<float, 1> pooled_maxima = mt::max(in, 0, &pool);
+    ASSERT_EQ(std::memcmp(sums.data(), pooled_sums.data(), 2 * sizeof(float)), 0);
+    ASSERT_EQ(std::memcmp(norms.data(), pooled_norms.data(), 2 * sizeof(float)), 0);
+    ASSERT_EQ(std::memcmp(maxima.data(), pooled_maxima.data(), 2 * sizeof(float)), 0);
+    for (uint32_t j = 0; j < 2; ++j)
+    {
+        double sum = 0;
+        float max = -std::numeric_limits<float>::infinity();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            sum += data[i * 2 + j];
+            max = std::max(max, data[i * 2 + j]);
+        }
+        ASSERT_NEAR(sums.data()[j], sum, 1e-6 * size);
+        ASSERT_EQ(maxima.data()[j], max);
+    }
+}
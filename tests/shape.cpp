@@ -3,6 +3,8 @@
 #include <minitensor/Shape.hpp>
 
 #include <iostream>
+#include <string>
+#include <typeinfo>
 #include <vector>
 
 TEST(shape, construct)
@@ -41,4 +43,110 @@ TEST(shape, linear_index)
     ASSERT_EQ(shape.index(1, 1), 5);
     ASSERT_EQ(shape.index(5), 5);
     ASSERT_EQ(shape.index(6), 6);
-}
\ No newline at end of file
+}
+TEST(shape, linear_index_3d)
+{
+    mt::Shape<3> shape(2, 3, 4);
+    ASSERT_EQ(shape.index(13), shape.index(1, 0, 1));
+    ASSERT_EQ(shape.index(23), shape.index(1, 2, 3));
+
+    shape.setStride(2, 2);
+    shape.setStride(1, 8);
+    shape.setStride(0, 24);
+    ASSERT_EQ(shape.index(13), 26);
+}
+
+TEST(shape, broadcast)
+{
+    mt::Shape<3> target(2, 3, 4);
+
+    mt::Shape<3> row = mt::broadcastShape(mt::Shape<1>(4), target);
+    ASSERT_EQ(row, target);
+    ASSERT_EQ(row.getStride(0), 0);
+    ASSERT_EQ(row.getStride(1), 0);
+    ASSERT_EQ(row.getStride(2), 1);
+    ASSERT_TRUE(row.isBroadcast(0));
+    ASSERT_FALSE(row.isBroadcast(2));
+    ASSERT_FALSE(row.isContinuous());
+
+    mt::Shape<3> channel = mt::broadcastShape(mt::Shape<3>(2, 1, 4), target);
+    ASSERT_EQ(channel.getStride(0), 4);
+    ASSERT_EQ(channel.getStride(1), 0);
+    ASSERT_EQ(channel.getStride(2), 1);
+    ASSERT_TRUE(channel.isBroadcast(1));
+
+    channel.calculateStride();
+    ASSERT_FALSE(channel.isBroadcast(1));
+    ASSERT_TRUE(channel.isContinuous());
+}
+
+TEST(shape, continuous_unit_dims)
+{
+    // The stride of a dimension of size 1 is never used
+    mt::Shape<3> shape(1, 4, 1);
+    shape.setStride(0, 0);
+    shape.setStride(2, 7);
+    shape.setStride(1, 1);
+    ASSERT_TRUE(shape.isContinuous());
+    ASSERT_FALSE(shape.isBroadcast(0));
+}
+
+TEST(shape, permute)
+{
+    mt::Shape<4> nchw(2, 3, 4, 5);
+    mt::Shape<4> nhwc = mt::permuteShape(nchw, {0, 2, 3, 1});
+    ASSERT_EQ(nhwc, mt::Shape<4>(2, 4, 5, 3));
+    ASSERT_EQ(nhwc.getStride(0), 60);
+    ASSERT_EQ(nhwc.getStride(1), 5);
+    ASSERT_EQ(nhwc.getStride(2), 1);
+    ASSERT_EQ(nhwc.getStride(3), 20);
+    ASSERT_EQ(nhwc.index(1, 2, 3, 1), nchw.index(1, 1, 2, 3));
+}
+
+TEST(shape, slice_dim)
+{
+    mt::Shape<2> shape(10, 6);
+    // Every other row starting at the third one
+    ASSERT_EQ(mt::sliceDim(shape, 0, mt::Range(2, mt::Range::END, 2)), 12);
+    ASSERT_EQ(shape, mt::Shape<2>(4, 6));
+    ASSERT_EQ(shape.getStride(0), 12);
+
+    // Negative indices count from the back
+    ASSERT_EQ(mt::sliceDim(shape, 1, mt::Range(-4, -1)), 2);
+    ASSERT_EQ(shape, mt::Shape<2>(4, 3));
+    ASSERT_EQ(shape.getStride(1), 1);
+
+    mt::Shape<1> reversed(5);
+    ASSERT_EQ(mt::sliceDim(reversed, 0, mt::Range(-1, mt::Range::END, -2)), 4);
+    ASSERT_EQ(reversed[0], 3);
+    ASSERT_EQ(static_cast<int32_t>(reversed.getStride(0)), -2);
+
+    mt::Shape<1> empty(5);
+    ASSERT_EQ(mt::sliceDim(empty, 0, mt::Range(3, 3)), 0);
+    ASSERT_EQ(empty[0], 0);
+}
+
+TEST(shape, index_namespace)
+{
+    // The index width is part of every mangled name, so mixed builds fail to link
+    const std::string name = typeid(mt::Shape<2>).name();
+#ifdef MT_INDEX_64
+    ASSERT_NE(name.find("index64"), std::string::npos) << name;
+#else
+    ASSERT_NE(name.find("index32"), std::string::npos) << name;
+#endif
+}
+
+#ifdef MT_INDEX_64
+TEST(shape, strides_beyond_32_bit)
+{
+    mt::Shape<3> shape(10, 50000, 50000);
+    ASSERT_EQ(shape.getStride(0), 2500000000ULL);
+    ASSERT_EQ(shape.numElements(), 25000000000ULL);
+    ASSERT_EQ(shape.index(9, 49999, 49999), 24999999999ULL);
+    ASSERT_EQ(shape.index(size_t(24999999999ULL)), 24999999999ULL);
+
+    ASSERT_EQ(mt::sliceDim(shape, 0, mt::Range(-1, mt::Range::END, -1)), 9 * 2500000000LL);
+    ASSERT_EQ(static_cast<mt::Stride_t>(shape.getStride(0)), -2500000000LL);
+}
+#endif
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "test_utils.hpp"
+
+#include <minitensor/Elementwise.hpp>
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    template <class T>
+    std::vector<T> randomData(size_t size, uint32_t seed)
+    {
+        return mt_test::randomData<T>(size, seed, T(-300), T(300));
+    }
+
+    // Runs fn for every instruction set the cpu supports and checks the output bytes match the scalar kernels
+    template <class T, class F>
+    void expectIdenticalAcrossIsa(size_t size, F&& fn)
+    {
+        const mt::SimdIsa supported = mt::detectSimdIsa();
+        std::vector<T> reference(size);
+        mt::setSimdIsa(mt::SimdIsa::Scalar);
+        fn(reference);
+        for (uint8_t isa = 1; isa <= static_cast<uint8_t>(supported); ++isa)
+        {
+            mt::setSimdIsa(static_cast<mt::SimdIsa>(isa));
+            std::vector<T> out(size);
+            fn(out);
+            EXPECT_EQ(std::memcmp(out.data(), reference.data(), size * sizeof(T)), 0)
+                << mt::simdIsaName(static_cast<mt::SimdIsa>(isa)) << " " << typeid(T).name();
+        }
+        mt::setSimdIsa(supported);
+    }
+
+    template <class T>
+    void checkOps()
+    {
+        // Odd sizes and offsets leave unaligned heads and partial tails
+        const uint32_t rows = 3;
+        const uint32_t cols = 131;
+        std::vector<T> a_data = randomData<T>(rows * cols + 1, 1);
+        std::vector<T> b_data = randomData<T>(rows * cols + 1, 2);
+        std::vector<T> c_data = randomData<T>(rows * cols + 1, 3);
+        mt::Tensor<const T, 2> a(a_data.data() + 1, {rows, cols});
+        mt::Tensor<const T, 2> b(b_data.data(), {rows, cols});
+        mt::Tensor<const T, 2> c(c_data.data() + 1, {rows, cols});
+        auto out = [=](std::vector<T>& data) { return mt::Tensor<T, 2>(data.data() + 1, {rows, cols}); };
+        const size_t size = rows * cols + 1;
+
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::add(a, b, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::mul(a, b, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::min(a, b, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::max(a, b, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::fma(a, b, c, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::abs(a, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::clamp(a, T(2), T(40), out(o)); });
+
+        // Broadcast operands, a row repeated down the columns and a column repeated along every row
+        mt::Tensor<const T, 1> row(b_data.data() + 1, cols);
+        mt::Tensor<const T, 2> column(c_data.data(), {rows, 1});
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::add(a, row, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::mul(column, a, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::fma(a, column, row, out(o)); });
+        expectIdenticalAcrossIsa<T>(size, [&](std::vector<T>& o) { mt::max(row, column, out(o)); });
+    }
+} // namespace
+
+TEST(simd, float) { checkOps<float>(); }
+TEST(simd, double) { checkOps<double>(); }
+TEST(simd, int32) { checkOps<int32_t>(); }
+TEST(simd, uint8) { checkOps<uint8_t>(); }
+
+TEST(simd, scalar_reference)
+{
+    std::vector<float> a_data({-1.5F, 2, -3, 4, 5});
+    std::vector<float> b_data({1, 1, 2, 2, 3});
+    std::vector<float> out_data(5);
+    mt::Tensor<float, 1> a(a_data.data(), 5);
+    mt::Tensor<float, 1> b(b_data.data(), 5);
+    mt::Tensor<float, 1> out(out_data.data(), 5);
+
+    mt::fma(a, b, b, out);
+    ASSERT_EQ(out_data, std::vector<float>({-0.5F, 3, -4, 10, 18}));
+    mt::abs(a, out);
+    ASSERT_EQ(out_data, std::vector<float>({1.5F, 2, 3, 4, 5}));
+    mt::clamp(a, 0.0F, 4.0F, out);
+    ASSERT_EQ(out_data, std::vector<float>({0, 2, 0, 4, 4}));
+    mt::min(a, b, out);
+    ASSERT_EQ(out_data, std::vector<float>({-1.5F, 1, -3, 2, 3}));
+}
+
+TEST(simd, strided)
+{
+    // Every other element of the inputs, the output is written densely
+    std::vector<int32_t> a_data = randomData<int32_t>(200, 4);
+    std::vector<int32_t> b_data = randomData<int32_t>(100, 5);
+    std::vector<int32_t> out_data(100);
+    mt::Shape<1> strided(100);
+    strided.setStride(0, 2);
+    mt::Tensor<const int32_t, 1> a(a_data.data(), strided);
+    mt::Tensor<const int32_t, 1> b(b_data.data(), 100);
+    mt::add(a, b, mt::Tensor<int32_t, 1>(out_data.data(), 100));
+    for (size_t i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(out_data[i], a_data[i * 2] + b_data[i]);
+    }
+}
+
+TEST(simd, broadcast)
+{
+    std::vector<float> a_data({1, 2, 3, 4, 5, 6});
+    std::vector<float> row_data({10, 20, 30});
+    std::vector<float> column_data({-1, 1});
+    std::vector<float> out_data(6);
+    mt::Tensor<float, 2> a(a_data.data(), {2, 3});
+    mt::Tensor<float, 1> row(row_data.data(), 3);
+    mt::Tensor<float, 2> column(column_data.data(), {2, 1});
+    mt::Tensor<float, 2> out(out_data.data(), {2, 3});
+
+    mt::add(a, row, out);
+    ASSERT_EQ(out_data, std::vector<float>({11, 22, 33, 14, 25, 36}));
+    mt::fma(a, column, row, out);
+    ASSERT_EQ(out_data, std::vector<float>({9, 18, 27, 14, 25, 36}));
+    mt::mul(row, column, out);
+    ASSERT_EQ(out_data, std::vector<float>({-10, -20, -30, 10, 20, 30}));
+}
+
+TEST(simd, sliced)
+{
+    // Rows of a crop keep unit stride and go through the vector kernels, the reversed view does not
+    std::vector<float> a_data = randomData<float>(16 * 40, 6);
+    std::vector<float> out_data(8 * 33);
+    mt::Tensor<const float, 2> a(a_data.data(), {16, 40});
+    mt::Tensor<float, 2> out(out_data.data(), {8, 33});
+    mt::Tensor<const float, 2> crop = mt::slice(a, mt::Range(3, 11), mt::Range(5, 38));
+    mt::Tensor<const float, 2> reversed = mt::slice(a, mt::Range(-1, 0, -2), mt::Range(-1, 6, -1));
+    mt::add(crop, reversed, out);
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        for (uint32_t j = 0; j < 33; ++j)
+        {
+            ASSERT_EQ(out(i, j), a(i + 3, j + 5) + a(15 - 2 * i, 39 - j));
+        }
+    }
+}
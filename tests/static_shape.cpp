@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/StaticShape.hpp>
+
+#include <numeric>
+#include <vector>
+
+// Everything about an all static shape is a constant expression
+static_assert(mt::StaticShape<2, 3, 4>().getStride(0) == 12, "");
+static_assert(mt::StaticShape<2, 3, 4>().index(1, 2, 3) == 23, "");
+static_assert(mt::StaticShape<2, 3, 4>().index(-1, -1, -1) == 23, "");
+static_assert(mt::StaticShape<2, 3, 4>().numElements() == 24, "");
+static_assert(mt::StaticShape<3, 3>::NUM_DYNAMIC == 0, "");
+
+TEST(static_shape, construct)
+{
+    mt::StaticShape<5, 4, 3, 2> shape;
+    ASSERT_EQ(shape[0], 5);
+    ASSERT_EQ(shape[3], 2);
+    ASSERT_EQ(shape[-1], 2);
+    ASSERT_EQ(shape.getStride(0), 4 * 3 * 2);
+    ASSERT_EQ(shape.getStride(2), 2);
+    ASSERT_EQ(shape.getStride(3), 1);
+    ASSERT_EQ(shape.index(1, 1, 1, 1), 33);
+
+    // Converts to the runtime shape
+    mt::Shape<4> dynamic = shape;
+    ASSERT_EQ(dynamic, mt::Shape<4>(5, 4, 3, 2));
+    ASSERT_EQ(dynamic.getStride(1), 6);
+    ASSERT_EQ(dynamic.index(1, 1, 1, 1), 33);
+    ASSERT_EQ((mt::StaticShape<5, 4, 3, 2>(dynamic)), shape);
+}
+
+TEST(static_shape, mixed)
+{
+    mt::StaticShape<mt::DYNAMIC_SIZE, 4, 4> shape(7);
+    static_assert(mt::StaticShape<mt::DYNAMIC_SIZE, 4, 4>::NUM_DYNAMIC == 1, "");
+    ASSERT_EQ(shape[0], 7);
+    ASSERT_EQ(shape.numElements(), 7 * 16);
+    ASSERT_EQ(shape.index(2, 1, 3), 2 * 16 + 4 + 3);
+
+    mt::StaticShape<3, mt::DYNAMIC_SIZE, 2, mt::DYNAMIC_SIZE> inner(5, 6);
+    ASSERT_EQ(inner[1], 5);
+    ASSERT_EQ(inner[3], 6);
+    ASSERT_EQ(inner.getStride(0), 5 * 2 * 6);
+    ASSERT_EQ(inner.getStride(2), 6);
+    const mt::Shape<4> dynamic = inner;
+    ASSERT_EQ(dynamic.index(2, 4, 1, 5), inner.index(2, 4, 1, 5));
+}
+
+TEST(static_shape, tensor)
+{
+    std::vector<float> data(2 * 3 * 4);
+    std::iota(data.begin(), data.end(), 0.0F);
+    mt::StaticTensor<float, mt::StaticShape<2, 3, 4>> tensor(data.data());
+    ASSERT_EQ(tensor(1, 2, 3), 23.0F);
+    ASSERT_EQ(tensor[1][2][3], 23.0F);
+    tensor[0][1][2] = -1.0F;
+    ASSERT_EQ(data[6], -1.0F);
+    tensor(0, 1, 2) = 6.0F;
+
+    // Interoperates with runtime views in both directions
+    mt::Tensor<float, 3> view = tensor;
+    ASSERT_EQ(view.getShape(), mt::Shape<3>(2, 3, 4));
+    ASSERT_EQ(view(1, 0, 1), 13.0F);
+    const mt::Tensor<const float, 3> const_view = tensor;
+    ASSERT_EQ(const_view(1, 2, 0), 20.0F);
+    mt::StaticTensor<float, mt::StaticShape<2, 3, 4>> back(view);
+    ASSERT_EQ(back.data(), data.data());
+
+    std::vector<float> copy(data.size());
+    tensor.copyTo(mt::Tensor<float, 3>(copy.data(), {2, 3, 4}));
+    ASSERT_EQ(copy, data);
+
+    // Batch of runtime length holding static 2x2 blocks
+    typedef mt::StaticShape<mt::DYNAMIC_SIZE, 2, 2> BatchShape;
+    mt::StaticTensor<const float, BatchShape> batch(data.data(), BatchShape(6));
+    ASSERT_EQ(batch.getShape()[0], 6);
+    ASSERT_EQ(batch[5](1, 1), 23.0F);
+    ASSERT_EQ(batch(3, 0, 1), 13.0F);
+}
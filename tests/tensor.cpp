@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <minitensor/Tensor.hpp>
+#include <minitensor/TensorBuffer.hpp>
 
 #include <iostream>
 std::vector<float> makeVec()
@@ -83,4 +84,229 @@ TEST(tensor, type_erasure)
     ASSERT_EQ(ss.str(),
               "size: 5 2 2\nstride: 4 2 1\nDataType: f\n   0  1\n   2  3\n\n   4  5\n   6  7\n\n   8  9\n   10  11\n\n "
               "  12  13\n   14  15\n\n   16  17\n   18  19\n\n\n");
-}
\ No newline at end of file
+}
+
+TEST(tensor, copy_dense)
+{
+    std::vector<float> vec = makeVec();
+    std::vector<float> out(20, -1);
+    mt::Tensor<float, 3> src(vec.data(), {5, 2, 2});
+    mt::Tensor<float, 3> dst(out.data(), {5, 2, 2});
+    src.copyTo(dst);
+    ASSERT_EQ(out, vec);
+}
+
+TEST(tensor, copy_strided)
+{
+    std::vector<float> vec = makeVec();
+    std::vector<float> out(6, -1);
+    // Crop the 3x3 top left corner of a 5x4 matrix, then take every other column
+    mt::Shape<2> crop_shape(3, 2);
+    crop_shape.setStride(0, 4);
+    crop_shape.setStride(1, 2);
+    mt::Tensor<const float, 2> src(vec.data(), crop_shape);
+    mt::Tensor<float, 2> dst(out.data(), {3, 2});
+    src.copyTo(dst);
+    ASSERT_EQ(out, std::vector<float>({0, 2, 4, 6, 8, 10}));
+}
+
+TEST(tensor, copy_into_strided)
+{
+    std::vector<float> vec = makeVec();
+    std::vector<float> out(20, -1);
+    // Write a 5x2 tensor into the right half of a 5x4 matrix
+    mt::Tensor<float, 2> src(vec.data(), {5, 2});
+    mt::Shape<2> dst_shape(5, 2);
+    dst_shape.setStride(0, 4);
+    mt::Tensor<float, 2> dst(out.data() + 2, dst_shape);
+    src.copyTo(dst);
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(out[i * 4 + 0], -1);
+        ASSERT_EQ(out[i * 4 + 1], -1);
+        ASSERT_EQ(out[i * 4 + 2], i * 2);
+        ASSERT_EQ(out[i * 4 + 3], i * 2 + 1);
+    }
+}
+
+TEST(tensor, element_iterator)
+{
+    std::vector<float> vec = makeVec();
+    // Every other column of the 5x4 matrix
+    mt::Shape<2> shape(5, 2);
+    shape.setStride(0, 4);
+    shape.setStride(1, 2);
+    mt::Tensor<const float, 2> tensor(vec.data(), shape);
+
+    std::vector<float> visited;
+    for (const float& val : mt::elements(tensor))
+    {
+        visited.push_back(val);
+    }
+    ASSERT_EQ(visited, std::vector<float>({0, 2, 4, 6, 8, 10, 12, 14, 16, 18}));
+
+    auto itr = mt::elements(tensor).begin();
+    ++itr;
+    ASSERT_EQ(itr.index(0), 0);
+    ASSERT_EQ(itr.index(1), 1);
+    ASSERT_EQ(itr.carried(), 0);
+    ++itr;
+    ASSERT_EQ(itr.index(0), 1);
+    ASSERT_EQ(itr.index(1), 0);
+    ASSERT_EQ(itr.carried(), 1);
+}
+
+TEST(tensor, assign_vector_strided)
+{
+    std::vector<float> vec(20, -1);
+    mt::Shape<2> shape(5, 2);
+    shape.setStride(0, 4);
+    shape.setStride(1, 2);
+    mt::Tensor<float, 2> tensor(vec.data(), shape);
+    tensor = std::vector<float>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        ASSERT_EQ(vec[i * 4], i * 2);
+        ASSERT_EQ(vec[i * 4 + 1], -1);
+        ASSERT_EQ(vec[i * 4 + 2], i * 2 + 1);
+        ASSERT_EQ(vec[i * 4 + 3], -1);
+    }
+}
+
+TEST(tensor, broadcast_to)
+{
+    std::vector<int> data({1, 2, 3});
+    mt::Tensor<int, 1> row(data.data(), 3);
+    mt::Tensor<const int, 2> view = mt::broadcastTo(row, mt::Shape<2>(2, 3));
+    ASSERT_EQ(view.data(), data.data());
+    ASSERT_EQ(view(1, 2), 3);
+    ASSERT_FALSE(view.getShape().isContinuous());
+
+    // Copying a broadcast view materializes it
+    std::vector<int> out_data(6);
+    mt::Tensor<int, 2> out(out_data.data(), {2, 3});
+    view.copyTo(out);
+    ASSERT_EQ(out_data, std::vector<int>({1, 2, 3, 1, 2, 3}));
+}
+
+TEST(tensor, transpose)
+{
+    std::vector<int> data({0, 1, 2, 3, 4, 5});
+    mt::Tensor<int, 2> mat(data.data(), {2, 3});
+    mt::Tensor<int, 2> trans = mt::transpose(mat, 0, 1);
+    ASSERT_EQ(trans.data(), data.data());
+    ASSERT_EQ(trans.getShape(), mt::Shape<2>(3, 2));
+    ASSERT_EQ(trans(2, 1), 5);
+    ASSERT_EQ(trans(1, 0), 1);
+
+    mt::TensorBuffer<int, 2> dense = mt::contiguous(trans);
+    ASSERT_TRUE(dense.getShape().isContinuous());
+    ASSERT_EQ(std::vector<int>(dense.data(), dense.data() + 6), std::vector<int>({0, 3, 1, 4, 2, 5}));
+}
+
+TEST(tensor, permute_copy)
+{
+    // Sizes that are not multiples of the tile exercise the partial tiles
+    const uint32_t n = 2, c = 67, h = 9, w = 13;
+    std::vector<float> nchw_data(n * c * h * w);
+    for (size_t i = 0; i < nchw_data.size(); ++i)
+    {
+        nchw_data[i] = static_cast<float>(i);
+    }
+    mt::Tensor<float, 4> nchw(nchw_data.data(), {n, c, h, w});
+    mt::ThreadPool pool(3);
+    for (mt::ThreadPool* p : {static_cast<mt::ThreadPool*>(nullptr), &pool})
+    {
+        std::vector<float> nhwc_data(nchw_data.size(), -1);
+        mt::Tensor<float, 4> nhwc(nhwc_data.data(), {n, h, w, c});
+        mt::copyStrided<float, 4>(nchw_data.data(),
+                                  mt::permute(nchw, {0, 2, 3, 1}).getShape(),
+                                  nhwc_data.data(),
+                                  nhwc.getShape(),
+                                  p,
+                                  100);
+        for (uint32_t i = 0; i < n * h * w * c; ++i)
+        {
+            const uint32_t ch = i % c;
+            const uint32_t x = (i / c) % w;
+            const uint32_t y = (i / c / w) % h;
+            ASSERT_EQ(nhwc_data[i], nchw(i / (c * w * h), ch, y, x));
+        }
+
+        // And back, now the source is the channels last layout
+        std::vector<float> back_data(nchw_data.size(), -1);
+        mt::Tensor<float, 4> back(back_data.data(), {n, c, h, w});
+        mt::Tensor<float, 4> view = mt::permute(nhwc, {0, 3, 1, 2});
+        if (p == nullptr)
+        {
+            view.copyTo(back);
+        }
+        else
+        {
+            view.copyTo(back, *p, 100);
+        }
+        ASSERT_EQ(back_data, nchw_data);
+    }
+}
+
+TEST(tensor, slice)
+{
+    std::vector<float> data(4 * 5 * 6);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<float>(i);
+    }
+    mt::Tensor<float, 3> frames(data.data(), {4, 5, 6});
+
+    // Every other frame, cropped to rows 1..3 and the last four columns
+    mt::Tensor<float, 3> roi = mt::slice(frames, mt::Range(0, mt::Range::END, 2), mt::Range(1, 4), mt::Range(-4));
+    ASSERT_EQ(roi.getShape(), mt::Shape<3>(2, 3, 4));
+    for (uint32_t f = 0; f < 2; ++f)
+    {
+        for (uint32_t y = 0; y < 3; ++y)
+        {
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                ASSERT_EQ(roi(f, y, x), frames(f * 2, y + 1, x + 2));
+            }
+        }
+    }
+    roi(1, 2, 3) = -1;
+    ASSERT_EQ(frames(2, 3, 5), -1);
+
+    mt::TensorBuffer<float, 3> dense = mt::contiguous(roi);
+    ASSERT_TRUE(dense.getShape().isContinuous());
+    ASSERT_EQ(dense.view()(1, 0, 0), frames(2, 1, 2));
+
+    // Trailing dimensions without a range are kept whole
+    mt::Tensor<float, 3> last = mt::slice(frames, mt::Range(-1));
+    ASSERT_EQ(last.getShape(), mt::Shape<3>(1, 5, 6));
+    ASSERT_EQ(last.data(), data.data() + 3 * 30);
+}
+
+TEST(tensor, slice_reversed)
+{
+    std::vector<int> data({0, 1, 2, 3, 4, 5});
+    mt::Tensor<int, 2> mat(data.data(), {2, 3});
+    // Both dimensions reversed, the view starts at the last element
+    mt::Tensor<int, 2> flipped = mt::slice(mat, mt::Range(-1, mt::Range::END, -1), mt::Range(-1, mt::Range::END, -1));
+    ASSERT_EQ(flipped.data(), data.data() + 5);
+    ASSERT_EQ(flipped(0, 0), 5);
+    ASSERT_EQ(flipped(1, 2), 0);
+    ASSERT_EQ(flipped[1](0), 2);
+
+    std::vector<int> visited;
+    for (mt::Tensor<int, 1> row : flipped)
+    {
+        for (int value : row)
+        {
+            visited.push_back(value);
+        }
+    }
+    ASSERT_EQ(visited, std::vector<int>({5, 4, 3, 2, 1, 0}));
+
+    std::vector<int> out_data(6);
+    mt::Tensor<int, 2> out(out_data.data(), {2, 3});
+    flipped.copyTo(out);
+    ASSERT_EQ(out_data, std::vector<int>({5, 4, 3, 2, 1, 0}));
+}
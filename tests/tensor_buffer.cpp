@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/TensorBuffer.hpp>
+
+#include <limits>
+#include <new>
+#include <vector>
+
+TEST(tensor_buffer, aligned_view)
+{
+    mt::PoolAllocator pool;
+    mt::TensorBuffer<float, 3> buffer(mt::Shape<3>(5, 2, 3), &pool);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % 64, 0);
+    ASSERT_TRUE(buffer.getShape().isContinuous());
+
+    mt::Tensor<float, 3> view = buffer;
+    ASSERT_EQ(view.data(), buffer.data());
+    ASSERT_EQ(view.getShape(), mt::Shape<3>(5, 2, 3));
+    view(1, 1, 2) = 4;
+
+    const mt::TensorBuffer<float, 3>& const_buffer = buffer;
+    mt::Tensor<const float, 3> const_view = const_buffer;
+    ASSERT_EQ(const_view(1, 1, 2), 4);
+}
+
+TEST(tensor_buffer, pool_recycles)
+{
+    mt::PoolAllocator pool;
+    for (int i = 0; i < 4; ++i)
+    {
+        mt::TensorBuffer<float, 2> a(mt::Shape<2>(100, 100), &pool);
+        mt::TensorBuffer<float, 2> b(mt::Shape<2>(99, 101), &pool);
+    }
+    const mt::AllocatorStats stats = pool.stats();
+    ASSERT_EQ(stats.allocations, 8);
+    ASSERT_EQ(stats.pool_hits, 6);
+    ASSERT_EQ(stats.live_bytes, 0);
+    ASSERT_EQ(stats.peak_bytes, 2 * mt::PoolAllocator::sizeClass(100 * 100 * sizeof(float)));
+    ASSERT_DOUBLE_EQ(stats.hitRate(), 0.75);
+
+    pool.trim();
+    ASSERT_EQ(pool.stats().cached_bytes, 0);
+}
+
+TEST(tensor_buffer, size_class)
+{
+    ASSERT_EQ(mt::PoolAllocator::sizeClass(1), 64);
+    ASSERT_EQ(mt::PoolAllocator::sizeClass(64), 64);
+    ASSERT_EQ(mt::PoolAllocator::sizeClass(65), 80);
+    ASSERT_EQ(mt::PoolAllocator::sizeClass(128), 128);
+    ASSERT_EQ(mt::PoolAllocator::sizeClass(129), 160);
+    ASSERT_EQ(mt::PoolAllocator::sizeClass(1000), 1024);
+    ASSERT_THROW(mt::PoolAllocator::sizeClass(std::numeric_limits<size_t>::max() - 8), std::bad_alloc);
+}
+
+TEST(tensor_buffer, failed_allocation)
+{
+    // Sizes that cannot be rounded up or that the heap refuses throw and are not counted
+    const size_t huge = std::numeric_limits<size_t>::max();
+    mt::AlignedAllocator aligned;
+    ASSERT_THROW(aligned.allocate(huge - 8), std::bad_alloc);
+    ASSERT_EQ(aligned.stats().allocations, 0);
+    mt::PoolAllocator pool;
+    ASSERT_THROW(pool.allocate(huge - 8), std::bad_alloc);
+    ASSERT_THROW(pool.allocate(huge / 2), std::bad_alloc);
+    const mt::AllocatorStats stats = pool.stats();
+    ASSERT_EQ(stats.allocations, 0);
+    ASSERT_EQ(stats.live_bytes, 0);
+    ASSERT_EQ(stats.peak_bytes, 0);
+}
+
+TEST(tensor_buffer, move_and_resize)
+{
+    mt::AlignedAllocator allocator;
+    mt::TensorBuffer<double, 2> a(mt::Shape<2>(4, 4), &allocator);
+    double* ptr = a.data();
+    mt::TensorBuffer<double, 2> b(std::move(a));
+    ASSERT_EQ(a.data(), nullptr);
+    ASSERT_EQ(b.data(), ptr);
+
+    // Same number of elements keeps the storage
+    b.resize(mt::Shape<2>(2, 8));
+    ASSERT_EQ(b.data(), ptr);
+    ASSERT_EQ(b.getShape().getStride(0), 8);
+
+    b.resize(mt::Shape<2>(8, 8));
+    ASSERT_EQ(allocator.stats().live_bytes, 64 * sizeof(double));
+    ASSERT_EQ(allocator.stats().peak_bytes, 64 * sizeof(double));
+}
+
+TEST(tensor_buffer, default_allocator)
+{
+    mt::AlignedAllocator allocator;
+    mt::Allocator::setDefault(&allocator);
+    {
+        mt::TensorBuffer<uint8_t, 1> buffer(mt::Shape<1>(10));
+        ASSERT_EQ(buffer.getAllocator(), &allocator);
+    }
+    mt::Allocator::setDefault(nullptr);
+    ASSERT_NE(mt::Allocator::getDefault(), &allocator);
+    ASSERT_EQ(allocator.stats().allocations, 1);
+}
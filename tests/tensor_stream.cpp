@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/TensorStream.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::string tempPath(const char* name) { return ::testing::TempDir() + name; }
+
+    // Row r holds r * 100 + i for its elements i
+    void writeRows(mt::TensorWriter<float, 3>& writer, uint32_t begin, uint32_t end)
+    {
+        std::vector<float> data((end - begin) * 15);
+        for (uint32_t r = begin; r < end; ++r)
+        {
+            for (uint32_t i = 0; i < 15; ++i)
+            {
+                data[(r - begin) * 15 + i] = static_cast<float>(r * 100 + i);
+            }
+        }
+        writer.write(mt::Tensor<const float, 3>(data.data(), {end - begin, 3, 5}));
+    }
+
+    uint32_t readRows(const std::string& path, bool prefetch, std::vector<uint32_t>* chunk_rows = nullptr)
+    {
+        mt::TensorReader<float, 3> reader(path, prefetch);
+        EXPECT_EQ(reader.rowShape(), mt::Shape<2>(3, 5));
+        mt::Tensor<const float, 3> chunk;
+        uint32_t rows = 0;
+        while (reader.next(chunk))
+        {
+            if (chunk_rows != nullptr)
+            {
+                chunk_rows->push_back(chunk.getShape()[0]);
+            }
+            for (mt::Tensor<const float, 2> row : chunk)
+            {
+                for (uint32_t i = 0; i < 15; ++i)
+                {
+                    EXPECT_EQ(row(i / 5, i % 5), static_cast<float>(rows * 100 + i));
+                }
+                ++rows;
+            }
+        }
+        return rows;
+    }
+} // namespace
+
+TEST(tensor_stream, round_trip)
+{
+    const std::string path = tempPath("mt_round_trip.mts");
+    {
+        mt::TensorWriter<float, 3> writer(path, mt::Shape<2>(3, 5), 64);
+        writeRows(writer, 0, 100);
+        // A single strided row, the transpose of a 5x3 matrix
+        std::vector<float> transposed(15);
+        for (uint32_t i = 0; i < 15; ++i)
+        {
+            transposed[(i % 5) * 3 + i / 5] = static_cast<float>(10000 + i);
+        }
+        writer.write(mt::transpose(mt::Tensor<float, 2>(transposed.data(), {5, 3}), 0, 1));
+        writer.flush();
+        writeRows(writer, 101, 250);
+    }
+    std::vector<uint32_t> chunk_rows;
+    ASSERT_EQ(readRows(path, true, &chunk_rows), 250);
+    ASSERT_EQ(chunk_rows, std::vector<uint32_t>({64, 37, 64, 64, 21}));
+    ASSERT_EQ(readRows(path, false), 250);
+
+    // Stopping early must not block on the prefetch thread
+    {
+        mt::TensorReader<float, 3> reader(path);
+        mt::Tensor<const float, 3> chunk;
+        ASSERT_TRUE(reader.next(chunk));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(tensor_stream, truncated_and_mismatched)
+{
+    const std::string path = tempPath("mt_truncated.mts");
+    {
+        mt::TensorWriter<float, 3> writer(path, mt::Shape<2>(3, 5), 10);
+        writeRows(writer, 0, 25);
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    // Cut the last chunk in half, as if the writer died while writing it. The complete chunks are read before
+    // the cut one throws.
+    std::ofstream(path, std::ios::binary).write(contents.data(), contents.size() - 5 * 15 * 2);
+    for (bool prefetch : {true, false})
+    {
+        mt::TensorReader<float, 3> reader(path, prefetch);
+        mt::Tensor<const float, 3> chunk;
+        ASSERT_TRUE(reader.next(chunk));
+        ASSERT_TRUE(reader.next(chunk));
+        ASSERT_THROW(reader.next(chunk), std::runtime_error);
+    }
+    // A row count that the file cannot hold, right after the file header and the two row sizes
+    std::string corrupt = contents;
+    const uint32_t rows = 0xFFFFFFFF;
+    std::memcpy(&corrupt[sizeof(mt::detail::StreamHeader) + 2 * sizeof(uint32_t) + 4], &rows, sizeof(rows));
+    std::ofstream(path, std::ios::binary).write(corrupt.data(), corrupt.size());
+    {
+        mt::TensorReader<float, 3> reader(path, false);
+        mt::Tensor<const float, 3> chunk;
+        ASSERT_THROW(reader.next(chunk), std::runtime_error);
+    }
+#ifdef MT_INDEX_64
+    // Rows the format cannot describe are rejected before the file is created
+    std::remove(path.c_str());
+    ASSERT_THROW((mt::TensorWriter<float, 2>(path, mt::Shape<1>(mt::DimSize_t(1) << 33))), std::runtime_error);
+    ASSERT_EQ(std::fopen(path.c_str(), "rb"), nullptr);
+    std::ofstream(path, std::ios::binary).write(contents.data(), contents.size());
+#endif
+
+    ASSERT_THROW((mt::TensorReader<double, 3>(path)), std::runtime_error);
+    ASSERT_THROW((mt::TensorReader<float, 2>(path)), std::runtime_error);
+    std::remove(path.c_str());
+}
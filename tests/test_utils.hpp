@@ -0,0 +1,53 @@
+#ifndef MINITENSOR_TEST_UTILS_HPP
+#define MINITENSOR_TEST_UTILS_HPP
+#include <minitensor/Simd.hpp>
+
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// Helpers shared by the test files
+namespace mt_test
+{
+    template <class T, bool = std::is_floating_point<T>::value>
+    struct UniformDistribution
+    {
+        typedef std::uniform_real_distribution<T> type;
+    };
+
+    template <class T>
+    struct UniformDistribution<T, false>
+    {
+        typedef std::uniform_int_distribution<int64_t> type;
+    };
+
+    // size values drawn uniformly from [low, high] with a fixed seed, integers for integer types
+    template <class T>
+    std::vector<T> randomData(size_t size, uint32_t seed, T low = T(-1), T high = T(1))
+    {
+        std::mt19937 rng(seed);
+        typename UniformDistribution<T>::type dist(low, high);
+        std::vector<T> out(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            out[i] = static_cast<T>(dist(rng));
+        }
+        return out;
+    }
+
+    // Calls fn(isa) with every instruction set the cpu supports selected in turn, then restores the detected one
+    template <class F>
+    void forEachIsa(F&& fn)
+    {
+        const mt::SimdIsa supported = mt::detectSimdIsa();
+        for (uint8_t isa = 0; isa <= static_cast<uint8_t>(supported); ++isa)
+        {
+            mt::setSimdIsa(static_cast<mt::SimdIsa>(isa));
+            fn(static_cast<mt::SimdIsa>(isa));
+        }
+        mt::setSimdIsa(supported);
+    }
+} // namespace mt_test
+
+#endif // MINITENSOR_TEST_UTILS_HPP
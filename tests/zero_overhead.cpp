@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <minitensor/DType.hpp>
+#include <minitensor/StaticShape.hpp>
+#include <minitensor/Tensor.hpp>
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Views are plain values, they can be passed in registers, memcpy'd and built at compile time. What indexing
+// them costs against the pointer arithmetic it stands for is timed by the access group of bench_minitensor.
+static_assert(std::is_trivially_copyable<mt::Array<uint32_t, 3>>::value, "Array must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::Shape<1>>::value, "Shape must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::Shape<4>>::value, "Shape must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::Tensor<float, 2>>::value, "Tensor must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::Tensor<const float, 1>>::value, "Tensor must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::Tensor<void, 3>>::value, "Tensor must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::Tensor<int, 0>>::value, "Tensor must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::DynamicTensor<const void, 2>>::value,
+              "DynamicTensor must be trivially copyable");
+static_assert(std::is_trivially_copyable<mt::StaticTensor<float, mt::StaticShape<2, 3>>>::value,
+              "StaticTensor must be trivially copyable");
+
+namespace
+{
+    constexpr int DATA[] = {0, 1, 2, 3, 4, 5};
+    constexpr mt::Array<int, 3> ARRAY(4, 5, 6);
+    constexpr mt::Shape<2> SHAPE(2, 3);
+    constexpr mt::Tensor<const int, 2> TENSOR(DATA, SHAPE);
+
+    static_assert(ARRAY[-1] == 6, "");
+    static_assert(SHAPE[1] == 3 && SHAPE.getStride(0) == 3 && SHAPE.getStride(1) == 1, "");
+    static_assert(SHAPE.index(1, 2) == 5, "");
+    static_assert(TENSOR(1, 0) == 3 && TENSOR(-1, -1) == 5, "");
+} // namespace
+
+TEST(zero_overhead, trivially_copyable)
+{
+    std::vector<float> data(12);
+    const mt::Tensor<float, 2> tensor(data.data(), {3, 4});
+    mt::Tensor<float, 2> copy;
+    std::memcpy(&copy, &tensor, sizeof(copy));
+    copy(2, 1) = 7;
+    ASSERT_EQ(data[9], 7);
+    ASSERT_EQ(copy.getShape().getStride(0), 4);
+}